@@ -0,0 +1,227 @@
+/*!
+\file		bench.cpp
+\author		darius (d.chan@digipen.edu)
+\co-author
+\par		Assignment 4
+\date		19/10/2026
+\brief
+benchmark harness, runner and json output.
+
+Copyright (C) 2025 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the
+prior written consent of DigiPen Institute of Technology is prohibited.
+*/
+#include "bench.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+namespace
+{
+	struct Entry
+	{
+		std::string name;
+		BENCH::Function fn;
+		long long arg;
+		bool hasArg;
+	};
+
+	struct Result
+	{
+		std::string name;
+		long long iterations;
+		double nsPerIteration;
+		double itemsPerSecond;
+		double bytesPerSecond;
+	};
+
+	//function local so registration from other files' statics never sees it unconstructed
+	std::vector<Entry>& Registry()
+	{
+		static std::vector<Entry> registry{};
+		return registry;
+	}
+
+	const long long MAX_ITERATIONS = 1000000000;
+
+	volatile void const* sink{};
+
+	//grows the iteration count until one run lasts min seconds, like google benchmark
+	Result Run(Entry const& entry, double minSeconds)
+	{
+		long long iterations = 1;
+		while (true)
+		{
+			BENCH::State state{ iterations, entry.arg };
+			entry.fn(state);
+			double seconds = state.Seconds();
+			if (seconds >= minSeconds || iterations >= MAX_ITERATIONS)
+			{
+				Result result{};
+				result.name = entry.hasArg ? entry.name + "/" + std::to_string(entry.arg) : entry.name;
+				result.iterations = iterations;
+				result.nsPerIteration = seconds * 1e9 / (double)iterations;
+				result.itemsPerSecond = seconds > 0.0 ? (double)state.Items() / seconds : 0.0;
+				result.bytesPerSecond = seconds > 0.0 ? (double)state.Bytes() / seconds : 0.0;
+				return result;
+			}
+			//aim 40% past the minimum, at most 10x at a time
+			double multiplier = seconds > 0.0 ? std::min(10.0, minSeconds * 1.4 / seconds) : 10.0;
+			iterations = std::min(MAX_ITERATIONS, std::max(iterations + 1, (long long)(iterations * multiplier)));
+		}
+	}
+
+	std::string Escaped(std::string const& text)
+	{
+		std::string out{};
+		for (char c : text)
+		{
+			if (c == '"' || c == '\\') out += '\\';
+			out += c;
+		}
+		return out;
+	}
+
+	void WriteJson(std::ostream& os, std::vector<Result> const& results)
+	{
+		std::time_t now = std::time(nullptr);
+		std::tm localTime{};
+		char date[32]{};
+		if (localtime_s(&localTime, &now) == 0)
+		{
+			std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", &localTime);
+		}
+
+		os << "{\n  \"context\": {\n"
+			<< "    \"date\": \"" << date << "\",\n"
+			<< "    \"num_cpus\": " << std::thread::hardware_concurrency() << ",\n"
+#ifdef _DEBUG
+			<< "    \"build_type\": \"debug\"\n"
+#else
+			<< "    \"build_type\": \"release\"\n"
+#endif
+			<< "  },\n  \"benchmarks\": [";
+		for (size_t i = 0; i < results.size(); ++i)
+		{
+			Result const& r = results[i];
+			os << (i ? ",\n" : "\n") << "    {\n"
+				<< "      \"name\": \"" << Escaped(r.name) << "\",\n"
+				<< "      \"iterations\": " << r.iterations << ",\n"
+				<< "      \"real_time\": " << std::setprecision(6) << r.nsPerIteration << ",\n"
+				<< "      \"time_unit\": \"ns\"";
+			if (r.itemsPerSecond > 0.0) os << ",\n      \"items_per_second\": " << r.itemsPerSecond;
+			if (r.bytesPerSecond > 0.0) os << ",\n      \"bytes_per_second\": " << r.bytesPerSecond;
+			os << "\n    }";
+		}
+		os << "\n  ]\n}\n";
+	}
+}
+
+namespace BENCH
+{
+	State::State(long long iterations, long long arg)
+		: _iterations{ iterations }, _remaining{ iterations }, _arg{ arg }, _items{ 0 }, _bytes{ 0 },
+		_started{ false }, _paused{ false }, _start{}, _seconds{ 0.0 }
+	{
+	}
+
+	bool State::KeepRunning()
+	{
+		if (!_started)
+		{
+			_started = true;
+			_start = std::chrono::steady_clock::now();
+		}
+		if (_remaining-- > 0) return true;
+
+		if (!_paused) _seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - _start).count();
+		_paused = true;
+		return false;
+	}
+
+	void State::PauseTiming()
+	{
+		if (_paused) return;
+		_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - _start).count();
+		_paused = true;
+	}
+
+	void State::ResumeTiming()
+	{
+		if (!_paused) return;
+		_start = std::chrono::steady_clock::now();
+		_paused = false;
+	}
+
+	int Register(const char* name, Function fn, std::initializer_list<long long> args)
+	{
+		if (args.size() == 0)
+		{
+			Registry().push_back({ name, fn, 0, false });
+		}
+		for (long long arg : args)
+		{
+			Registry().push_back({ name, fn, arg, true });
+		}
+		return (int)Registry().size();
+	}
+
+	int Main(int argc, char* argv[])
+	{
+		std::string filter{};
+		std::string out{ "benchmarks.json" };
+		double minSeconds = 0.5;
+		for (int i = 1; i < argc; ++i)
+		{
+			if (i + 1 < argc && !std::strcmp(argv[i], "--filter")) filter = argv[++i];
+			else if (i + 1 < argc && !std::strcmp(argv[i], "--min-time")) minSeconds = std::atof(argv[++i]);
+			else if (i + 1 < argc && !std::strcmp(argv[i], "--out")) out = argv[++i];
+			else
+			{
+				std::cerr << "usage: Benchmarks [--filter text] [--min-time seconds] [--out file.json]" << std::endl;
+				return 1;
+			}
+		}
+
+		std::vector<Result> results{};
+		std::cout << std::left << std::setw(48) << "benchmark" << std::right << std::setw(16) << "ns/iter"
+			<< std::setw(14) << "iterations" << std::setw(16) << "items/s" << std::endl;
+		for (Entry const& entry : Registry())
+		{
+			if (!filter.empty() && entry.name.find(filter) == std::string::npos) continue;
+			Result r = Run(entry, minSeconds);
+			results.push_back(r);
+			std::cout << std::left << std::setw(48) << r.name << std::right << std::fixed << std::setprecision(1)
+				<< std::setw(16) << r.nsPerIteration << std::setw(14) << r.iterations;
+			if (r.itemsPerSecond > 0.0) std::cout << std::setw(16) << std::setprecision(0) << r.itemsPerSecond;
+			std::cout << std::defaultfloat << std::endl;
+		}
+
+		std::ofstream file{ out };
+		if (!file)
+		{
+			std::cerr << "cannot write " << out << std::endl;
+			return 1;
+		}
+		WriteJson(file, results);
+		std::cout << "results written to " << out << std::endl;
+		return 0;
+	}
+
+	void Escape(void const* p)
+	{
+		sink = p;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	return BENCH::Main(argc, argv);
+}
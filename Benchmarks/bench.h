@@ -0,0 +1,78 @@
+/*!
+\file		bench.h
+\author		darius (d.chan@digipen.edu)
+\co-author
+\par		Assignment 4
+\date		19/10/2026
+\brief
+a small benchmark harness in the style of google benchmark. a benchmark is
+a function taking a State, registered with BENCHMARK, that does its work
+inside while (state.KeepRunning()). the harness picks the iteration count
+so each run lasts at least the minimum time, prints a table, and writes
+every result to a json file so runs can be compared over time.
+
+Copyright (C) 2025 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the
+prior written consent of DigiPen Institute of Technology is prohibited.
+*/
+#pragma once
+#include <chrono>
+#include <initializer_list>
+#include <string>
+
+namespace BENCH
+{
+	class State
+	{
+	public:
+		State(long long iterations, long long arg);
+
+		//true until the timed loop has run its iterations. starts the clock on the first call
+		bool KeepRunning();
+
+		//the size this run was registered with, 0 if it has none
+		long long Arg() const { return _arg; }
+		long long Iterations() const { return _iterations; }
+
+		//setup inside the loop that should not be timed goes between these
+		void PauseTiming();
+		void ResumeTiming();
+
+		//items or bytes handled over the whole run, reported per second
+		void SetItemsProcessed(long long items) { _items = items; }
+		void SetBytesProcessed(long long bytes) { _bytes = bytes; }
+
+		double Seconds() const { return _seconds; }
+		long long Items() const { return _items; }
+		long long Bytes() const { return _bytes; }
+
+	private:
+		long long _iterations;
+		long long _remaining;
+		long long _arg;
+		long long _items;
+		long long _bytes;
+		bool _started;
+		bool _paused;
+		std::chrono::steady_clock::time_point _start;
+		double _seconds;
+	};
+
+	using Function = void (*)(State&);
+
+	//adds a benchmark, run once for every arg, or once with arg 0 when there are none
+	int Register(const char* name, Function fn, std::initializer_list<long long> args = {});
+
+	//runs everything registered. --filter text, --min-time seconds, --out file.json
+	int Main(int argc, char* argv[]);
+
+	//keeps the compiler from dropping work whose result is never used
+	void Escape(void const* p);
+	template <typename T>
+	void DoNotOptimize(T const& value)
+	{
+		Escape(&value);
+	}
+}
+
+#define BENCHMARK(fn, ...) static const int fn##_registered = BENCH::Register(#fn, fn, { __VA_ARGS__ })
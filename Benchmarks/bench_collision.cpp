@@ -0,0 +1,100 @@
+/*!
+\file		bench_collision.cpp
+\author		darius (d.chan@digipen.edu)
+\co-author
+\par		Assignment 4
+\date		19/10/2026
+\brief
+the server's collision pass over 10 to 10000 asteroids, and the pair test
+it is made of.
+
+Copyright (C) 2025 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the
+prior written consent of DigiPen Institute of Technology is prohibited.
+*/
+#include "bench.h"
+#include "collision.h"
+#include "protocol.h"
+#include <algorithm>
+#include <random>
+#include <vector>
+
+namespace
+{
+	const int PLAYERS = 4;
+	const float DT = 1.f / 60.f;
+
+	//asteroids and bullets scattered over the screen like a busy match
+	void FillField(int asteroids, Pool<GameObject>& golist, Pool<Bullet>& bulletlist, Player* players)
+	{
+		std::mt19937 rng{ 1 };
+		std::uniform_real_distribution<float> x(-800.f, 800.f), y(-450.f, 450.f), v(-100.f, 100.f), r(50.f, 100.f);
+		for (int i = 0; i < asteroids; ++i)
+		{
+			float size = r(rng);
+			golist[golist.Acquire()] = { {{x(rng), y(rng)},{size, size}, 0.f}, {v(rng), v(rng)}, ASSET::A_ASTEROID, {0.f, 0.f, 0.f, 1.f}, true };
+		}
+		for (int i = 0; i < (int)bulletlist.size(); ++i)
+		{
+			bulletlist[bulletlist.Acquire()] = { { {{x(rng), y(rng)},{10.f, 10.f}, 0.f}, {v(rng) * 10.f, v(rng) * 10.f}, ASSET::A_BULLET, {1.f, 1.f, 1.f, 1.f}, true }, 1.f, i % PLAYERS };
+		}
+		for (int i = 0; i < PLAYERS; ++i)
+		{
+			players[i] = { { {{x(rng), y(rng)},{50.f, 50.f}, 0.f}, {v(rng), v(rng)}, ASSET::A_PLAYER, {1.f, 0.f, 0.f, 1.f}, true }, 0, 0.f };
+		}
+	}
+}
+
+static void BM_IsWithinDistanceCheckDynamic(BENCH::State& state)
+{
+	std::mt19937 rng{ 1 };
+	std::uniform_real_distribution<float> x(-800.f, 800.f), y(-450.f, 450.f), v(-1000.f, 1000.f);
+	std::vector<GameObject> objects(256);
+	for (GameObject& go : objects)
+	{
+		go = { {{x(rng), y(rng)},{75.f, 75.f}, 0.f}, {v(rng), v(rng)}, ASSET::A_ASTEROID, {0.f, 0.f, 0.f, 1.f}, true };
+	}
+	size_t i = 0;
+	int hits = 0;
+	while (state.KeepRunning())
+	{
+		hits += COLLISION::IsWithinDistanceCheckDynamic(objects[i & 255], objects[(i * 7 + 1) & 255], DT);
+		++i;
+	}
+	BENCH::DoNotOptimize(hits);
+	state.SetItemsProcessed(state.Iterations());
+}
+BENCHMARK(BM_IsWithinDistanceCheckDynamic);
+
+//SimpleDynamicCollisionCheck with Arg asteroids, a full bulletlist and 4 players
+static void BM_SimpleDynamicCollisionCheck(BENCH::State& state)
+{
+	const int asteroids = (int)state.Arg();
+	const GameObject blankAsteroid{ {{0.f, 0.f},{0.f, 0.f}, 0.f}, {}, ASSET::A_ASTEROID, {0.f, 0.f, 0.f, 1.f}, false };
+	const Bullet blankBullet{ { {{0.f, 0.f},{10.f, 10.f}, 0.f}, {}, ASSET::A_BULLET, {1.f, 1.f, 1.f, 1.f}, false }, 0.f, 0 };
+	Pool<GameObject> startGolist{ asteroids, blankAsteroid, P_RECYCLE_OLDEST };
+	Pool<Bullet> startBulletlist{ MAX_BULLETS, blankBullet, P_RECYCLE_OLDEST };
+	Player startPlayers[PLAYERS]{};
+	FillField(asteroids, startGolist, startBulletlist, startPlayers);
+
+	Pool<GameObject> golist{ startGolist };
+	Pool<Bullet> bulletlist{ startBulletlist };
+	Player players[PLAYERS]{};
+	int hits = 0;
+	while (state.KeepRunning())
+	{
+		//hits deactivate objects, every pass starts from the same field
+		state.PauseTiming();
+		golist = startGolist;
+		bulletlist = startBulletlist;
+		std::copy(startPlayers, startPlayers + PLAYERS, players);
+		state.ResumeTiming();
+
+		COLLISION::CheckAsteroidHits(players, PLAYERS, golist, bulletlist, DT,
+			[&](Player& player, int) { player.score -= 1; ++hits; },
+			[&](Bullet const&, int) { ++hits; });
+	}
+	BENCH::DoNotOptimize(hits);
+	state.SetItemsProcessed(state.Iterations() * asteroids);
+}
+BENCHMARK(BM_SimpleDynamicCollisionCheck, 10, 100, 1000, 10000);
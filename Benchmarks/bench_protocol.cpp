@@ -0,0 +1,317 @@
+/*!
+\file		bench_protocol.cpp
+\author		darius (d.chan@digipen.edu)
+\co-author
+\par		Assignment 4
+\date		19/10/2026
+\brief
+building and reading every kind of message, the way CreateUpdate,
+ProcessAllState and the server's send and receive threads do.
+
+Copyright (C) 2025 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the
+prior written consent of DigiPen Institute of Technology is prohibited.
+*/
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+
+#include "Windows.h"
+#include "winsock2.h"	// htonf, htonl
+
+#include "bench.h"
+#include "protocol.h"
+#include "message.h"
+#include "input.h"
+#include "snapshot.h"
+#include "replication.h"
+#include "coalesce.h"
+#include "fragment.h"
+#include <random>
+#include <vector>
+
+#pragma comment(lib, "ws2_32.lib")
+
+namespace
+{
+	const int PLAYERS = 4;
+
+	GameObject Ship(int i)
+	{
+		return { {{-300.f + 200.f * i, 100.f},{50.f, 50.f}, 45.f * i}, {30.f, -20.f}, ASSET::A_PLAYER, {1.f, 0.f, 0.f, 1.f}, true };
+	}
+
+	//a full match worth of asteroids and bullets, every other slot in use
+	void FillWorld(std::vector<GameObject>& golist, std::vector<Bullet>& bulletlist)
+	{
+		std::mt19937 rng{ 1 };
+		std::uniform_real_distribution<float> x(-800.f, 800.f), y(-450.f, 450.f), v(-100.f, 100.f), r(50.f, 100.f);
+		golist.assign(MAX_ASTEROIDS, GameObject{});
+		bulletlist.assign(MAX_BULLETS, Bullet{});
+		for (int i = 0; i < MAX_ASTEROIDS; ++i)
+		{
+			float size = r(rng);
+			golist[i] = { {{x(rng), y(rng)},{size, size}, 0.f}, {v(rng), v(rng)}, ASSET::A_ASTEROID, {0.f, 0.f, 0.f, 1.f}, i % 2 == 0 };
+		}
+		for (int i = 0; i < MAX_BULLETS; ++i)
+		{
+			bulletlist[i] = { { {{x(rng), y(rng)},{10.f, 10.f}, 0.f}, {v(rng) * 10.f, v(rng) * 10.f}, ASSET::A_BULLET, {1.f, 1.f, 1.f, 1.f}, i % 2 == 0 }, 1.f, i % PLAYERS };
+		}
+	}
+
+	//C_ALL_UPDATE - id, timestamp, (pos, scale, rot, vel) * 4, echo. as the server's send thread, once per client
+	void BuildAllUpdate(std::string& message, GameObject const* ships, float now, std::vector<std::string>& out)
+	{
+		message.clear();
+		message += C_ALL_UPDATE;
+		MESSAGE::AppendFloat(message, now);
+		for (int i = 0; i < PLAYERS; ++i)
+		{
+			MESSAGE::AppendBody(message, ships[i]);
+		}
+		const size_t bodySize = message.size();
+		for (int i = 0; i < PLAYERS; ++i)
+		{
+			message.resize(bodySize);
+			MESSAGE::AppendFloat(message, now - 0.05f);
+			out[i] = message;
+		}
+	}
+}
+
+static void BM_StateUpdateBuild(BENCH::State& state)
+{
+	GameObject ship = Ship(0);
+	INPUTFRAME::History inputs{};
+	for (int i = 0; i < INPUTFRAME::REDUNDANCY; ++i) inputs.Push(0.1f * i, INPUTFRAME::F_FIRE);
+	while (state.KeepRunning())
+	{
+		std::string packet = MESSAGE::StateUpdate(0.5f, ship, 0.45f, inputs);
+		BENCH::DoNotOptimize(packet);
+	}
+	state.SetItemsProcessed(state.Iterations());
+}
+BENCHMARK(BM_StateUpdateBuild);
+
+//what the server's receive thread does with a C_STATE_UPDATE
+static void BM_StateUpdateParse(BENCH::State& state)
+{
+	INPUTFRAME::History inputs{};
+	for (int i = 0; i < INPUTFRAME::REDUNDANCY; ++i) inputs.Push(0.1f * i, INPUTFRAME::F_FIRE);
+	std::string packet = MESSAGE::StateUpdate(0.5f, Ship(0), 0.45f, inputs);
+	std::vector<INPUTFRAME::Frame> frames{};
+	INPUTFRAME::Receiver receiver{};
+	std::vector<INPUTFRAME::Frame> fresh{};
+	while (state.KeepRunning())
+	{
+		const char* buffer = packet.data();
+		INPUTFRAME::Read(buffer + STATE_UPDATE_INPUTS, (int)packet.size() - STATE_UPDATE_INPUTS, frames);
+		receiver.Reset();
+		receiver.Accept(frames, fresh);
+		float timestamp = MESSAGE::ReadFloat(buffer + 1);
+		float echo = MESSAGE::ReadFloat(buffer + 33);
+		Transform t{};
+		AEVec2 vel{};
+		MESSAGE::ReadBody(buffer + 5, t, vel);
+		BENCH::DoNotOptimize(timestamp);
+		BENCH::DoNotOptimize(echo);
+		BENCH::DoNotOptimize(t);
+		BENCH::DoNotOptimize(vel);
+	}
+	state.SetItemsProcessed(state.Iterations());
+}
+BENCHMARK(BM_StateUpdateParse);
+
+static void BM_AllUpdateBuild(BENCH::State& state)
+{
+	GameObject ships[PLAYERS]{ Ship(0), Ship(1), Ship(2), Ship(3) };
+	std::string message{};
+	std::vector<std::string> out(PLAYERS);
+	while (state.KeepRunning())
+	{
+		BuildAllUpdate(message, ships, 1.f, out);
+		BENCH::DoNotOptimize(out);
+	}
+	state.SetItemsProcessed(state.Iterations() * PLAYERS);
+}
+BENCHMARK(BM_AllUpdateBuild);
+
+//ProcessAllState without the interpolation
+static void BM_AllUpdateParse(BENCH::State& state)
+{
+	GameObject ships[PLAYERS]{ Ship(0), Ship(1), Ship(2), Ship(3) };
+	std::string message{};
+	std::vector<std::string> out(PLAYERS);
+	BuildAllUpdate(message, ships, 1.f, out);
+	std::string const& packet = out[0];
+	GameObject parsed[PLAYERS]{};
+	while (state.KeepRunning())
+	{
+		const char* buffer = packet.data();
+		float timestamp = MESSAGE::ReadFloat(buffer + 1);
+		float echo = MESSAGE::ReadFloat(buffer + MinimumSize(C_ALL_UPDATE));
+		for (int i = 0; i < PLAYERS; ++i)
+		{
+			MESSAGE::ReadBody(buffer + 5 + MESSAGE::BODY_SIZE * i, parsed[i].t, parsed[i].vel);
+		}
+		BENCH::DoNotOptimize(timestamp);
+		BENCH::DoNotOptimize(echo);
+		BENCH::DoNotOptimize(parsed);
+	}
+	state.SetItemsProcessed(state.Iterations());
+}
+BENCHMARK(BM_AllUpdateParse);
+
+//C_REQ_FIRE - id, input frames
+static void BM_ReqFireRoundTrip(BENCH::State& state)
+{
+	INPUTFRAME::History inputs{};
+	std::vector<INPUTFRAME::Frame> frames{};
+	float now = 0.f;
+	while (state.KeepRunning())
+	{
+		now += 0.1f;
+		inputs.Push(now, INPUTFRAME::F_FIRE);
+		std::string packet = MESSAGE::ReqFire(now, inputs);
+		INPUTFRAME::Read(packet.data() + 1, (int)packet.size() - 1, frames);
+		BENCH::DoNotOptimize(frames);
+	}
+	state.SetItemsProcessed(state.Iterations());
+}
+BENCHMARK(BM_ReqFireRoundTrip);
+
+//the fixed size events: C_RSP_FIRE, C_ASTEROID_SPAWN, C_ASTEROID_DESTROY, C_TIME_SYNC header
+static void BM_EventRoundTrip(BENCH::State& state)
+{
+	while (state.KeepRunning())
+	{
+		std::string msg{};
+		msg += C_RSP_FIRE;
+		MESSAGE::AppendFloat(msg, 1.f);
+		unsigned int id = htonl(2);
+		msg.append((char*)(&id), (char*)(&id) + 4);
+		unsigned short slot = htons(17);
+		msg.append((char*)(&slot), (char*)(&slot) + 2);
+
+		float t = MESSAGE::ReadFloat(msg.data() + 1);
+		int player = (int)ntohl(*(uint32_t*)(msg.data() + 5));
+		int index = ntohs(*(uint16_t*)(msg.data() + 9));
+		BENCH::DoNotOptimize(t);
+		BENCH::DoNotOptimize(player);
+		BENCH::DoNotOptimize(index);
+	}
+	state.SetItemsProcessed(state.Iterations());
+}
+BENCHMARK(BM_EventRoundTrip);
+
+//C_FULL_STATE, sent to every late joiner
+static void BM_FullStateBuild(BENCH::State& state)
+{
+	std::vector<GameObject> golist{};
+	std::vector<Bullet> bulletlist{};
+	FillWorld(golist, bulletlist);
+	std::vector<SNAPSHOT::PlayerState> players{};
+	for (int i = 0; i < PLAYERS; ++i)
+	{
+		GameObject ship = Ship(i);
+		players.push_back({ ship.t, ship.vel, 100 * i });
+	}
+	long long bytes{};
+	while (state.KeepRunning())
+	{
+		std::string message = SNAPSHOT::Build({ 1.f, 30.f, 10 }, players, golist, bulletlist);
+		bytes += (long long)message.size();
+		BENCH::DoNotOptimize(message);
+	}
+	state.SetBytesProcessed(bytes);
+}
+BENCHMARK(BM_FullStateBuild);
+
+static void BM_FullStateParse(BENCH::State& state)
+{
+	std::vector<GameObject> golist{};
+	std::vector<Bullet> bulletlist{};
+	FillWorld(golist, bulletlist);
+	std::vector<SNAPSHOT::PlayerState> players(PLAYERS);
+	std::string message = SNAPSHOT::Build({ 1.f, 30.f, 10 }, players, golist, bulletlist);
+	SNAPSHOT::State parsed{};
+	while (state.KeepRunning())
+	{
+		bool ok = SNAPSHOT::Read(message.data(), (int)message.size(), parsed);
+		BENCH::DoNotOptimize(ok);
+	}
+	state.SetBytesProcessed(state.Iterations() * (long long)message.size());
+}
+BENCHMARK(BM_FullStateParse);
+
+//C_ENTITY_UPDATE, priorities built up over one send interval then packed, as the send thread does per client
+static void BM_EntityUpdateBuild(BENCH::State& state)
+{
+	std::vector<GameObject> golist{};
+	std::vector<Bullet> bulletlist{};
+	FillWorld(golist, bulletlist);
+	REPLICATION::Accumulator acc{};
+	AEVec2 viewer{ 0.f, 0.f };
+	float now = 0.f;
+	while (state.KeepRunning())
+	{
+		now += 0.05f;
+		REPLICATION::Accumulate(acc, viewer, golist, bulletlist, 0.05f);
+		std::string message = REPLICATION::Build(acc, golist, bulletlist, now);
+		BENCH::DoNotOptimize(message);
+	}
+	state.SetItemsProcessed(state.Iterations());
+}
+BENCHMARK(BM_EntityUpdateBuild);
+
+//C_BATCH of a tick's worth of small events, packed and split again
+static void BM_BatchRoundTrip(BENCH::State& state)
+{
+	const int events = (int)state.Arg();
+	std::string event{};
+	event += C_ASTEROID_DESTROY;
+	MESSAGE::AppendFloat(event, 1.f);
+	event.append(2, '\0');
+	COALESCE::Aggregator aggregator{};
+	std::vector<std::string> ready{};
+	while (state.KeepRunning())
+	{
+		ready.clear();
+		for (int i = 0; i < events; ++i)
+		{
+			aggregator.Add(event, ready);
+		}
+		aggregator.Flush(ready);
+		int handled{};
+		for (std::string const& datagram : ready)
+		{
+			COALESCE::ForEach(datagram.data(), (int)datagram.size(), [&](const char*, int) { ++handled; });
+		}
+		BENCH::DoNotOptimize(handled);
+	}
+	state.SetItemsProcessed(state.Iterations() * events);
+}
+BENCHMARK(BM_BatchRoundTrip, 1, 8, 64);
+
+//C_FRAGMENT, a full state split at the mtu and put back together
+static void BM_FragmentRoundTrip(BENCH::State& state)
+{
+	std::vector<GameObject> golist{};
+	std::vector<Bullet> bulletlist{};
+	FillWorld(golist, bulletlist);
+	std::vector<SNAPSHOT::PlayerState> players(PLAYERS);
+	std::string message = SNAPSHOT::Build({ 1.f, 30.f, 10 }, players, golist, bulletlist);
+	FRAGMENT::Reassembler reassembler{};
+	std::string whole{};
+	while (state.KeepRunning())
+	{
+		std::vector<std::string> pieces = FRAGMENT::Split(message);
+		for (std::string const& piece : pieces)
+		{
+			reassembler.Add(1, piece.data(), (int)piece.size(), 0.f, whole);
+		}
+		BENCH::DoNotOptimize(whole);
+	}
+	state.SetBytesProcessed(state.Iterations() * (long long)message.size());
+}
+BENCHMARK(BM_FragmentRoundTrip);
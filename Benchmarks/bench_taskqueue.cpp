@@ -0,0 +1,71 @@
+/*!
+\file		bench_taskqueue.cpp
+\author		darius (d.chan@digipen.edu)
+\co-author
+\par		Assignment 4
+\date		19/10/2026
+\brief
+one producer feeding the server's TaskQueue with 1 to 8 workers taking the
+items off it.
+
+Copyright (C) 2025 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the
+prior written consent of DigiPen Institute of Technology is prohibited.
+*/
+#include <iostream>		//taskqueue.hpp logs every task to std::cout
+#include <atomic>
+#include <condition_variable>	//taskqueue.h uses it without including it
+#include "bench.h"
+#include "taskqueue.h"
+
+namespace
+{
+	const size_t SLOTS = 64;
+	const int STOP = -1;	//item that makes the worker taking it shut the queue down
+
+	struct Consume
+	{
+		std::atomic<long long> done{ 0 };
+
+		bool operator()(int item)
+		{
+			if (item == STOP) return false;
+			done.fetch_add(1, std::memory_order_relaxed);
+			return true;
+		}
+	};
+
+	struct Disconnect
+	{
+		void operator()() {}
+	};
+
+	//swallows the workers' logging so the results table stays readable
+	class NullBuffer : public std::streambuf
+	{
+	protected:
+		int overflow(int c) override { return c; }
+	};
+}
+
+//Arg workers. the queue is only SLOTS deep, so the producer is held back by how fast the workers drain it
+static void BM_TaskQueueProduceConsume(BENCH::State& state)
+{
+	NullBuffer null{};
+	std::streambuf* out = std::cout.rdbuf(&null);
+	{
+		Consume consume{};
+		Disconnect disconnect{};
+		TaskQueue<int, Consume, Disconnect> queue{ (size_t)state.Arg(), SLOTS, consume, disconnect };
+		int item = 0;
+		while (state.KeepRunning())
+		{
+			queue.produce(item++);
+		}
+		//the worker taking it stops the rest once the queue is empty, the destructor joins them
+		queue.produce(STOP);
+	}
+	std::cout.rdbuf(out);
+	state.SetItemsProcessed(state.Iterations());
+}
+BENCHMARK(BM_TaskQueueProduceConsume, 1, 2, 4, 8);
@@ -0,0 +1,78 @@
+/*!
+\file		bench_update.cpp
+\author		darius (d.chan@digipen.edu)
+\co-author
+\par		Assignment 4
+\date		19/10/2026
+\brief
+moving every object in golist one tick, and spawning asteroids into a
+golist whose free slots are scattered by asteroids destroyed in place.
+
+Copyright (C) 2025 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the
+prior written consent of DigiPen Institute of Technology is prohibited.
+*/
+#include "bench.h"
+#include "gameobject.h"
+#include "pool.h"
+#include "protocol.h"
+#include "spawn.h"
+
+namespace
+{
+	const float DT = 1.f / 60.f;
+	const AEVec2 screen{ 1600.f, 900.f };
+	const GameObject blankAsteroid{ {{0.f, 0.f},{0.f, 0.f}, 0.f}, {}, ASSET::A_ASTEROID, {0.f, 0.f, 0.f, 1.f}, false };
+}
+
+//the server's per tick golist update with Arg objects, all active
+static void BM_GameObjectUpdate(BENCH::State& state)
+{
+	const int count = (int)state.Arg();
+	Pool<GameObject> golist{ count, blankAsteroid, P_RECYCLE_OLDEST };
+	std::mt19937 rng{ 1 };
+	for (int i = 0; i < count; ++i)
+	{
+		SPAWN::SpawnAsteroid(rng, golist, screen);
+	}
+	while (state.KeepRunning())
+	{
+		for (GameObject& go : golist)
+		{
+			go.Update(screen, DT);
+		}
+	}
+	BENCH::DoNotOptimize(golist[0]);
+	state.SetItemsProcessed(state.Iterations() * count);
+}
+BENCHMARK(BM_GameObjectUpdate, 10, 100, 1000, 10000);
+
+//golist of Arg slots kept full. collisions deactivate asteroids in place without releasing them,
+//so whenever the free list runs dry every other asteroid is destroyed and Acquire has to reclaim them
+static void BM_SpawnAsteroidFragmented(BENCH::State& state)
+{
+	const int capacity = (int)state.Arg();
+	Pool<GameObject> golist{ capacity, blankAsteroid, P_RECYCLE_OLDEST };
+	std::mt19937 rng{ 1 };
+	for (int i = 0; i < capacity; ++i)
+	{
+		SPAWN::SpawnAsteroid(rng, golist, screen);
+	}
+	int spawned = 0;
+	while (state.KeepRunning())
+	{
+		if (spawned % (capacity / 2) == 0)
+		{
+			state.PauseTiming();
+			for (int i = spawned / (capacity / 2) % 2; i < capacity; i += 2)
+			{
+				golist[i].isActive = false;
+			}
+			state.ResumeTiming();
+		}
+		BENCH::DoNotOptimize(SPAWN::SpawnAsteroid(rng, golist, screen));
+		++spawned;
+	}
+	state.SetItemsProcessed(state.Iterations());
+}
+BENCHMARK(BM_SpawnAsteroidFragmented, MAX_ASTEROIDS, 1024);
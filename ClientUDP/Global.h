@@ -17,22 +17,26 @@ prior written consent of DigiPen Institute of Technology is prohibited.
 #include <vector>
 #include <chrono>
 #include <utility>
+#include "pool.h"
 
 struct GameObject;
 struct Bullet;
 struct Player;
 
-extern std::vector<Bullet> bulletlist;			//every bullet in the game
-extern std::vector<GameObject> golist;			//every other gameobject in the game
+extern Pool<Bullet> bulletlist;			//every bullet in the game
+extern Pool<GameObject> golist;			//every other gameobject in the game
 extern int playerNO;							//number for what is the current player
 extern Player players[4];
 extern float appTime;						//Total amount of time that has passed in the game
+extern float timeLeft;						//Seconds until the match ends
 extern std::atomic<bool> gameRunning;
 extern std::pair<ULONG, ULONGLONG> highscores[5];
 
 void InterpolateGameobject(GameObject& go, float timestamp);
-void InterpolatedShoot(int playerID, float timestamp);
+void InterpolatedShoot(int playerID, float timestamp, int index);
 void InterpolateGOsync(float newTimestamp);
 
-void SpawnInterpolatedAsteroid(float newTimestamp);
+void SpawnInterpolatedAsteroid(float newTimestamp, int index);
+void SyncAsteroidSpawns(int spawned);
+void ResetMatch();
 #endif
\ No newline at end of file
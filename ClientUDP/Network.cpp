@@ -17,7 +17,6 @@ prior written consent of DigiPen Institute of Technology is prohibited.
 #endif
 #define WINSOCK_VERSION     2
 #define WINSOCK_SUBVERSION  2
-#define MAX_STR_LEN 1000
 
 #include "Windows.h"		// Entire Win32 API...
 //#include "winsock2.h"	// ...or Winsock alone
@@ -26,6 +25,8 @@ prior written consent of DigiPen Institute of Technology is prohibited.
 // Alternatively, we could add this file to the linker command-line parameters,
 // but including it in the source code simplifies the configuration.
 #pragma comment(lib, "ws2_32.lib")
+#include "timeapi.h"			// timeBeginPeriod(), finer sleeps for the send deadlines
+#pragma comment(lib, "winmm.lib")
 
 
 #include "Network.h"
@@ -33,11 +34,23 @@ prior written consent of DigiPen Institute of Technology is prohibited.
 #include <iostream>
 #include <iomanip>
 #include <string>
+#include <condition_variable>
 
 #include "Global.h"
 #include "gameobject.h"
-
-std::mutex _gameObjectMutex{};
+#include "ratecontrol.h"
+#include "fragment.h"
+#include "coalesce.h"
+#include "snapshot.h"
+#include "input.h"
+#include "transport.h"
+#include "message.h"
+#include "trace.h"
+#include "contention.h"
+#include "capture.h"
+#include "handshake.h"
+
+CONTENTION::ProfiledMutex _gameObjectMutex{ "_gameObjectMutex" };
 std::mutex _stdoutMutex{};
 std::mutex _eventMutex{};
 std::queue<float> event_queue{};
@@ -45,17 +58,42 @@ float latest_server_update{};
 
 namespace {
 	sockaddr_in server_dest{};
-	SOCKET sock{};
+	std::unique_ptr<TRANSPORT::Transport> transport{};	//udp socket, or whatever ConnectServer was given
+	std::string capturePath{};		//record the connection here when set
 
 	std::thread recvThread{};
 	std::thread sendThread{};
 
 	std::atomic<bool> connected = false;
+
+	//C_STATE_UPDATE rate towards the server, adapted from the rtt of echoed timestamps
+	std::mutex rateMutex{};			//send thread and recv thread both update the rate
+	RateController sendRate{ 0.033f, 0.2f, 0.05f };
+	float serverUpdateRecvTime{};		//appTime when latest_server_update arrived, for the echo
+
+	//Send scheduling, wakes the send thread for fire events and simulation ticks
+	std::condition_variable sendWake{};	//waited on with _eventMutex, like event_queue
+	bool simTicked{ false };				//a simulation tick finished since the last state update
+	INPUTFRAME::History inputHistory{};			//newest input frames, repeated in every packet. guarded by _eventMutex
+	const std::chrono::milliseconds TICK_GRACE{ 20 };	//longest a due update waits for a tick, a bit over one at 60hz
+
+	const int ALL_UPDATE_SIZE = 1 + 4 + (8 + 8 + 4 + 8) * 4;
+
+	//Connection to the server
+	unsigned int session{};					//from C_RSP_CONNECT, lets us reconnect into the same slot
+	std::chrono::steady_clock::time_point lastHeard{};	//last time anything came from the server
+	const float KEEPALIVE_INTERVAL = 1.f;	//seconds between keepalives while waiting for the game
+	const float CONNECTION_TIMEOUT = 5.f;	//seconds without hearing from the server before reconnecting
 }
 
 namespace {
-	void RecvThread(SOCKET);
-	void SendThread(SOCKET);
+	void RecvThread(TRANSPORT::Transport&);
+	void SendThread(TRANSPORT::Transport&);
+	void ProcessPacket(const char*, int);
+	void StartMatch();
+	int Handshake(TRANSPORT::Transport&);
+	bool FromServer(sockaddr_in const&);
+	float SinceHeard();
 }
 
 bool ConnectServer() {
@@ -71,6 +109,9 @@ bool ConnectServer() {
 	std::getline(ifs, serverIP);
 	std::getline(ifs, serverPort);
 	std::getline(ifs, clientPort);
+	//optional, impairs our link for testing. "latency_ms jitter_ms loss duplicate reorder bandwidth_kbps"
+	std::string impairmentLine;
+	std::getline(ifs, impairmentLine);
 	ifs.close();
 
 	//Initialise Winsock
@@ -81,9 +122,10 @@ bool ConnectServer() {
 		std::cerr << "WSAStartup() failed: " << errorCode << std::endl;
 		return false;
 	}
+	timeBeginPeriod(1);	//1ms timer resolution, otherwise deadlines round up to the 15.6ms default
 
 	//Check is server is available
-	sock = { socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP) };
+	SOCKET sock = { socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP) };
 	if (sock == INVALID_SOCKET)
 	{
 		std::cerr << "Error code: " << WSAGetLastError() << std::endl;
@@ -107,43 +149,59 @@ bool ConnectServer() {
 	}
 	u_long enable = 1;
 	ioctlsocket(sock, FIONBIO, &enable);	//make socket non-blocking
+	std::unique_ptr<TRANSPORT::Transport> udp = std::make_unique<TRANSPORT::UdpTransport>(sock);
+
+	TRANSPORT::Impairment impairment{};
+	if (!impairmentLine.empty() && TRANSPORT::ParseImpairment(impairmentLine, impairment)) {
+		std::cout << "Simulating " << impairment.latency * 1000.f << "ms +" << impairment.jitter * 1000.f << "ms latency, "
+			<< impairment.loss * 100.f << "% loss" << std::endl;
+		udp = std::make_unique<TRANSPORT::SimulatedLink>(std::move(udp), impairment, impairment, (unsigned int)std::stoi(clientPort));
+	}
 
 	//setup client's connection with server
-	memset(&server_dest, 0, sizeof(server_dest));
-	server_dest.sin_family = AF_INET;		//ipv4
-	server_dest.sin_port = htons((u_short)std::stoi(serverPort));
-	inet_pton(AF_INET, serverIP.c_str(), &server_dest.sin_addr);
-
-	//Send to server connection req - this will also bind the socket
-	
-	std::string connection_req = CreateReqConnect();
-	int bytes = { sendto(sock, connection_req.c_str(), (int)connection_req.size(), 0, (sockaddr*)&server_dest, sizeof(server_dest)) };
-	if (bytes == SOCKET_ERROR || bytes == 0)
-	{
-		std::cerr << "UDP send fail: " << WSAGetLastError() << std::endl;
-		closesocket(sock);
+	sockaddr_in server{};
+	server.sin_family = AF_INET;		//ipv4
+	server.sin_port = htons((u_short)std::stoi(serverPort));
+	inet_pton(AF_INET, serverIP.c_str(), &server.sin_addr);
+
+	return ConnectServer(std::move(udp), server);
+}
+
+void CaptureTo(std::string const& path) {
+	capturePath = path;
+}
+
+bool ConnectServer(std::unique_ptr<TRANSPORT::Transport> link, sockaddr_in const& server) {
+	//recorded as the game sees it, after any simulated impairment
+	if (!capturePath.empty()) {
+		std::unique_ptr<CAPTURE::Writer> writer = std::make_unique<CAPTURE::Writer>();
+		if (writer->Open(capturePath, CAPTURE::R_CLIENT)) {
+			link = std::make_unique<CAPTURE::CaptureTransport>(std::move(link), std::move(writer));
+			std::cout << "Capturing to " << capturePath << std::endl;
+		}
+		else {
+			std::cerr << "cannot write " << capturePath << std::endl;
+		}
+	}
+	transport = std::move(link);
+	server_dest = server;
+
+	//Handshake with the server, retried with backoff until it answers
+	int playerNum = Handshake(*transport);
+	if (playerNum == -1) {
+		std::cerr << "Server is full" << std::endl;
+		transport.reset();
 		return false;
 	}
-	//Sleep to wait for recv
-	{
-		using namespace std::chrono_literals;
-		std::this_thread::sleep_for(200ms);
-	}
-	//Connection ack
-	char buff[MAX_STR_LEN]{};
-	sockaddr src{};
-	socklen_t len{ sizeof(src) };
-	bytes = { recvfrom(sock, buff, MAX_STR_LEN, 0, &src, &len) };
-	if (bytes == SOCKET_ERROR || bytes == 0 || buff[0] != CommandID::C_RSP_CONNECT) {	//No ack received
-		std::cerr << "UDP recv fail: " << WSAGetLastError() << std::endl;
-		closesocket(sock);
+	if (playerNum < 0) {	//No ack received
+		std::cerr << "Server not answering: " << WSAGetLastError() << std::endl;
+		transport.reset();
 		return false;
 	}
 	//process which player you are... else disconnect
-	int playerNum = ntohl(*(ULONG*)(buff + 1));
-	if (playerNum < 0 || playerNum > 3) {
+	if (playerNum > 3) {
 		std::cerr << "Wrong player number: " << std::endl;
-		closesocket(sock);
+		transport.reset();
 		return false;
 	}
 	playerNO = playerNum;
@@ -152,17 +210,33 @@ bool ConnectServer() {
 }
 
 bool WaitGameStart() {
-	char buff[MAX_STR_LEN];
+	char buff[MAX_DATAGRAM_SIZE];
+	FRAGMENT::Reassembler reassembler{};
+	std::string message{};
+	std::chrono::steady_clock::time_point lastKeepAlive{};
 	while (true) {
-		sockaddr src{};
-		socklen_t len{ sizeof(src) };
-		const int bytesReceived = recvfrom(sock, buff, MAX_STR_LEN, 0, &src, &len);
+		//Keep our slot while the other players join
+		if (std::chrono::steady_clock::now() - lastKeepAlive > std::chrono::duration<float>(KEEPALIVE_INTERVAL)) {
+			lastKeepAlive = std::chrono::steady_clock::now();
+			const char keepAlive = CommandID::C_KEEPALIVE;
+			transport->SendTo(&keepAlive, 1, server_dest);
+		}
+
+		sockaddr_in src{};
+		const int bytesReceived = transport->RecvFrom(buff, MAX_DATAGRAM_SIZE, src);
 
 		if (bytesReceived == SOCKET_ERROR)
 		{
 			size_t errorCode = WSAGetLastError();
-			if (errorCode == WSAEWOULDBLOCK)
+			if (errorCode == WSAEWOULDBLOCK || errorCode == WSAECONNRESET)
 			{
+				//Server went quiet, try to get the same slot back before giving up
+				if (SinceHeard() > CONNECTION_TIMEOUT && Handshake(*transport) != playerNO) {
+					std::lock_guard<std::mutex> usersLock{ _stdoutMutex };
+					std::cerr << "Lost connection to server." << std::endl;
+					return false;
+				}
+
 				// A non-blocking call returned no data; sleep and try again.
 				using namespace std::chrono_literals;
 				std::this_thread::sleep_for(200ms);
@@ -175,9 +249,26 @@ bool WaitGameStart() {
 			std::cerr << "recv() failed." << std::endl;
 			return false;
 		}
+		if (!FromServer(src)) {
+			continue;
+		}
+		lastHeard = std::chrono::steady_clock::now();
 
 		if (bytesReceived > 0) {
 			if (buff[0] == CommandID::C_GAME_START) {
+				StartMatch();
+				break;
+			}
+			//Joining a running game, the full state may overtake the start
+			if (buff[0] == CommandID::C_FRAGMENT && reassembler.Add(0, buff, bytesReceived, appTime, message)
+				&& (unsigned char)message[0] == CommandID::C_FULL_STATE) {
+				StartMatch();
+				ProcessPacket(message.data(), (int)message.size());
+				break;
+			}
+			if (buff[0] == CommandID::C_FULL_STATE) {
+				StartMatch();
+				ProcessPacket(buff, bytesReceived);
 				break;
 			}
 		}
@@ -186,46 +277,197 @@ bool WaitGameStart() {
 	//Setup threads here
 	connected = true;
 	gameRunning = true;
-	recvThread = std::thread{ RecvThread, sock };
-	sendThread = std::thread{ SendThread, sock };
+	recvThread = std::thread{ RecvThread, std::ref(*transport) };
+	sendThread = std::thread{ SendThread, std::ref(*transport) };
 
 	return true;
 }
 
-void DisconnectServer() {
-	{
-		std::lock_guard<std::mutex> outLock(_stdoutMutex);
-		std::cout << "Disconnecting to server..." << std::endl;
-	}
+void LeaveGame() {
 	connected = false;
+	sendWake.notify_all();
 	if (recvThread.joinable()) { 
 		recvThread.join(); 
 	}
 	if (sendThread.joinable()) {
 		sendThread.join();
 	}
+}
+
+void DisconnectServer() {
+	{
+		std::lock_guard<std::mutex> outLock(_stdoutMutex);
+		std::cout << "Disconnecting to server..." << std::endl;
+	}
+	LeaveGame();
+	//Free our slot now instead of waiting for the server to time us out
+	if (transport && session != 0) {
+		const char disconnect = CommandID::C_DISCONNECT;
+		transport->SendTo(&disconnect, 1, server_dest);
+		session = 0;
+	}
+	transport.reset();
+	timeEndPeriod(1);
 	WSACleanup();
 }
 
 namespace {
+	//True if src is the server we are connected to
+	bool FromServer(sockaddr_in const& src) {
+		return src.sin_port == server_dest.sin_port && src.sin_addr.s_addr == server_dest.sin_addr.s_addr;
+	}
+
+	//Forget the last match, anything not sent yet belongs to it
+	void StartMatch() {
+		{
+			CONTENTION::Lock goMutx{ _gameObjectMutex };
+			ResetMatch();
+			latest_server_update = 0.f;
+			serverUpdateRecvTime = 0.f;
+		}
+		{
+			std::lock_guard<std::mutex> eventMutx(_eventMutex);
+			event_queue = {};
+			inputHistory.Clear();
+		}
+		std::lock_guard<std::mutex> rateLock{ rateMutex };
+		sendRate = RateController{ 0.033f, 0.2f, 0.05f };
+	}
+
+	//Seconds since anything came from the server
+	float SinceHeard() {
+		return std::chrono::duration<float>(std::chrono::steady_clock::now() - lastHeard).count();
+	}
+
+	//Seconds on the steady clock, for the handshake's retry timing
+	double Seconds() {
+		return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	//Connect handshake, see HANDSHAKE. The session is sent along to get our old slot back.
+	//Returns the player number, -1 if the server is full, -2 if it never answered
+	int Handshake(TRANSPORT::Transport& sock) {
+		char buff[MAX_DATAGRAM_SIZE]{};
+		HANDSHAKE::Handshake handshake{};
+		handshake.Start(session, Seconds());
+		std::string req{};
+		while (handshake.State() == HANDSHAKE::S_PENDING) {
+			if (handshake.Due(Seconds(), req)) {
+				int bytes = { sock.SendTo(req.c_str(), (int)req.size(), server_dest) };
+				if (bytes == SOCKET_ERROR && WSAGetLastError() != WSAEWOULDBLOCK) {
+					return -2;
+				}
+			}
+
+			sockaddr_in src{};
+			int bytes = { sock.RecvFrom(buff, MAX_DATAGRAM_SIZE, src) };
+			if (bytes == SOCKET_ERROR) {
+				size_t errorCode = WSAGetLastError();
+				if (errorCode != WSAEWOULDBLOCK && errorCode != WSAECONNRESET) {
+					return -2;
+				}
+				using namespace std::chrono_literals;
+				std::this_thread::sleep_for(5ms);
+				continue;
+			}
+			if (FromServer(src)) {
+				handshake.Handle(buff, bytes, Seconds());
+			}
+		}
+
+		if (handshake.State() == HANDSHAKE::S_NO_ANSWER) {
+			return -2;
+		}
+		lastHeard = std::chrono::steady_clock::now();
+		if (handshake.State() == HANDSHAKE::S_CONNECTED) {
+			session = handshake.Session();
+		}
+		return handshake.Player();
+	}
+
 	//2 kinds of packets can be received, regular updates from server, and events from server - firing/asteroid
-	void RecvThread(SOCKET sock) {
+	//Sends every datagram to the server, returns bytes sent or SOCKET_ERROR
+	int SendDatagrams(TRANSPORT::Transport& sock, std::vector<std::string> const& datagrams) {
+		int total{};
+		for (std::string const& datagram : datagrams) {
+			int bytes{ sock.SendTo(datagram.c_str(), (int)datagram.size(), server_dest) };
+			if (bytes == SOCKET_ERROR) {
+				return SOCKET_ERROR;
+			}
+			total += bytes;
+		}
+		return total;
+	}
+
+	//Hands one whole message from the server to its handler
+	void ProcessPacket(const char* buff, int bytesReceived) {
+		//Drop anything too short to parse
+		if (bytesReceived < 1 || bytesReceived < MinimumSize((unsigned char)buff[0])) {
+			return;
+		}
+		TRACE_SCOPE_ARG("packet", (unsigned char)buff[0]);
+
+		unsigned char cmd = (unsigned char)buff[0];
+		switch (cmd) {
+		case CommandID::C_ALL_UPDATE:
+			ProcessAllState(buff, bytesReceived);
+			break;
+		case CommandID::C_ASTEROID_SPAWN:
+			ProcessAsteroidSpawn(buff);
+			break;
+		case CommandID::C_ASTEROID_DESTROY:
+			ProcessAsteroidDestroy(buff);
+			break;
+		case CommandID::C_RSP_FIRE:
+			ProcessRspFire(buff);
+			break;
+		case CommandID::C_TIME_SYNC:
+			ProcessTimeSync(buff);
+			break;
+		case CommandID::C_GAME_END:
+			ProcessGameEnd(buff);
+			break;
+		case CommandID::C_ENTITY_UPDATE:
+			ProcessEntityUpdate(buff, bytesReceived);
+			break;
+		case CommandID::C_FULL_STATE:
+			ProcessFullState(buff, bytesReceived);
+			break;
+		}
+	}
+
+	void RecvThread(TRANSPORT::Transport& sock) {
+		TRACE::NameThread("recv");
 		{
 			std::lock_guard<std::mutex> outMut(_stdoutMutex);
 			std::cout << "Init Recv Thread.." << std::endl;
 		}
 
-		char buff[MAX_STR_LEN]{};
+		char buff[MAX_DATAGRAM_SIZE]{};
+		FRAGMENT::Reassembler reassembler{};
+		std::string message{};
 		while (connected) {
-			sockaddr src{};
-			socklen_t len{ sizeof(src) };
-			const int bytesReceived = recvfrom(sock, buff, MAX_STR_LEN, 0, &src, &len);
+			sockaddr_in src{};
+			const int bytesReceived = sock.RecvFrom(buff, MAX_DATAGRAM_SIZE, src);
 
 			if (bytesReceived == SOCKET_ERROR)
 			{
 				size_t errorCode = WSAGetLastError();
-				if (errorCode == WSAEWOULDBLOCK)
+				if (errorCode == WSAEWOULDBLOCK || errorCode == WSAECONNRESET)
 				{
+					//Server went quiet, reconnect into our slot or end the game
+					if (SinceHeard() > CONNECTION_TIMEOUT) {
+						if (Handshake(sock) != playerNO) {
+							std::lock_guard<std::mutex> usersLock{ _stdoutMutex };
+							std::cerr << "Lost connection to server." << std::endl;
+							connected = false;
+							gameRunning = false;
+							break;
+						}
+						std::lock_guard<std::mutex> usersLock{ _stdoutMutex };
+						std::cout << "Reconnected to server." << std::endl;
+					}
+
 					// A non-blocking call returned no data; sleep and try again.
 					using namespace std::chrono_literals;
 					std::this_thread::sleep_for(200ms);
@@ -239,40 +481,21 @@ namespace {
 				break;
 			}
 			//Ignore if the packet is not from the server
-			sockaddr server_addr = *(sockaddr*)(&server_dest);
-			bool fromServer = true;
-			for (int i = 0; i < 6; ++i) {
-				if (server_addr.sa_data[i] != src.sa_data[i]) {
-					fromServer = false;
-					break;
-				}
-			}
-			if (!fromServer) {
+			if (!FromServer(src)) {
 				continue;
 			}
+			lastHeard = std::chrono::steady_clock::now();
 
-			//Process the packet
-			unsigned char cmd = (unsigned char)buff[0];
-			switch (cmd) {
-			case CommandID::C_ALL_UPDATE:
-				ProcessAllState(buff);
-				break;
-			case CommandID::C_ASTEROID_SPAWN:
-				ProcessAsteroidSpawn(buff);
-				break;
-			case CommandID::C_ASTEROID_DESTROY:
-				ProcessAsteroidDestroy(buff);
-				break;
-			case CommandID::C_RSP_FIRE:
-				ProcessRspFire(buff);
-				break;
-			case CommandID::C_TIME_SYNC:
-				ProcessTimeSync(buff);
-				break;
-			case CommandID::C_GAME_END:
-				ProcessGameEnd(buff);
-				break;
+			//Piece of a larger message, process it once every piece is here
+			if (bytesReceived > 0 && buff[0] == CommandID::C_FRAGMENT) {
+				if (reassembler.Add(0, buff, bytesReceived, appTime, message)) {
+					ProcessPacket(message.data(), (int)message.size());
+				}
+				continue;
 			}
+
+			//A batch holds several messages, anything else is processed as is
+			COALESCE::ForEach(buff, bytesReceived, ProcessPacket);
 		}
 
 		{
@@ -282,54 +505,69 @@ namespace {
 	}
 
 	//2 kinds of packets can be sent, regular state update to server, and client 
-	void SendThread(SOCKET sock) {
+	void SendThread(TRANSPORT::Transport& sock) {
+		TRACE::NameThread("send");
 		{
 			std::lock_guard<std::mutex> outMut(_stdoutMutex);
 			std::cout << "Init Send Thread.." << std::endl;
 		}
 
-		double timer = 0.0;
-		std::chrono::time_point<std::chrono::system_clock> now = std::chrono::system_clock::now();
+		COALESCE::Aggregator outgoing{};
+		std::vector<std::string> ready{};
+		std::chrono::steady_clock::time_point stateDeadline = std::chrono::steady_clock::now();
 		while (connected) {
-			std::chrono::time_point<std::chrono::system_clock> newTime = std::chrono::system_clock::now();
-			timer -= (double)std::chrono::duration_cast<std::chrono::milliseconds>(newTime - now).count();
+			//Sleep until a fire event comes in, or the first simulation tick once the state update is due,
+			//so updates carry fresh state. The timeout covers a simulation that is not ticking
+			bool stateDue{};
+			{
+				std::unique_lock<std::mutex> queueMutx{ _eventMutex };
+				sendWake.wait_until(queueMutx, stateDeadline + TICK_GRACE, [&stateDeadline] {
+					return !connected || !event_queue.empty() ||
+						(simTicked && std::chrono::steady_clock::now() >= stateDeadline);
+				});
+				stateDue = std::chrono::steady_clock::now() >= stateDeadline;
+				if (stateDue) {
+					simTicked = false;
+				}
 
-			if (timer <= 0.0) {	//Simply broadcast state every 50ms
-				std::string packet = CreateUpdate();
-				int bytes{ sendto(sock, packet.c_str(), (int)packet.size(), 0, (sockaddr*)&server_dest, sizeof(server_dest)) };
-				if (bytes == SOCKET_ERROR)
-				{
-					if (WSAGetLastError() != WSAEWOULDBLOCK) {
-						std::cerr << "UDP send fail" << std::endl;
-						closesocket(sock);
-						connected = false;
-						break;
-					}
+				//Broadcast events - firing, sent as soon as they are queued.
+				//One packet carries all of them along with the frames before, in case those were lost
+				if (!event_queue.empty()) {
+					float newest = event_queue.back();
+					event_queue = {};
+					outgoing.Add(CreateReqFire(newest), ready);
 				}
+			}
+			if (!connected) {
+				break;
+			}
+
+			//Simply broadcast state at the adapted rate, events due at the same time ride along
+			if (stateDue) {
+				outgoing.Add(CreateUpdate(), ready);
+			}
 
-				timer = 50.0;
+			if (outgoing.Empty() && ready.empty()) {
+				continue;
 			}
-		
-			//Broadcast events - firing
-			//Check queue, send if any events
+			outgoing.Flush(ready);
+			int bytes = SendDatagrams(sock, ready);
+			ready.clear();
+			if (bytes == SOCKET_ERROR)
 			{
-				std::lock_guard<std::mutex> queueMutx{ _eventMutex };
-				while (!event_queue.empty()) {
-					//send event...
-					float t = event_queue.front();
-					event_queue.pop();
-					std::string packet = CreateReqFire(t);
-					int bytes{ sendto(sock, packet.c_str(), (int)packet.size(), 0, (sockaddr*)&server_dest, sizeof(server_dest)) };
-					if (bytes == SOCKET_ERROR)
-					{
-						if(WSAGetLastError() != WSAEWOULDBLOCK) {
-							std::cerr << "UDP send fail" << std::endl;
-							closesocket(sock);
-							connected = false;
-							break;
-						}
-					}
+				if (WSAGetLastError() != WSAEWOULDBLOCK) {
+					std::cerr << "UDP send fail" << std::endl;
+					connected = false;
+					break;
 				}
+				std::lock_guard<std::mutex> rateLock{ rateMutex };
+				sendRate.OnSendFailed(appTime);
+			}
+
+			if (stateDue) {
+				std::lock_guard<std::mutex> rateLock{ rateMutex };
+				stateDeadline = std::chrono::steady_clock::now() +
+					std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(sendRate.Interval()));
 			}
 		}
 
@@ -341,61 +579,49 @@ namespace {
 	}
 }
 
-//		id - 1b, timestamp - 4b, pos - 8b, scale - 8b, rot - 4b, vel - 8b
+//		id - 1b, timestamp - 4b, pos - 8b, scale - 8b, rot - 4b, vel - 8b, echo - 4b
 std::string CreateUpdate() {
-	std::lock_guard<std::mutex> mut(_gameObjectMutex);
-	std::string packet;
-	packet.push_back(CommandID::C_STATE_UPDATE);
-
-	UINT32 time = htonf(appTime);
-	packet.append((char*)(&time), (char*)(&time) + 4);		//append length as bytes
-
-	Player& player = players[playerNO];
-	//Pos
-	UINT32 tmp = htonf(player.go.t.pos.x);
-	packet.append((char*)(&tmp), (char*)(&tmp) + 4);		//append length as bytes
-	tmp = htonf(player.go.t.pos.y);
-	packet.append((char*)(&tmp), (char*)(&tmp) + 4);		//append length as bytes
-
-	//Scale
-	tmp = htonf(player.go.t.scale.x);
-	packet.append((char*)(&tmp), (char*)(&tmp) + 4);		//append length as bytes
-	tmp = htonf(player.go.t.scale.y);
-	packet.append((char*)(&tmp), (char*)(&tmp) + 4);		//append length as bytes
-
-	//Rot
-	tmp = htonf(player.go.t.rot);
-	packet.append((char*)(&tmp), (char*)(&tmp) + 4);		//append length as bytes
-
-	//Vel
-	tmp = htonf(player.go.vel.x);
-	packet.append((char*)(&tmp), (char*)(&tmp) + 4);		//append length as bytes
-	tmp = htonf(player.go.vel.y);
-	packet.append((char*)(&tmp), (char*)(&tmp) + 4);		//append length as bytes
-
-	return packet;
-}
+	CONTENTION::Lock mut{ _gameObjectMutex };
 
-std::string CreateReqFire(float fire_time) {
-	std::string packet;
-	packet.push_back(CommandID::C_REQ_FIRE);
+	//Echo of the server's timestamp plus how long we held it
+	float echo{};
+	if (latest_server_update > 0.f) {
+		echo = latest_server_update + (appTime - serverUpdateRecvTime);
+	}
 
-	UINT32 time = htonf(fire_time);
-	packet.append((char*)(&time), (char*)(&time) + 4);		//append length as bytes
+	std::lock_guard<std::mutex> eventMut(_eventMutex);
+	return MESSAGE::StateUpdate(appTime, players[playerNO].go, echo, inputHistory);
+}
 
-	return packet;
+//Queue a fire event, the send thread wakes up for it instead of waiting for the next update
+void QueueFire(float fire_time) {
+	{
+		std::lock_guard<std::mutex> eventMut(_eventMutex);
+		inputHistory.Push(fire_time, INPUTFRAME::F_FIRE);
+		event_queue.push(fire_time);
+	}
+	sendWake.notify_one();
 }
 
-std::string CreateReqConnect() {
-	std::string packet;
-	packet.push_back(CommandID::C_REQ_CONNECT);
+//The simulation finished a tick, a due state update can go out now
+void NotifySimTick() {
+	{
+		std::lock_guard<std::mutex> eventMut(_eventMutex);
+		simTicked = true;
+	}
+	sendWake.notify_one();
+}
 
-	return packet;
+//C_REQ_FIRE
+//	id - 1b, input frames
+//	_eventMutex must be held, now is the newest fire time
+std::string CreateReqFire(float now) {
+	return MESSAGE::ReqFire(now, inputHistory);
 }
 
-//	id - 1b, timestamp - 4b, (pos - 8b, scale - 8b, rot - 4b, vel - 8b) * 4
-void ProcessAllState(const char* buffer) {
-	std::lock_guard<std::mutex> goMutx(_gameObjectMutex);
+//	id - 1b, timestamp - 4b, (pos - 8b, scale - 8b, rot - 4b, vel - 8b) * 4, echo - 4b
+void ProcessAllState(const char* buffer, int length) {
+	CONTENTION::Lock goMutx{ _gameObjectMutex };
 
 	FLOAT timestamp = ntohf(*(uint32_t*)(buffer + 1));
 
@@ -405,91 +631,66 @@ void ProcessAllState(const char* buffer) {
 	}
 
 	latest_server_update = timestamp;
-
+	serverUpdateRecvTime = appTime;
+
+	//rtt from our own timestamp echoed back by the server
+	if (length >= ALL_UPDATE_SIZE + 4) {
+		float echo = ntohf(*(uint32_t*)(buffer + ALL_UPDATE_SIZE));
+		if (echo > 0.f) {
+			std::lock_guard<std::mutex> rateLock{ rateMutex };
+			sendRate.OnRttSample(appTime - echo, appTime);
+		}
+	}
 
 	const int initial = 5;
-	const int offset = 8 + 8 + 4 + 8;
+	const int offset = MESSAGE::BODY_SIZE;
 
 	for (int i = 0; i < 4; ++i) {
 		if (i == playerNO) {	//dont update self
 			continue;
 		}
-		AEVec2 pos{}, scale{}, vel{}; float rot{};
-
-		int itOffset = initial + offset * i;
-		//Pos
-		float tmp = ntohf(*(uint32_t*)(buffer + itOffset));
-		pos.x = tmp;
-		tmp = ntohf(*(uint32_t*)(buffer + itOffset + 4));
-		pos.y = tmp;
-		//Scale
-		tmp = ntohf(*(uint32_t*)(buffer + itOffset + 8));
-		scale.x = tmp;
-		tmp = ntohf(*(uint32_t*)(buffer + itOffset + 12));
-		scale.y = tmp;
-		//rot
-		tmp = ntohf(*(uint32_t*)(buffer + itOffset + 16));
-		rot = tmp;
-		//vel
-		tmp = ntohf(*(uint32_t*)(buffer + itOffset + 20));
-		vel.x = tmp;
-		tmp = ntohf(*(uint32_t*)(buffer + itOffset + 24));
-		vel.y = tmp;
+		Transform t{};
+		AEVec2 vel{};
+		MESSAGE::ReadBody(buffer + initial + offset * i, t, vel);
 
 		players[i].go.vel = vel;
-		players[i].go.t.pos = pos;
-		players[i].go.t.rot = rot;
+		players[i].go.t.pos = t.pos;
+		players[i].go.t.rot = t.rot;
 		InterpolateGameobject(players[i].go, timestamp);
 	}
 }
 
-//	id - 1b, timestamp - 4b, playerid - 4b
+//	id - 1b, timestamp - 4b, playerid - 4b, bullet index - 2b
 void ProcessRspFire(const char* buffer) {
-	std::lock_guard<std::mutex> mut(_gameObjectMutex);
+	CONTENTION::Lock mut{ _gameObjectMutex };
 	FLOAT timestamp = ntohf(*(uint32_t*)(buffer + 1));
 	int playerID = (int)ntohl(*(uint32_t*)(buffer + 5));
+	int index = (int)ntohs(*(uint16_t*)(buffer + 9));
 
-	InterpolatedShoot(playerID, timestamp);
+	InterpolatedShoot(playerID, timestamp, index);
 }
 
 //	id - 1b, timestamp - 4b, (pos - 8b, scale - 8b, rot - 4b, vel - 8b) * 4
 void ProcessTimeSync(const char* buffer) {
-	std::lock_guard<std::mutex> goMutx(_gameObjectMutex);
+	CONTENTION::Lock goMutx{ _gameObjectMutex };
 
 	FLOAT timestamp = ntohf(*(uint32_t*)(buffer + 1));
 	latest_server_update = timestamp;
+	serverUpdateRecvTime = timestamp;	//appTime is set to the timestamp below
 
 	const int initial = 5;
-	const int offset = 8 + 8 + 4 + 8;
+	const int offset = MESSAGE::BODY_SIZE;
 	for (int i = 0; i < 4; ++i) {
 		//if (i == playerNO) {	//dont update self
 		//	continue;
 		//}
-		AEVec2 pos{}, scale{}, vel{}; float rot{};
-
-		int itOffset = initial + offset * i;
-		//Pos
-		float tmp = ntohf(*(uint32_t*)(buffer + itOffset));
-		pos.x = tmp;
-		tmp = ntohf(*(uint32_t*)(buffer + itOffset + 4));
-		pos.y = tmp;
-		//Scale
-		tmp = ntohf(*(uint32_t*)(buffer + itOffset + 8));
-		scale.x = tmp;
-		tmp = ntohf(*(uint32_t*)(buffer + itOffset + 12));
-		scale.y = tmp;
-		//rot
-		tmp = ntohf(*(uint32_t*)(buffer + itOffset + 16));
-		rot = tmp;
-		//vel
-		tmp = ntohf(*(uint32_t*)(buffer + itOffset + 20));
-		vel.x = tmp;
-		tmp = ntohf(*(uint32_t*)(buffer + itOffset + 24));
-		vel.y = tmp;
+		Transform t{};
+		AEVec2 vel{};
+		MESSAGE::ReadBody(buffer + initial + offset * i, t, vel);
 
 		players[i].go.vel = vel;
-		players[i].go.t.pos = pos;
-		players[i].go.t.rot = rot;
+		players[i].go.t.pos = t.pos;
+		players[i].go.t.rot = t.rot;
 	}
 	//Interpolate all the asteroids
 	InterpolateGOsync(timestamp);
@@ -499,7 +700,7 @@ void ProcessTimeSync(const char* buffer) {
 //C_GAME_END
 //	id - 1b, (highscore - 4b, date - 8b) * 5, playerscore - 4b * 4
 void ProcessGameEnd(const char* buffer) {
-	std::lock_guard<std::mutex> goMutx(_gameObjectMutex);
+	CONTENTION::Lock goMutx{ _gameObjectMutex };
 	ULONG score{}; double date{};
 	int initial = 1; int offset = 4 + 8;
 
@@ -519,21 +720,121 @@ void ProcessGameEnd(const char* buffer) {
 }
 
 //C_ASTEROID_SPAWN
-//	id - 1b, timestamp - 4b
+//	id - 1b, timestamp - 4b, index - 2b
 void ProcessAsteroidSpawn(const char* buffer) {
-	std::lock_guard<std::mutex> goMutx(_gameObjectMutex);
+	CONTENTION::Lock goMutx{ _gameObjectMutex };
 	FLOAT timestamp = ntohf(*(uint32_t*)(buffer + 1));
+	int index = (int)ntohs(*(uint16_t*)(buffer + 5));
 
-	SpawnInterpolatedAsteroid(timestamp);
+	SpawnInterpolatedAsteroid(timestamp, index);
 }
 
 //C_ASTEROID_DESTROY
 //  id - 1b, index - 4b
 void ProcessAsteroidDestroy(const char* buffer) {
-	std::lock_guard<std::mutex> goMutx(_gameObjectMutex);
+	CONTENTION::Lock goMutx{ _gameObjectMutex };
 
 	int goID = (int)ntohl(*(uint32_t*)(buffer + 1));
-	if (goID < golist.size()) {
+	if (goID >= 0 && goID < (int)golist.size()) {
 		golist[goID].isActive = false;
+		golist.Release(goID);
+	}
+}
+
+//C_ENTITY_UPDATE
+//	id - 1b, timestamp - 4b, count - 2b, (type - 1b, index - 2b, active - 1b, pos - 8b, rot - 4b, vel - 8b, extra - 4b) * count
+void ProcessEntityUpdate(const char* buffer, int length) {
+	const int headerSize = 1 + 4 + 2;
+	const int entitySize = 1 + 2 + 1 + 8 + 4 + 8 + 4;
+	if (length < headerSize) {
+		return;
+	}
+
+	CONTENTION::Lock goMutx{ _gameObjectMutex };
+	FLOAT timestamp = ntohf(*(uint32_t*)(buffer + 1));
+	int count = (int)ntohs(*(uint16_t*)(buffer + 5));
+	if (length < headerSize + count * entitySize) {	//truncated
+		return;
 	}
-}
\ No newline at end of file
+
+	for (int i = 0; i < count; ++i) {
+		const char* entity = buffer + headerSize + entitySize * i;
+		unsigned char type = (unsigned char)entity[0];
+		int index = (int)ntohs(*(uint16_t*)(entity + 1));
+		bool active = entity[3] != 0;
+
+		//Pools are the same size as the server's, anything past the end is not ours to take
+		GameObject* go{};
+		if (type == 0 && index < (int)golist.size()) {	//asteroid
+			if (active) golist.AcquireAt(index);
+			else golist.Release(index);
+			go = &golist[index];
+		}
+		else if (type == 1 && index < (int)bulletlist.size()) {	//bullet
+			if (active) bulletlist.AcquireAt(index);
+			else bulletlist.Release(index);
+			go = &bulletlist[index].go;
+		}
+		else {
+			continue;
+		}
+
+		go->isActive = active;
+		go->t.pos.x = ntohf(*(uint32_t*)(entity + 4));
+		go->t.pos.y = ntohf(*(uint32_t*)(entity + 8));
+		go->t.rot = ntohf(*(uint32_t*)(entity + 12));
+		go->vel.x = ntohf(*(uint32_t*)(entity + 16));
+		go->vel.y = ntohf(*(uint32_t*)(entity + 20));
+		float extra = ntohf(*(uint32_t*)(entity + 24));
+		if (type == 0) {
+			go->t.scale = { extra, extra };
+		}
+		else {
+			bulletlist[index].lifeTime = extra;
+		}
+		InterpolateGameobject(*go, timestamp);
+	}
+}
+
+//C_FULL_STATE
+//	id - 1b, timestamp - 4b, time left - 4b, asteroids spawned - 4b, players, asteroids, bullets
+//	Replaces everything we know, regular updates carry on from here
+void ProcessFullState(const char* buffer, int length) {
+	static SNAPSHOT::State state{};
+	if (!SNAPSHOT::Read(buffer, length, state)) {
+		return;
+	}
+
+	CONTENTION::Lock goMutx{ _gameObjectMutex };
+	for (int i = 0; i < 4 && i < (int)state.players.size(); ++i) {
+		players[i].go.t = state.players[i].t;
+		players[i].go.vel = state.players[i].vel;
+		players[i].score = state.players[i].score;
+	}
+
+	//Same slots as the server, only the live ones are taken
+	golist.Clear();
+	for (int i = 0; i < (int)state.golist.size(); ++i) {
+		if (state.golist[i].isActive && golist.AcquireAt(i) >= 0) {
+			golist[i] = state.golist[i];
+		}
+	}
+	bulletlist.Clear();
+	for (int i = 0; i < (int)state.bulletlist.size(); ++i) {
+		Bullet const& b = state.bulletlist[i];
+		if (!b.go.isActive || bulletlist.AcquireAt(i) < 0) {
+			continue;
+		}
+		bulletlist[i] = b;
+		if (b.playerNO >= 0 && b.playerNO < 4) {
+			bulletlist[i].go.col = players[b.playerNO].go.col;
+		}
+	}
+	SyncAsteroidSpawns(state.header.asteroidsSpawned);
+	timeLeft = state.header.timeLeft;
+
+	//Same as a time sync, we are now at the server's time
+	latest_server_update = state.header.timestamp;
+	serverUpdateRecvTime = state.header.timestamp;
+	appTime = state.header.timestamp;
+}
@@ -0,0 +1,51 @@
+/*!
+\file		assetid.h
+\author		darius (d.chan@digipen.edu)
+\co-author
+\par		Assignment 4
+\date		19/10/2026
+\brief
+interned asset names. every kind of object is a small id fixed at compile
+time, so a gameobject holds a byte instead of a string, comparisons are
+integer compares and the client can index its textures with it directly.
+
+Copyright (C) 2025 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the
+prior written consent of DigiPen Institute of Technology is prohibited.
+*/
+#pragma once
+#include <string_view>
+
+namespace ASSET
+{
+	//dense, so it can index a flat table of A_COUNT entries
+	enum AssetId : unsigned char
+	{
+		A_NONE = 0,
+		A_PLAYER,
+		A_ASTEROID,
+		A_BULLET,
+		A_COUNT
+	};
+
+	//names in AssetId order
+	constexpr std::string_view NAMES[A_COUNT]{ "", "player", "asteroid", "bullet" };
+
+	//id for a name, A_NONE if there is no such asset. done at compile time when name is a literal
+	constexpr AssetId Intern(std::string_view name)
+	{
+		for (int i = 1; i < A_COUNT; ++i)
+		{
+			if (NAMES[i] == name) return (AssetId)i;
+		}
+		return A_NONE;
+	}
+
+	constexpr std::string_view Name(AssetId id)
+	{
+		return id < A_COUNT ? NAMES[id] : NAMES[A_NONE];
+	}
+
+	static_assert(Intern("player") == A_PLAYER && Intern("asteroid") == A_ASTEROID && Intern("bullet") == A_BULLET,
+		"NAMES is out of order with AssetId");
+}
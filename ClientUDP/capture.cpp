@@ -0,0 +1,184 @@
+/*!
+\file		capture.cpp
+\author		darius (d.chan@digipen.edu)
+\co-author
+\par		Assignment 4
+\date		19/10/2026
+\brief
+encoding datagrams into capture records, the writer thread and reading
+records back.
+
+Copyright (C) 2025 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the
+prior written consent of DigiPen Institute of Technology is prohibited.
+*/
+#include "capture.h"
+#include <cstring>
+
+namespace CAPTURE
+{
+	namespace
+	{
+		void AppendLittle(std::string& out, unsigned long long value, int bytes)
+		{
+			for (int i = 0; i < bytes; ++i)
+			{
+				out += (char)((value >> (8 * i)) & 0xFF);
+			}
+		}
+
+		unsigned long long ReadLittle(const unsigned char* in, int bytes)
+		{
+			unsigned long long value{ 0 };
+			for (int i = bytes - 1; i >= 0; --i)
+			{
+				value = (value << 8) | in[i];
+			}
+			return value;
+		}
+	}
+
+	Writer::Writer() : _file{}, _start{}, _mutex{}, _wake{}, _pending{}, _dropped{ 0 }, _stopping{ false }, _thread{}
+	{
+	}
+
+	Writer::~Writer()
+	{
+		Close();
+	}
+
+	bool Writer::Open(std::string const& path, Role role)
+	{
+		Close();
+		_file.open(path, std::ios::binary | std::ios::trunc);
+		if (!_file)
+		{
+			return false;
+		}
+		_file.write(MAGIC, sizeof(MAGIC));
+		_file.put((char)role);
+		_start = std::chrono::steady_clock::now();
+		_stopping = false;
+		_thread = std::thread{ &Writer::WriteThread, this };
+		return true;
+	}
+
+	void Writer::Add(Direction direction, sockaddr_in const& peer, const char* data, int length)
+	{
+		long long time = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - _start).count();
+		std::lock_guard<std::mutex> lock{ _mutex };
+		if (!_thread.joinable() || length < 0)
+		{
+			return;
+		}
+		if (_pending.size() + RECORD_HEADER + (size_t)length > MAX_PENDING)
+		{
+			++_dropped;
+			return;
+		}
+		AppendLittle(_pending, (unsigned long long)time, 8);
+		_pending += (char)direction;
+		_pending.append(reinterpret_cast<const char*>(&peer.sin_addr.s_addr), 4);
+		_pending.append(reinterpret_cast<const char*>(&peer.sin_port), 2);
+		AppendLittle(_pending, (unsigned long long)length, 2);
+		_pending.append(data, (size_t)length);
+		_wake.notify_one();
+	}
+
+	void Writer::Close()
+	{
+		{
+			std::lock_guard<std::mutex> lock{ _mutex };
+			if (!_thread.joinable())
+			{
+				return;
+			}
+			_stopping = true;
+		}
+		_wake.notify_one();
+		_thread.join();
+		_file.close();
+	}
+
+	long long Writer::Dropped() const
+	{
+		std::lock_guard<std::mutex> lock{ _mutex };
+		return _dropped;
+	}
+
+	//takes everything waiting at once and writes it outside the lock, flushed so a killed process keeps it
+	void Writer::WriteThread()
+	{
+		std::string writing{};
+		std::unique_lock<std::mutex> lock{ _mutex };
+		while (true)
+		{
+			_wake.wait(lock, [this] { return _stopping || !_pending.empty(); });
+			if (_pending.empty() && _stopping)
+			{
+				return;
+			}
+			writing.swap(_pending);
+			lock.unlock();
+			_file.write(writing.data(), (std::streamsize)writing.size());
+			_file.flush();
+			writing.clear();
+			lock.lock();
+		}
+	}
+
+	bool Reader::Open(std::string const& path)
+	{
+		_file.open(path, std::ios::binary);
+		char magic[sizeof(MAGIC)]{};
+		char role{};
+		if (!_file.read(magic, sizeof(magic)) || std::memcmp(magic, MAGIC, sizeof(MAGIC)) != 0 || !_file.get(role))
+		{
+			return false;
+		}
+		_role = (Role)role;
+		return true;
+	}
+
+	bool Reader::Next(Record& record)
+	{
+		unsigned char header[RECORD_HEADER];
+		if (!_file.read(reinterpret_cast<char*>(header), RECORD_HEADER))
+		{
+			return false;
+		}
+		record.time = (double)ReadLittle(header, 8) / 1e6;
+		record.direction = (Direction)header[8];
+		record.peer = sockaddr_in{};
+		record.peer.sin_family = AF_INET;
+		std::memcpy(&record.peer.sin_addr.s_addr, header + 9, 4);
+		std::memcpy(&record.peer.sin_port, header + 13, 2);
+		record.data.resize((size_t)ReadLittle(header + 15, 2));
+		return (bool)_file.read(record.data.data(), (std::streamsize)record.data.size());
+	}
+
+	CaptureTransport::CaptureTransport(std::unique_ptr<TRANSPORT::Transport> inner, std::unique_ptr<Writer> writer)
+		: _inner{ std::move(inner) }, _writer{ std::move(writer) }
+	{
+	}
+
+	int CaptureTransport::SendTo(const char* data, int length, sockaddr_in const& to)
+	{
+		int sent = _inner->SendTo(data, length, to);
+		if (sent != SOCKET_ERROR)
+		{
+			_writer->Add(D_OUT, to, data, length);
+		}
+		return sent;
+	}
+
+	int CaptureTransport::RecvFrom(char* buffer, int length, sockaddr_in& from)
+	{
+		int received = _inner->RecvFrom(buffer, length, from);
+		if (received != SOCKET_ERROR)
+		{
+			_writer->Add(D_IN, from, buffer, received);
+		}
+		return received;
+	}
+}
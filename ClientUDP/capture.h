@@ -0,0 +1,121 @@
+/*!
+\file		capture.h
+\author		darius (d.chan@digipen.edu)
+\co-author
+\par		Assignment 4
+\date		19/10/2026
+\brief
+records every datagram a transport sends and receives into a capture file,
+and reads capture files back. a thread of the writer's own does the disk
+writes, the networking threads only append to a buffer in memory.
+
+file: magic "NA4CAP1" with its 0 - 8b, role - 1b, then per datagram
+time - 8b, direction - 1b, address - 4b, port - 2b, length - 2b, data - length.
+time is microseconds since the capture started. time and length are little
+endian, address and port are kept in network order as they were on the wire.
+a file cut short by a crash ends at its last whole record.
+
+Copyright (C) 2025 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the
+prior written consent of DigiPen Institute of Technology is prohibited.
+*/
+#pragma once
+#include "transport.h"
+#include <chrono>
+#include <condition_variable>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace CAPTURE
+{
+	const char MAGIC[8] = "NA4CAP1";
+	const int RECORD_HEADER = 8 + 1 + 4 + 2 + 2;
+	const size_t MAX_PENDING = 16 << 20;	//bytes waiting for the disk before new datagrams are dropped
+
+	//which end wrote the capture
+	enum Role : unsigned char
+	{
+		R_SERVER = 'S',
+		R_CLIENT = 'C'
+	};
+
+	//seen from whoever captured it
+	enum Direction : unsigned char
+	{
+		D_IN = 0,	//received from peer
+		D_OUT = 1	//sent to peer
+	};
+
+	struct Record
+	{
+		double time;		//seconds since the capture started
+		Direction direction;
+		sockaddr_in peer;
+		std::string data;
+	};
+
+	class Writer
+	{
+	public:
+		Writer();
+		~Writer();		//writes what is still waiting
+		Writer(Writer const&) = delete;
+		Writer& operator=(Writer const&) = delete;
+
+		//false if the file cannot be created
+		bool Open(std::string const& path, Role role);
+
+		//copies the datagram, never waits on the disk
+		void Add(Direction direction, sockaddr_in const& peer, const char* data, int length);
+
+		void Close();
+
+		//datagrams left out because the disk fell behind by MAX_PENDING
+		long long Dropped() const;
+
+	private:
+		void WriteThread();
+
+		std::ofstream _file;
+		std::chrono::steady_clock::time_point _start;
+		mutable std::mutex _mutex;
+		std::condition_variable _wake;
+		std::string _pending;		//encoded records the thread has not written yet
+		long long _dropped;
+		bool _stopping;
+		std::thread _thread;
+	};
+
+	class Reader
+	{
+	public:
+		//false if the file is missing or not a capture
+		bool Open(std::string const& path);
+
+		Role GetRole() const { return _role; }
+
+		//the next datagram, false at the end of the file
+		bool Next(Record& record);
+
+	private:
+		std::ifstream _file;
+		Role _role{ R_SERVER };
+	};
+
+	//wraps another transport and hands every datagram that went through it to a writer
+	class CaptureTransport : public TRANSPORT::Transport
+	{
+	public:
+		CaptureTransport(std::unique_ptr<TRANSPORT::Transport> inner, std::unique_ptr<Writer> writer);
+
+		int SendTo(const char* data, int length, sockaddr_in const& to) override;
+		int RecvFrom(char* buffer, int length, sockaddr_in& from) override;
+
+	private:
+		std::unique_ptr<TRANSPORT::Transport> _inner;
+		std::unique_ptr<Writer> _writer;
+	};
+}
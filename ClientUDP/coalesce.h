@@ -0,0 +1,71 @@
+/*!
+\file		coalesce.h
+\author		darius (d.chan@digipen.edu)
+\co-author
+\par		Assignment 4
+\date		19/10/2026
+\brief
+packs several small messages for the same peer into one C_BATCH datagram
+so events that happen in the same tick share the ip/udp headers, and
+splits them up again on the receiving side.
+
+Copyright (C) 2025 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the
+prior written consent of DigiPen Institute of Technology is prohibited.
+*/
+#pragma once
+#include "protocol.h"
+#include <string>
+#include <vector>
+
+namespace COALESCE
+{
+	const int HEADER_SIZE = 1;		//id
+	const int LENGTH_SIZE = 2;		//before every message in the batch
+
+	//outgoing messages towards one peer
+	class Aggregator
+	{
+	public:
+		Aggregator();
+
+		//adds message to the datagram being built. datagrams that have to go out first,
+		//because the message did not fit, are added to ready in the order they must be sent.
+		//a message too big to ever share a datagram is added to ready on its own
+		void Add(std::string const& message, std::vector<std::string>& ready);
+
+		//moves the datagram being built into ready. a lone message is sent without the batch header
+		void Flush(std::vector<std::string>& ready);
+
+		bool Empty() const;
+
+	private:
+		std::string _batch;
+		std::string _first;		//kept apart until a second message turns this into a batch
+		int _count;
+	};
+
+	//calls handler(data, length) for every message in a C_BATCH datagram, or once for any other datagram.
+	//returns false if the batch was malformed, messages before the bad entry are still handled
+	template <typename THandler>
+	bool ForEach(const char* datagram, int length, THandler&& handler)
+	{
+		if (length < 1) return false;
+		if ((unsigned char)datagram[0] != C_BATCH)
+		{
+			handler(datagram, length);
+			return true;
+		}
+
+		int offset = HEADER_SIZE;
+		while (offset + LENGTH_SIZE <= length)
+		{
+			int size = ((unsigned char)datagram[offset] << 8) | (unsigned char)datagram[offset + 1];
+			offset += LENGTH_SIZE;
+			if (size == 0 || offset + size > length) return false;
+			handler(datagram + offset, size);
+			offset += size;
+		}
+		return offset == length;
+	}
+}
@@ -13,10 +13,58 @@ prior written consent of DigiPen Institute of Technology is prohibited.
 */
 #pragma once
 #include "gameobject.h"
+#include "pool.h"
 
 namespace COLLISION
 {
 	bool IsWithinDistanceCheck(Transform const& a, Transform const& b);
 	bool IsWithinDistanceCheckDynamic(GameObject const& a, GameObject const& b, float dt);
 
+	//the server's collision pass. every asteroid is checked against every player, then every bullet against the
+	//asteroids until it hits one. the asteroid hit and a bullet that hit are made inactive, the caller gives the
+	//bullet's slot back. then onPlayerHit(player, asteroid index) or onBulletHit(bullet, asteroid index) is called
+	template <typename TPlayerHit, typename TBulletHit>
+	void CheckAsteroidHits(Player* players, size_t playerCount, Pool<GameObject>& golist, Pool<Bullet>& bulletlist, float dt,
+		TPlayerHit&& onPlayerHit, TBulletHit&& onBulletHit)
+	{
+		//check if player hit an asteroid
+		for (int i = 0; i < (int)golist.size(); i++)
+		{
+			GameObject& go = golist[i];
+			if (!go.isActive || go.texid != ASSET::A_ASTEROID) {
+				continue;
+			}
+			for (size_t p = 0; p < playerCount; ++p)
+			{
+				if (IsWithinDistanceCheckDynamic(players[p].go, go, dt))
+				{
+					go.isActive = false;
+					onPlayerHit(players[p], i);
+				}
+			}
+		}
+
+		//check if any bullet hit an asteroid
+		for (int j = 0; j < (int)bulletlist.size(); j++)
+		{
+			Bullet& b = bulletlist[j];
+			if (!b.go.isActive) {
+				continue;
+			}
+			for (int i = 0; i < (int)golist.size(); i++)
+			{
+				GameObject& go = golist[i];
+				if (!go.isActive || go.texid != ASSET::A_ASTEROID) {
+					continue;
+				}
+				if (IsWithinDistanceCheckDynamic(b.go, go, dt))
+				{
+					b.go.isActive = go.isActive = false;
+					onBulletHit(b, i);
+					break;
+				}
+			}
+		}
+	}
+
 }
\ No newline at end of file
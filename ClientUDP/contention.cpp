@@ -0,0 +1,245 @@
+/*!
+\file		contention.cpp
+\author		darius (d.chan@digipen.edu)
+\co-author
+\par		Assignment 4
+\date		19/10/2026
+\brief
+per site lock numbers of every profiled mutex, and the report of the ones
+that waited the longest.
+
+Copyright (C) 2025 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the
+prior written consent of DigiPen Institute of Technology is prohibited.
+*/
+#include "contention.h"
+#include "trace.h"
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+namespace CONTENTION
+{
+	std::atomic<bool> enabled{ false };
+
+	namespace
+	{
+		//every ProfiledMutex alive. a function static, the mutexes are globals constructed before main
+		struct Registry
+		{
+			std::mutex mutex;
+			std::vector<ProfiledMutex*> all;
+		};
+
+		Registry& Mutexes()
+		{
+			static Registry registry{};
+			return registry;
+		}
+
+		long long Total(std::vector<SiteStats> const& sites, long long SiteStats::* field)
+		{
+			long long total{ 0 };
+			for (SiteStats const& s : sites)
+			{
+				total += s.*field;
+			}
+			return total;
+		}
+
+		long long Max(std::vector<SiteStats> const& sites, long long SiteStats::* field)
+		{
+			long long most{ 0 };
+			for (SiteStats const& s : sites)
+			{
+				most = std::max(most, s.*field);
+			}
+			return most;
+		}
+
+		//file name without its directories
+		const char* ShortFile(const char* path)
+		{
+			const char* name = path;
+			for (const char* c = path; *c; ++c)
+			{
+				if (*c == '/' || *c == '\\') name = c + 1;
+			}
+			return name;
+		}
+
+		//"void __cdecl HandlePacket(...)" down to "HandlePacket"
+		std::string ShortFunction(const char* signature)
+		{
+			std::string name{ signature };
+			size_t paren = name.find('(');
+			if (paren != std::string::npos) name.resize(paren);
+			while (!name.empty() && name.back() == ' ') name.pop_back();	//"operator ()"
+			size_t space = name.rfind(' ');
+			return space == std::string::npos ? name : name.substr(space + 1);
+		}
+
+		double Microseconds(long long nanoseconds)
+		{
+			return (double)nanoseconds / 1000.0;
+		}
+	}
+
+	void SetEnabled(bool on)
+	{
+		enabled.store(on, std::memory_order_relaxed);
+	}
+
+	ProfiledMutex::ProfiledMutex(const char* name)
+		: _name{ name }, _waitName{ std::string{ "wait " } + name }, _mutex{}, _sites{}, _owner{ nullptr }, _acquiredAt{ 0 }
+	{
+		Registry& registry = Mutexes();
+		std::lock_guard<std::mutex> lock{ registry.mutex };
+		registry.all.push_back(this);
+	}
+
+	ProfiledMutex::~ProfiledMutex()
+	{
+		Registry& registry = Mutexes();
+		std::lock_guard<std::mutex> lock{ registry.mutex };
+		registry.all.erase(std::remove(registry.all.begin(), registry.all.end(), this), registry.all.end());
+	}
+
+	SiteStats& ProfiledMutex::Site(std::source_location const& site)
+	{
+		//a handful of sites per mutex, and the same site always hands in the same file name
+		for (SiteStats& s : _sites)
+		{
+			if (s.line == site.line() && s.file == site.file_name())
+			{
+				return s;
+			}
+		}
+		_sites.push_back(SiteStats{ site.file_name(), site.line(), site.function_name(), 0, 0, 0, 0, 0, 0 });
+		return _sites.back();
+	}
+
+	void ProfiledMutex::lock(std::source_location const& site)
+	{
+		bool profiled = Enabled();
+		bool traced = TRACE::Enabled();
+		if (!profiled && !traced)
+		{
+			_mutex.lock();
+			_owner = nullptr;
+			return;
+		}
+
+		//only a lock that is taken already costs a second clock read
+		long long begin = TRACE::Now();
+		bool contended = !_mutex.try_lock();
+		long long acquired = begin;
+		if (contended)
+		{
+			_mutex.lock();
+			acquired = TRACE::Now();
+			if (traced)
+			{
+				TRACE::Complete(_waitName.c_str(), begin, acquired);
+			}
+		}
+
+		_owner = nullptr;
+		if (profiled)
+		{
+			SiteStats& s = Site(site);
+			++s.acquisitions;
+			if (contended)
+			{
+				++s.contended;
+				s.waited += acquired - begin;
+				s.maxWait = std::max(s.maxWait, acquired - begin);
+			}
+			_owner = &s;
+			_acquiredAt = acquired;
+		}
+	}
+
+	void ProfiledMutex::unlock()
+	{
+		if (_owner)
+		{
+			long long hold = TRACE::Now() - _acquiredAt;
+			_owner->held += hold;
+			_owner->maxHold = std::max(_owner->maxHold, hold);
+			_owner = nullptr;
+		}
+		_mutex.unlock();
+	}
+
+	std::vector<SiteStats> ProfiledMutex::Sites()
+	{
+		std::lock_guard<std::mutex> lock{ _mutex };
+		return _sites;
+	}
+
+	void ProfiledMutex::Clear()
+	{
+		std::lock_guard<std::mutex> lock{ _mutex };
+		_sites.clear();
+	}
+
+	std::string Report()
+	{
+		struct Entry
+		{
+			const char* name;
+			std::vector<SiteStats> sites;
+			long long waited;
+		};
+		std::vector<Entry> entries{};
+		{
+			Registry& registry = Mutexes();
+			std::lock_guard<std::mutex> lock{ registry.mutex };
+			for (ProfiledMutex* mutex : registry.all)
+			{
+				std::vector<SiteStats> sites = mutex->Sites();
+				long long waited = Total(sites, &SiteStats::waited);
+				entries.push_back(Entry{ mutex->Name(), std::move(sites), waited });
+			}
+		}
+		std::sort(entries.begin(), entries.end(), [](Entry const& a, Entry const& b) { return a.waited > b.waited; });
+
+		std::ostringstream out{};
+		out << std::fixed << std::setprecision(1);
+		for (Entry& e : entries)
+		{
+			long long acquisitions = Total(e.sites, &SiteStats::acquisitions);
+			if (acquisitions == 0) continue;
+			long long contended = Total(e.sites, &SiteStats::contended);
+			out << e.name << ": " << acquisitions << " locks, " << contended << " contended ("
+				<< 100.0 * (double)contended / (double)acquisitions << "%), waited " << Microseconds(e.waited) << "us (max "
+				<< Microseconds(Max(e.sites, &SiteStats::maxWait)) << "), held " << Microseconds(Total(e.sites, &SiteStats::held))
+				<< "us (max " << Microseconds(Max(e.sites, &SiteStats::maxHold)) << ")\n";
+
+			std::sort(e.sites.begin(), e.sites.end(), [](SiteStats const& a, SiteStats const& b)
+				{
+					return a.waited != b.waited ? a.waited > b.waited : a.held > b.held;
+				});
+			for (size_t i = 0; i < e.sites.size() && i < (size_t)REPORT_SITES; ++i)
+			{
+				SiteStats const& s = e.sites[i];
+				out << "  " << ShortFile(s.file) << ":" << s.line << " " << ShortFunction(s.function)
+					<< " locks=" << s.acquisitions << " contended=" << s.contended
+					<< " wait=" << Microseconds(s.waited) << "us max=" << Microseconds(s.maxWait)
+					<< " hold=" << Microseconds(s.held) << "us max=" << Microseconds(s.maxHold) << "\n";
+			}
+		}
+		return out.str();
+	}
+
+	void Clear()
+	{
+		Registry& registry = Mutexes();
+		std::lock_guard<std::mutex> lock{ registry.mutex };
+		for (ProfiledMutex* mutex : registry.all)
+		{
+			mutex->Clear();
+		}
+	}
+}
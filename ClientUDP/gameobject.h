@@ -14,7 +14,8 @@ prior written consent of DigiPen Institute of Technology is prohibited.
 */
 #pragma once
 #include "AEEngine.h"
-#include <string>
+#include "assetid.h"
+#include <type_traits>
 
 //r,g,b,a
 struct Color
@@ -30,12 +31,12 @@ struct Transform
 	float rot;
 };
 
-//Transform, vel, texString, color, isactive
+//Transform, vel, texid, color, isactive
 struct GameObject
 {
 	Transform t;
 	AEVec2 vel;
-	std::string texid;
+	ASSET::AssetId texid;
 	Color col;
 	bool isActive;
 
@@ -44,14 +45,14 @@ struct GameObject
 	void Render(AEGfxVertexList* meshPtr, AEGfxTexture* texPtr = nullptr) const;
 };
 
-//GameObject(Transform, vel, texString, color, isactive), score
+//GameObject(Transform, vel, texid, color, isactive), score
 struct Player
 {
 	GameObject go;
 	int score;
 };
 
-//GameObject(Transform, vel, texString, color, isactive), lifetime, playerNO
+//GameObject(Transform, vel, texid, color, isactive), lifetime, playerNO
 struct Bullet
 {
 	GameObject go;
@@ -60,3 +61,11 @@ struct Bullet
 	void Update(AEVec2 const& screenSize, float dt);
 	void Render(AEGfxVertexList* meshPtr, AEGfxTexture* texPtr = nullptr) const;
 };
+
+//whether an object is in use, lets a Pool hold either kind
+inline bool IsActive(GameObject const& go) { return go.isActive; }
+inline bool IsActive(Bullet const& b) { return b.go.isActive; }
+
+//plain data, so storage can copy objects around with memcpy
+static_assert(std::is_trivially_copyable<GameObject>::value && std::is_trivially_copyable<Bullet>::value &&
+	std::is_trivially_copyable<Player>::value, "gameobjects must stay trivially copyable");
@@ -0,0 +1,115 @@
+/*!
+\file		handshake.cpp
+\author		darius (d.chan@digipen.edu)
+\co-author
+\par		Assignment 4
+\date		19/10/2026
+\brief
+connect requests and the answers to them.
+
+Copyright (C) 2025 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the
+prior written consent of DigiPen Institute of Technology is prohibited.
+*/
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+
+#include "Windows.h"
+#include "winsock2.h"	// htonl, ntohl
+
+#include "handshake.h"
+#include "protocol.h"
+#include <algorithm>
+
+namespace HANDSHAKE
+{
+	std::string ReqConnect(unsigned int cookie, unsigned int session)
+	{
+		std::string message{};
+		message.push_back(C_REQ_CONNECT);
+		unsigned int tmp = htonl(cookie);
+		message.append((char*)(&tmp), (char*)(&tmp) + 4);
+		tmp = htonl(session);
+		message.append((char*)(&tmp), (char*)(&tmp) + 4);
+		return message;
+	}
+
+	Handshake::Handshake() : _status{ S_NO_ANSWER }, _cookie{ 0 }, _session{ 0 }, _player{ -1 }, _attempts{ 0 }, _answered{ false },
+		_wait{ FIRST_WAIT }, _retryAt{ 0.0 }
+	{
+	}
+
+	void Handshake::Start(unsigned int session, double now)
+	{
+		_status = S_PENDING;
+		_cookie = 0;
+		_session = session;
+		_player = -1;
+		_attempts = 0;
+		_answered = true;
+		_wait = FIRST_WAIT;
+		_retryAt = now;
+	}
+
+	bool Handshake::Due(double now, std::string& request)
+	{
+		if (_status != S_PENDING || now < _retryAt) return false;
+		if (_attempts >= ATTEMPTS)
+		{
+			_status = S_NO_ANSWER;
+			return false;
+		}
+
+		//a challenge is answered at once, silence waits longer every time
+		if (!_answered) _wait = std::min(_wait * 2.0, MAX_WAIT);
+		_answered = false;
+		++_attempts;
+		_retryAt = now + _wait;
+		request = ReqConnect(_cookie, _session);
+		return true;
+	}
+
+	void Handshake::Handle(const char* buffer, int length, double now)
+	{
+		if (_status != S_PENDING || length < 1 || length < MinimumSize((unsigned char)buffer[0])) return;
+
+		switch ((unsigned char)buffer[0])
+		{
+		case C_CHALLENGE:
+			//echo the cookie straight back
+			_cookie = ntohl(*(uint32_t*)(buffer + 1));
+			_answered = true;
+			_retryAt = now;
+			break;
+		case C_RSP_CONNECT:
+			_player = (int)ntohl(*(uint32_t*)(buffer + 1));
+			if (_player < 0)
+			{
+				_player = -1;
+				_status = S_FULL;
+				break;
+			}
+			_session = ntohl(*(uint32_t*)(buffer + 5));
+			_status = S_CONNECTED;
+			break;
+		default:
+			break;
+		}
+	}
+
+	Status Handshake::State() const
+	{
+		return _status;
+	}
+
+	int Handshake::Player() const
+	{
+		return _player;
+	}
+
+	unsigned int Handshake::Session() const
+	{
+		return _session;
+	}
+}
@@ -0,0 +1,66 @@
+/*!
+\file		handshake.h
+\author		darius (d.chan@digipen.edu)
+\co-author
+\par		Assignment 4
+\date		19/10/2026
+\brief
+the client's side of connecting to the server:
+C_REQ_CONNECT -> C_CHALLENGE -> C_REQ_CONNECT with the cookie -> C_RSP_CONNECT.
+requests are retransmitted with backoff and carry the session of the slot
+held before, so a reconnect gets the same player back. it never blocks,
+the game waits on it in its own loop and a load bot steps it from its tick.
+
+Copyright (C) 2025 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the
+prior written consent of DigiPen Institute of Technology is prohibited.
+*/
+#pragma once
+#include <string>
+
+namespace HANDSHAKE
+{
+	const int ATTEMPTS = 8;
+	const double FIRST_WAIT = 0.1;	//seconds to wait for an answer, doubled after every unanswered request
+	const double MAX_WAIT = 1.6;
+
+	enum Status
+	{
+		S_PENDING,
+		S_CONNECTED,
+		S_FULL,			//the server has no slot for us
+		S_NO_ANSWER		//every request went unanswered
+	};
+
+	//C_REQ_CONNECT - id, cookie, session
+	std::string ReqConnect(unsigned int cookie, unsigned int session);
+
+	class Handshake
+	{
+	public:
+		Handshake();
+
+		//starts over, session is 0 for a new player. the first request is due at once
+		void Start(unsigned int session, double now);
+
+		//true with the C_REQ_CONNECT to send when one is due
+		bool Due(double now, std::string& request);
+
+		//a message from the server, anything but C_CHALLENGE and C_RSP_CONNECT is ignored
+		void Handle(const char* buffer, int length, double now);
+
+		Status State() const;
+		int Player() const;				//-1 unless connected
+		unsigned int Session() const;	//from C_RSP_CONNECT, or the one Start was given
+
+	private:
+		Status _status;
+		unsigned int _cookie;
+		unsigned int _session;
+		int _player;
+		int _attempts;
+		bool _answered;		//the last request got a C_CHALLENGE back
+		double _wait;
+		double _retryAt;
+	};
+}
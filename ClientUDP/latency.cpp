@@ -0,0 +1,86 @@
+/*!
+\file		latency.cpp
+\author		darius (d.chan@digipen.edu)
+\co-author
+\par		Assignment 4
+\date		19/10/2026
+\brief
+fixed size latency histogram.
+
+Copyright (C) 2025 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the
+prior written consent of DigiPen Institute of Technology is prohibited.
+*/
+#include "latency.h"
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+#include <iomanip>
+
+namespace LATENCY
+{
+	Histogram::Histogram() : _counts{}, _count{ 0 }, _max{ 0.f }
+	{
+	}
+
+	void Histogram::Add(float seconds)
+	{
+		if (!std::isfinite(seconds) || seconds < 0.f) return;
+		int bucket = std::min((int)(seconds * 1000.f), BUCKETS);
+		++_counts[bucket];
+		++_count;
+		_max = std::max(_max, seconds);
+	}
+
+	void Histogram::Merge(Histogram const& other)
+	{
+		for (int i = 0; i <= BUCKETS; ++i) _counts[i] += other._counts[i];
+		_count += other._count;
+		_max = std::max(_max, other._max);
+	}
+
+	void Histogram::Clear()
+	{
+		_counts.fill(0);
+		_count = 0;
+		_max = 0.f;
+	}
+
+	int Histogram::Count() const
+	{
+		return _count;
+	}
+
+	float Histogram::Percentile(float p) const
+	{
+		if (_count == 0) return 0.f;
+		//rank of the sample wanted, 1 based
+		long long rank = std::max(1LL, (long long)std::ceil(std::clamp(p, 0.f, 1.f) * _count));
+		long long seen{};
+		for (int i = 0; i <= BUCKETS; ++i)
+		{
+			seen += _counts[i];
+			//upper edge of the bucket, never past the slowest sample actually seen
+			if (seen >= rank) return std::min((i + 1) * 0.001f, _max);
+		}
+		return _max;
+	}
+
+	float Histogram::Max() const
+	{
+		return _max;
+	}
+
+	std::string Histogram::Summary() const
+	{
+		std::ostringstream out{};
+		out << std::fixed << std::setprecision(1)
+			<< "n=" << _count
+			<< " p50=" << Percentile(0.5f) * 1000.f
+			<< " p90=" << Percentile(0.9f) * 1000.f
+			<< " p99=" << Percentile(0.99f) * 1000.f
+			<< " p99.9=" << Percentile(0.999f) * 1000.f
+			<< " max=" << _max * 1000.f << "ms";
+		return out.str();
+	}
+}
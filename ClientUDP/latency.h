@@ -0,0 +1,46 @@
+/*!
+\file		latency.h
+\author		darius (d.chan@digipen.edu)
+\co-author
+\par		Assignment 4
+\date		19/10/2026
+\brief
+fixed size latency histogram. samples go into 1ms buckets, so adding one
+is a single increment and percentiles are read back without keeping or
+sorting the samples.
+
+Copyright (C) 2025 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the
+prior written consent of DigiPen Institute of Technology is prohibited.
+*/
+#pragma once
+#include <array>
+#include <string>
+
+namespace LATENCY
+{
+	const int BUCKETS = 2000;	//1ms each, anything slower lands in the last one
+
+	class Histogram
+	{
+	public:
+		Histogram();
+
+		void Add(float seconds);
+		void Merge(Histogram const& other);
+		void Clear();
+
+		int Count() const;
+		//seconds below which p of the samples fall, p in [0, 1]. 0 when empty
+		float Percentile(float p) const;
+		float Max() const;
+
+		//n, p50, p90, p99, p99.9 and max in ms on one line
+		std::string Summary() const;
+
+	private:
+		std::array<unsigned int, BUCKETS + 1> _counts;
+		int _count;
+		float _max;
+	};
+}
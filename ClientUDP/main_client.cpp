@@ -17,35 +17,36 @@ prior written consent of DigiPen Institute of Technology is prohibited.
 #include <crtdbg.h> // To check for memory leaks
 #include "AEEngine.h"  //uses winsock(disabled via macro)
 #include "gameobject.h"
-#include <map>
 #include <vector>
 #include <random>
 #include "collision.h"
+#include "renderer.h"
+#include "triplebuffer.h"
 
-#include "Math.h"
 #include "Network.h"
+#include "ship.h"
 #include "Global.h"
+#include "trace.h"
+#include "contention.h"
 
 
-std::vector<Bullet> bulletlist{};			//every bullet in the game
-std::vector<GameObject> golist{};			//every other gameobject in the game
+//every bullet and asteroid in the game, same capacity as the server so slot indices carry over
+Pool<Bullet> bulletlist{ MAX_BULLETS, Bullet{ { {{0.f, 0.f},{10.f, 10.f}, 0.f}, {}, ASSET::A_BULLET, {1.f, 1.f, 1.f, 1.f}, false }, 0.f, 0 }, P_RECYCLE_OLDEST };
+Pool<GameObject> golist{ MAX_ASTEROIDS, GameObject{ {{0.f, 0.f},{0.f, 0.f}, 0.f}, {}, ASSET::A_ASTEROID, {0.f, 0.f, 0.f, 1.f}, false }, P_RECYCLE_OLDEST };
 int playerNO{ 0 };							//[0,3] the id number of the current player, also decides the player's color
 Player players[4]{};
 float appTime{ 0.f };
 std::pair<ULONG, ULONGLONG> highscores[5]{};
+float timeLeft{ 60.f };						//match length on the server, until a C_FULL_STATE says otherwise
 
 std::atomic<bool> gameRunning = false;
 namespace
 {
 
 	//CONST DEFINITIONS
-	const AEVec2 screen{ 1600.f, 900.f };	//application window width & height
+	const AEVec2 screen{ SHIP::SCREEN };	//application window width & height
 	const float BULLET_SPEED = 1000.f;		//player bullet speed
 	
-	const float ACCELERATION = 100.f;		//player acceleration - increase by 10 per second
-	const float MAX_SPEED = 200.f;			//player max speed
-
-	const float ROTATE_SPEED = 100.f;		//player rotate
 	const float ASTEROID_SPAWN_SPEED = 2.f; //seconds
 	const float ASTEROID_MIN_SIZE = 50.f;	//min radius
 	const float ASTEROID_MAX_SIZE = 100.f;	//max radius
@@ -55,11 +56,12 @@ namespace
 
 	//gameobject data
 	std::string playerName{ std::to_string(playerNO + 1) }; //player chosen name(needed for highscore)
-	//Player player{ {{{0.f, 0.f},{50.f, 50.f}, 0.f}, {}, "player", {1.f, 0.f, 0.f, 1.f}, true}, 0 };
+	//Player player{ {{{0.f, 0.f},{50.f, 50.f}, 0.f}, {}, ASSET::A_PLAYER, {1.f, 0.f, 0.f, 1.f}, true}, 0 };
 
 	//mesh and texture data
 	AEGfxVertexList* meshList[2];
-	std::map<std::string, AEGfxTexture*> texMap;
+	AEGfxTexture* texTable[ASSET::A_COUNT]{};	//indexed by texid, nullptr draws untextured
+	RENDER::Batcher batcher{};					//players, asteroids and bullets are drawn through this
 	s8 dFont;
 
 	void InitMesh()
@@ -87,9 +89,9 @@ namespace
 	}
 	void InitTexture()
 	{
-		texMap["player"] = AEGfxTextureLoad("Assets/ship.png");
-		texMap["asteroid"] = AEGfxTextureLoad("Assets/planet.png");
-		texMap["bullet"] = nullptr;
+		texTable[ASSET::A_PLAYER] = AEGfxTextureLoad("Assets/ship.png");
+		texTable[ASSET::A_ASTEROID] = AEGfxTextureLoad("Assets/planet.png");
+		texTable[ASSET::A_BULLET] = nullptr;
 		dFont = AEGfxCreateFont("Assets/liberation-mono.ttf", 75);
 	}
 	void Free()
@@ -99,91 +101,87 @@ namespace
 			AEGfxMeshFree(meshList[i]);
 		}
 
-		for (auto p : texMap) {
-			if (p.second) {
-				AEGfxTextureUnload(p.second);
+		for (AEGfxTexture*& tex : texTable) {
+			if (tex) {
+				AEGfxTextureUnload(tex);
+				tex = nullptr;
 			}
 		}
 	}
 
-	//player shooting bullet logic - returns ref to the bullet that was shot
-	Bullet& Shoot(AEVec2 const& pos, float angle, int playerID)
+	//player shooting bullet logic - puts the bullet in the slot the server gave it, nullptr if index is out of range
+	Bullet* Shoot(AEVec2 const& pos, float angle, int playerID, int index)
 	{
+		if (bulletlist.AcquireAt(index) < 0)
+		{
+			return nullptr;
+		}
 		float rad{ AEDegToRad(angle) };
 		AEVec2 vel{ cosf(rad) * BULLET_SPEED, sinf(rad) * BULLET_SPEED};
 		//bullet - go, lifetime, isactive
-		Bullet tmp{ { { pos, { 10.f, 10.f }, angle }, vel, "bullet", players[playerID].go.col, true}, 1.f, playerID };
-		//finds non active bullet in list to replace
-		for (auto& b : bulletlist)
-		{
-			if (!b.go.isActive)
-			{
-				b = tmp;
-				return b;
-			}
-		}
-		bulletlist.push_back(tmp);
+		bulletlist[index] = { { { pos, { 10.f, 10.f }, angle }, vel, ASSET::A_BULLET, players[playerID].go.col, true}, 1.f, playerID };
+		return &bulletlist[index];
+	}
 
-		return bulletlist.back();
+	//keys held this frame, sampled by the main thread and applied by the simulation thread
+	enum InputKey : unsigned int
+	{
+		I_UP = 1 << 0,
+		I_DOWN = 1 << 1,
+		I_LEFT = 1 << 2,
+		I_RIGHT = 1 << 3,
+		I_FIRE = 1 << 4
+	};
+	std::atomic<unsigned int> inputKeys{};
+
+	//main thread only, AEInput belongs to the thread that runs the window
+	void SampleInput()
+	{
+		unsigned int keys{};
+		if (AEInputCheckCurr(AEVK_UP)) keys |= I_UP;
+		if (AEInputCheckCurr(AEVK_DOWN)) keys |= I_DOWN;
+		if (AEInputCheckCurr(AEVK_LEFT)) keys |= I_LEFT;
+		if (AEInputCheckCurr(AEVK_RIGHT)) keys |= I_RIGHT;
+		if (AEInputCheckCurr(AEVK_SPACE)) keys |= I_FIRE;
+		inputKeys = keys;
 	}
 
 	//update game data based on player's input
-	void UpdateInput(float dt)
+	void UpdateInput(float dt, unsigned int keys)
 	{
 		Player& player = players[playerNO];
 		int inputDir = 0;
 		int rotateDir = 0;
 		//movement
-		if (AEInputCheckCurr(AEVK_UP))
+		if (keys & I_UP)
 		{
 			inputDir++;
 		}
-		if (AEInputCheckCurr(AEVK_DOWN))
+		if (keys & I_DOWN)
 		{
 			inputDir--;
 		}
-		if (AEInputCheckCurr(AEVK_LEFT))
+		if (keys & I_LEFT)
 		{
 			rotateDir++;
 		}
-		if (AEInputCheckCurr(AEVK_RIGHT))
+		if (keys & I_RIGHT)
 		{
 			rotateDir--;
 		}
 
-		//Update rotation first
-		if (rotateDir) {
-			player.go.t.rot += ROTATE_SPEED * dt * (float)(rotateDir);
-			player.go.t.rot = Wrap(player.go.t.rot, 0.f, 360.f);
-		}
-		//Update acceleration next
-		if (inputDir) {
-			float rad{ AEDegToRad(player.go.t.rot) };
-			AEVec2 dir = { cosf(rad), sinf(rad) };
-			AEVec2 dv;	//change in vel
-			AEVec2Scale(&dv, &dir, ACCELERATION * dt * (float)inputDir);
-			player.go.vel.x += dv.x;
-			player.go.vel.y += dv.y;
-			float mag = AEVec2Length(&player.go.vel);
-			if (mag > MAX_SPEED) {
-				float factor = (MAX_SPEED) / mag;
-				player.go.vel.x *= factor;
-				player.go.vel.y *= factor;
-			}
-		}
+		//Update rotation, then acceleration
+		SHIP::Steer(player.go.t.rot, player.go.vel, rotateDir, inputDir, dt);
 		
 		//shoot logic
-		static float shootCooldown{ 0.5f };
-		if (shootCooldown <= 0.f && AEInputCheckCurr(AEVK_SPACE))
+		static float shootCooldown{ SHIP::FIRE_COOLDOWN };
+		if (shootCooldown <= 0.f && (keys & I_FIRE))
 		{
 			//Send fire event
-			{
-				std::lock_guard<std::mutex> eventMut(_eventMutex);
-				event_queue.push(appTime);
-			}
+			QueueFire(appTime);
 
 			//Shoot(player.go.t.pos, player.go.t.rot);
-			shootCooldown = 0.5f;
+			shootCooldown = SHIP::FIRE_COOLDOWN;
 		}
 		else if (shootCooldown > 0.f) shootCooldown -= dt;
 	}
@@ -220,7 +218,7 @@ namespace
 			countDown = ASTEROID_SPAWN_SPEED;
 			int sl{ RandomInt(rng, UP, RIGHT) };
 			float radius{ RandomFloat(rng, ASTEROID_MIN_SIZE, ASTEROID_MAX_SIZE) };
-			GameObject asteroid{ {{0.f, 0.f},{radius, radius}, RandomFloat(rng, 0.f, 359.f)}, {}, "asteroid", {0.f, 0.f, 0.f, 1.f}, true };
+			GameObject asteroid{ {{0.f, 0.f},{radius, radius}, RandomFloat(rng, 0.f, 359.f)}, {}, ASSET::A_ASTEROID, {0.f, 0.f, 0.f, 1.f}, true };
 			switch (sl)
 			{
 			case UP:
@@ -265,23 +263,21 @@ namespace
 				break;
 			}
 			
-			//find inactive in golist to replace, if no space pushback
-			for (GameObject& go : golist)
+			int index = golist.Acquire();
+			if (index >= 0)
 			{
-				if (!go.isActive && go.texid != "player")
-				{
-					go = asteroid;
-					return;
-				}
+				golist[index] = asteroid;
 			}
-			golist.push_back(asteroid);
 		}
 	}
 
-	GameObject& SpawnAsteroid() {
-		//init the random number engine
-		//static std::random_device rd;
-		static std::mt19937 rng(1);	//seed 1
+	//same seed and order as the server, so spawns match without sending them
+	std::mt19937 asteroidRng(1);	//seed 1
+	int asteroidsSpawned{};
+
+	//next asteroid the server will spawn
+	GameObject NextAsteroid() {
+		std::mt19937& rng = asteroidRng;
 		enum SpawnLocation : int
 		{
 			UP = 0,
@@ -292,7 +288,7 @@ namespace
 
 		int sl{ RandomInt(rng, UP, RIGHT) };
 		float radius{ RandomFloat(rng, ASTEROID_MIN_SIZE, ASTEROID_MAX_SIZE) };
-		GameObject asteroid{ {{0.f, 0.f},{radius, radius}, RandomFloat(rng, 0.f, 359.f)}, {}, "asteroid", {0.f, 0.f, 0.f, 1.f}, true };
+		GameObject asteroid{ {{0.f, 0.f},{radius, radius}, RandomFloat(rng, 0.f, 359.f)}, {}, ASSET::A_ASTEROID, {0.f, 0.f, 0.f, 1.f}, true };
 		switch (sl)
 		{
 		case UP:
@@ -337,17 +333,20 @@ namespace
 		break;
 		}
 
-		//find inactive in golist to replace, if no space pushback
-		for (GameObject& go : golist)
+		return asteroid;
+	}
+
+	//asteroid goes to the server's slot, nullptr if the server had no room for it. the rng moves on either way
+	GameObject* SpawnAsteroid(int index) {
+		GameObject asteroid = NextAsteroid();
+		++asteroidsSpawned;
+
+		if (golist.AcquireAt(index) < 0)
 		{
-			if (!go.isActive && go.texid != "player")
-			{
-				go = asteroid;
-				return go;
-			}
+			return nullptr;
 		}
-		golist.push_back(asteroid);
-		return golist.back();
+		golist[index] = asteroid;
+		return &golist[index];
 	}
 
 	//collision check
@@ -357,7 +356,7 @@ namespace
 		//check if player hit an asteroid
 		for (GameObject& go : golist)
 		{
-			if (!go.isActive || go.texid != "asteroid") { 
+			if (!go.isActive || go.texid != ASSET::A_ASTEROID) { 
 				continue; 
 			}
 			if (COLLISION::IsWithinDistanceCheckDynamic(player.go, go, dt))
@@ -375,7 +374,7 @@ namespace
 			}
 			for (GameObject& go : golist)
 			{
-				if (!go.isActive || go.texid != "asteroid") {
+				if (!go.isActive || go.texid != ASSET::A_ASTEROID) {
 					continue; 
 				}
 				if (COLLISION::IsWithinDistanceCheckDynamic(b.go, go, dt))
@@ -387,6 +386,98 @@ namespace
 			}
 		}
 	}
+
+	//what the renderer needs from one simulation tick, plain data so publishing is a copy
+	struct RenderState
+	{
+		GameObject objects[4 + MAX_ASTEROIDS + MAX_BULLETS];	//players, asteroids then bullets, active only
+		int count;
+		float timeLeft;
+	};
+	TripleBuffer<RenderState> renderBuffer{};
+
+	const float SIM_DT = 1.f / 60.f;	//seconds per simulation tick
+	const int SIM_MAX_BEHIND = 5;		//ticks the simulation may fall behind before it skips ahead
+	std::thread simThread{};
+	std::atomic<bool> simRunning{ false };
+
+	//Copy the world for the renderer, _gameObjectMutex must be held
+	void PublishRenderState() {
+		RenderState& state = renderBuffer.Back();
+		state.count = 0;
+		for (Player const& p : players) {
+			state.objects[state.count++] = p.go;
+		}
+		for (GameObject const& a : golist) {
+			if (a.isActive) state.objects[state.count++] = a;
+		}
+		for (Bullet const& b : bulletlist) {
+			if (b.go.isActive) state.objects[state.count++] = b.go;
+		}
+		state.timeLeft = timeLeft;
+		renderBuffer.Publish();
+	}
+
+	//Advance the match at a fixed step, packets are applied between ticks and never wait on a frame
+	void SimThread() {
+		TRACE::NameThread("sim");
+		std::chrono::steady_clock::time_point next = std::chrono::steady_clock::now();
+		const std::chrono::steady_clock::duration step = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<float>(SIM_DT));
+		while (simRunning && gameRunning) {
+			next += step;
+			std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+			if (now - next > step * SIM_MAX_BEHIND) {	//stalled, do not try to catch up tick by tick
+				next = now;
+			}
+			std::this_thread::sleep_until(next);
+
+			TRACE_SCOPE("sim.tick");
+			CONTENTION::Lock mut{ _gameObjectMutex };
+			appTime += SIM_DT;
+			UpdateInput(SIM_DT, inputKeys);
+			timeLeft -= SIM_DT;
+			for (Player& p : players) {
+				p.go.Update(screen, SIM_DT);
+			}
+			for (auto& a : golist) {
+				a.Update(screen, SIM_DT);
+			}
+			for (int i = 0; i < (int)bulletlist.size(); ++i) {
+				Bullet& b = bulletlist[i];
+				bool wasActive{ b.go.isActive };
+				b.Update(screen, SIM_DT);
+				//expired bullets give their slot back
+				if (wasActive && !b.go.isActive) bulletlist.Release(i);
+			}
+			PublishRenderState();
+			NotifySimTick();
+		}
+	}
+
+	void StartSimulation() {
+		{
+			CONTENTION::Lock mut{ _gameObjectMutex };
+			PublishRenderState();	//the reset world, not the last match
+		}
+		inputKeys = 0;
+		simRunning = true;
+		simThread = std::thread(SimThread);
+	}
+
+	void StopSimulation() {
+		simRunning = false;
+		if (simThread.joinable()) {
+			simThread.join();
+		}
+	}
+
+	//Draw a published tick, no lock is taken
+	void RenderWorld(RenderState const& state) {
+		for (int i = 0; i < state.count; ++i) {
+			batcher.Submit(state.objects[i], texTable[state.objects[i].texid]);
+		}
+		batcher.Flush();
+	}
 }
 
 int APIENTRY wWinMain(_In_ HINSTANCE hInstance,
@@ -400,7 +491,26 @@ int APIENTRY wWinMain(_In_ HINSTANCE hInstance,
 #endif
 
 	UNREFERENCED_PARAMETER(hPrevInstance);
-	UNREFERENCED_PARAMETER(lpCmdLine);
+
+	//--locks counts waits and holds of _gameObjectMutex by call site, the worst are printed on the way out
+	if (wcsstr(lpCmdLine, L"--locks")) {
+		CONTENTION::SetEnabled(true);
+	}
+	//--capture <file> records the connection for PacketTool
+	if (const wchar_t* captureArg = wcsstr(lpCmdLine, L"--capture")) {
+		captureArg += wcslen(L"--capture");
+		while (*captureArg == L' ') ++captureArg;
+		std::string capturePath{};
+		for (; *captureArg && *captureArg != L' '; ++captureArg) {
+			capturePath += (char)*captureArg;
+		}
+		CaptureTo(capturePath);
+	}
+	//--trace writes a timeline of every thread to client_trace.json on the way out
+	if (wcsstr(lpCmdLine, L"--trace")) {
+		TRACE::Start("client");
+		TRACE::NameThread("main");
+	}
 	
 	//f32 appTime{};
 
@@ -425,12 +535,12 @@ int APIENTRY wWinMain(_In_ HINSTANCE hInstance,
 	//initialize game
 	InitMesh();
 	InitTexture();
-	GameObject background{ {{0.f, 0.f}, screen, 0.f}, {}, "", {.0f, .0f, .0f, 1.f}, true };
-	GameObject shade{ {{0.f, 0.f}, screen, 0.f}, {}, "", {.5f, .5f, .5f, .5f}, true };
+	GameObject background{ {{0.f, 0.f}, screen, 0.f}, {}, ASSET::A_NONE, {.0f, .0f, .0f, 1.f}, true };
+	GameObject shade{ {{0.f, 0.f}, screen, 0.f}, {}, ASSET::A_NONE, {.5f, .5f, .5f, .5f}, true };
 
 	//Init players
 	for (int i = 0; i < 4; ++i) {
-		players[i] = { {{{0.f, 0.f},{50.f, 50.f}, 0.f}, {}, "player", {1.f, 0.f, 0.f, 1.f}, true}, 0 };
+		players[i] = { {{{0.f, 0.f},{SHIP::SCALE, SHIP::SCALE}, 0.f}, {}, ASSET::A_PLAYER, {1.f, 0.f, 0.f, 1.f}, true}, 0 };
 		switch (i) //defined in empty namespace
 		{
 		case 0:
@@ -448,117 +558,101 @@ int APIENTRY wWinMain(_In_ HINSTANCE hInstance,
 		}
 	}
 
-	if (!WaitGameStart()) {
-		DisconnectServer();
-		AESysExit();
-		return -1;
-	}
-
-	AESysReset();
-	while (gameRunning)
-	{
-		//quit
-		if (!AESysDoesWindowExist() || AEInputCheckCurr(AEVK_ESCAPE)) {
-			break;
+	//One match per pass, afterwards the server puts us back in its queue
+	bool playAgain{ true };
+	while (playAgain) {
+		if (!WaitGameStart()) {
+			DisconnectServer();
+			AESysExit();
+			return -1;
 		}
-		AESysFrameStart();
-		f32 dt = static_cast<f32>(AEFrameRateControllerGetFrameTime());
-		appTime += dt;
-		
-		//input
-		UpdateInput(dt);
+
+		AESysReset();
+		StartSimulation();
+		while (gameRunning)
 		{
-			std::lock_guard<std::mutex> mut(_gameObjectMutex);
-			//update
-			for (Player& p : players) {
-				p.go.Update(screen, dt);
-			}
-			for (auto& a : golist) {
-				a.Update(screen, dt);
-			}
-			for (auto& b : bulletlist) {
-				b.Update(screen, dt);
+			//quit
+			if (!AESysDoesWindowExist() || AEInputCheckCurr(AEVK_ESCAPE)) {
+				break;
 			}
-		}
+			AESysFrameStart();
+			TRACE_SCOPE("frame");
 
-		//render
-		background.Render(meshList[0]);
+			//input, the simulation thread picks it up on its next tick
+			SampleInput();
 
-		{
-			std::lock_guard<std::mutex> mut(_gameObjectMutex);
-			for (Player& p : players) {
-				p.go.Render(meshList[0], texMap[p.go.texid]);
-			}
-			//player.go.Render(meshList[0], texMap[player.go.texid]);
+			//render the newest tick
+			RenderState const& frame = renderBuffer.Front();
+			background.Render(meshList[0]);
+			RenderWorld(frame);
 
-			for (auto const& a : golist) {
-				a.Render(meshList[0], texMap[a.texid]);
-			}
+			//time left in the match
+			float left = frame.timeLeft;
+			std::string timeText{ std::to_string((int)(left > 0.f ? std::ceil(left) : 0.f)) };
+			AEGfxPrint(dFont, timeText.c_str(), -.05f, .9f, .5f, 1.f, 1.f, 1.f, 1.f);
 
-			for (auto const& b : bulletlist) {
-				b.Render(meshList[0], texMap[b.go.texid]);
-			}
+			AESysFrameEnd();
 		}
 
-		AESysFrameEnd();
-	}
-
-	DisconnectServer();
+		StopSimulation();
+		LeaveGame();
 
 
 
-	//Display highscore
-	while (true) {
-		AESysFrameStart();
-		if (!AESysDoesWindowExist() || AEInputCheckCurr(AEVK_ESCAPE)) {
-			break;
-		}
-		background.Render(meshList[0]);
-		{
-			std::lock_guard<std::mutex> mut(_gameObjectMutex);
-			for (Player& p : players) {
-				p.go.Render(meshList[0], texMap[p.go.texid]);
+		//Display highscore, enter queues for the next match
+		playAgain = false;
+		while (true) {
+			AESysFrameStart();
+			if (!AESysDoesWindowExist() || AEInputCheckCurr(AEVK_ESCAPE)) {
+				break;
 			}
-			//player.go.Render(meshList[0], texMap[player.go.texid]);
-
-			for (auto const& a : golist) {
-				a.Render(meshList[0], texMap[a.texid]);
+			if (AEInputCheckTriggered(AEVK_RETURN)) {
+				playAgain = true;
+				AESysFrameEnd();
+				break;
 			}
+			background.Render(meshList[0]);
+			RenderWorld(renderBuffer.Front());	//the match as it ended
+
+			//print highscores gotten from server
+			shade.Render(meshList[0]);
+			AEGfxPrint(dFont, "Highscores", -.15f, .8f, .5f, 1.f, 1.f, 1.f, 1.f);
+			std::ostringstream description{};
+			description << std::left << std::setw(8) << "Scores" << std::right << std::setw(11) << "Date";
+			AEGfxPrint(dFont, description.str().c_str(), -.3f, 0.7f, .5f, 1.f, 1.f, 1.f, 1.f);
+			int arSize{ sizeof(highscores) / sizeof(highscores[0]) };
+			for (int i{}; i < arSize; ++i)
+			{
+				std::tm localTime{};
+				if (localtime_s(&localTime, (std::time_t*)&highscores[i].second) != 0)
+				{
+					std::cerr << "localtime_s FAILED" << std::endl;
+					return EXIT_FAILURE; //error handling
+				}
 
-			for (auto const& b : bulletlist) {
-				b.Render(meshList[0], texMap[b.go.texid]);
+				std::ostringstream date{};
+				date << std::left << std::setw(9) << highscores[i].first << std::right << std::setw(11) << std::put_time(&localTime, "%Y-%m-%d"); //example: "9990  2025-04-01"
+				AEGfxPrint(dFont, date.str().c_str(), -.3f, .6f - i * 0.15f, .5f, 1.f, 1.f, 1.f, 1.f);
 			}
-		}
 
-		//print highscores gotten from server
-		shade.Render(meshList[0]);
-		AEGfxPrint(dFont, "Highscores", -.15f, .8f, .5f, 1.f, 1.f, 1.f, 1.f);
-		std::ostringstream description{};
-		description << std::left << std::setw(8) << "Scores" << std::right << std::setw(11) << "Date";
-		AEGfxPrint(dFont, description.str().c_str(), -.3f, 0.7f, .5f, 1.f, 1.f, 1.f, 1.f);
-		int arSize{ sizeof(highscores) / sizeof(highscores[0]) };
-		for (int i{}; i < arSize; ++i)
-		{
-			std::tm localTime{};
-			if (localtime_s(&localTime, (std::time_t*)&highscores[i].second) != 0)
+			//print current game players' scores
+			int parSize{ sizeof(players) / sizeof(players[0]) };
+			for (int i{}; i < parSize; ++i)
 			{
-				std::cerr << "localtime_s FAILED" << std::endl;
-				return EXIT_FAILURE; //error handling
+				std::string out{ "Player" + std::to_string(i) + ':' + std::to_string(players[i].score) };
+				AEGfxPrint(dFont, out.c_str(), -.9f + i * 0.5f, -.8f, .5f, 1.f, 1.f, 1.f, 1.f);
 			}
-
-			std::ostringstream date{};
-			date << std::left << std::setw(9) << highscores[i].first << std::right << std::setw(11) << std::put_time(&localTime, "%Y-%m-%d"); //example: "9990  2025-04-01"
-			AEGfxPrint(dFont, date.str().c_str(), -.3f, .6f - i * 0.15f, .5f, 1.f, 1.f, 1.f, 1.f);
+			AEGfxPrint(dFont, "Enter to play again", -.25f, -.9f, .4f, 1.f, 1.f, 1.f, 1.f);
+			AESysFrameEnd();
 		}
+	}
+	DisconnectServer();
 
-		//print current game players' scores
-		int parSize{ sizeof(players) / sizeof(players[0]) };
-		for (int i{}; i < parSize; ++i)
-		{
-			std::string out{ "Player" + std::to_string(i) + ':' + std::to_string(players[i].score) };
-			AEGfxPrint(dFont, out.c_str(), -.9f + i * 0.5f, -.8f, .5f, 1.f, 1.f, 1.f, 1.f);
-		}
-		AESysFrameEnd();
+	if (TRACE::Enabled() && !TRACE::Write("client_trace.json")) {
+		std::cerr << "cannot write client_trace.json" << std::endl;
+	}
+	if (CONTENTION::Enabled()) {
+		std::cout << CONTENTION::Report();
 	}
 
 	Free();
@@ -576,12 +670,12 @@ void InterpolateGameobject(GameObject& go, float timestamp) {
 }
 
 //Sync bullet drawing
-void InterpolatedShoot(int playerID, float timestamp) {
-	Bullet& bullet = Shoot(players[playerID].go.t.pos, players[playerID].go.t.rot, playerID);
-	if (playerID != playerNO) {	//DONT interpolate if same id
+void InterpolatedShoot(int playerID, float timestamp, int index) {
+	Bullet* bullet = Shoot(players[playerID].go.t.pos, players[playerID].go.t.rot, playerID, index);
+	if (bullet && playerID != playerNO) {	//DONT interpolate if same id
 		float deltaTime = appTime - timestamp;
-		bullet.go.t.pos.x += bullet.go.vel.x * deltaTime;
-		bullet.go.t.pos.y += bullet.go.vel.y * deltaTime;
+		bullet->go.t.pos.x += bullet->go.vel.x * deltaTime;
+		bullet->go.t.pos.y += bullet->go.vel.y * deltaTime;
 
 	}
 }
@@ -607,12 +701,43 @@ void InterpolateGOsync(float timestamp) {
 	}
 }
 
-void SpawnInterpolatedAsteroid(float timestamp) {
+void SpawnInterpolatedAsteroid(float timestamp, int index) {
 	//std::lock_guard<std::mutex> goLock{ _gameObjectMutex };
 	//Got mutex from stack
 
-	GameObject& asteroid = SpawnAsteroid();
+	GameObject* asteroid = SpawnAsteroid(index);
+	if (!asteroid) {
+		return;
+	}
 	float deltaTime = appTime - timestamp;
-	asteroid.t.pos.x += asteroid.vel.x * deltaTime;
-	asteroid.t.pos.y += asteroid.vel.y * deltaTime;
-}
\ No newline at end of file
+	asteroid->t.pos.x += asteroid->vel.x * deltaTime;
+	asteroid->t.pos.y += asteroid->vel.y * deltaTime;
+}
+
+//Catch the spawner up to the server after joining late, golist itself comes with the full state
+void SyncAsteroidSpawns(int spawned) {
+	//Got mutex from stack
+	if (asteroidsSpawned > spawned) {	//Should not happen, start over
+		asteroidRng.seed(1);
+		asteroidsSpawned = 0;
+	}
+	for (; asteroidsSpawned < spawned; ++asteroidsSpawned) {
+		NextAsteroid();
+	}
+}
+
+//Clear the last match before a new one starts, player colors are kept
+void ResetMatch() {
+	//Got mutex from stack
+	golist.Clear();
+	bulletlist.Clear();
+	SyncAsteroidSpawns(0);
+	for (Player& p : players) {
+		p.go.t.pos = {};
+		p.go.t.rot = 0.f;
+		p.go.vel = {};
+		p.score = 0;
+	}
+	appTime = 0.f;
+	timeLeft = 60.f;
+}
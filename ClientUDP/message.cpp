@@ -0,0 +1,79 @@
+/*!
+\file		message.cpp
+\author		darius (d.chan@digipen.edu)
+\co-author
+\par		Assignment 4
+\date		19/10/2026
+\brief
+the object layout shared by the state messages.
+
+Copyright (C) 2025 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the
+prior written consent of DigiPen Institute of Technology is prohibited.
+*/
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+
+#include "Windows.h"
+#include "winsock2.h"	// htonf, ntohf
+
+#include "message.h"
+#include "protocol.h"
+
+namespace MESSAGE
+{
+	void AppendFloat(std::string& message, float value)
+	{
+		unsigned int tmp = htonf(value);
+		message.append((char*)(&tmp), (char*)(&tmp) + 4);
+	}
+
+	float ReadFloat(const char* buffer)
+	{
+		return ntohf(*(uint32_t*)(buffer));
+	}
+
+	void AppendBody(std::string& message, GameObject const& go)
+	{
+		AppendFloat(message, go.t.pos.x);
+		AppendFloat(message, go.t.pos.y);
+		AppendFloat(message, go.t.scale.x);
+		AppendFloat(message, go.t.scale.y);
+		AppendFloat(message, go.t.rot);
+		AppendFloat(message, go.vel.x);
+		AppendFloat(message, go.vel.y);
+	}
+
+	void ReadBody(const char* buffer, Transform& t, AEVec2& vel)
+	{
+		t.pos.x = ReadFloat(buffer);
+		t.pos.y = ReadFloat(buffer + 4);
+		t.scale.x = ReadFloat(buffer + 8);
+		t.scale.y = ReadFloat(buffer + 12);
+		t.rot = ReadFloat(buffer + 16);
+		vel.x = ReadFloat(buffer + 20);
+		vel.y = ReadFloat(buffer + 24);
+	}
+
+	std::string StateUpdate(float timestamp, GameObject const& go, float echo, INPUTFRAME::History const& inputs)
+	{
+		std::string message{};
+		message.push_back(C_STATE_UPDATE);
+		AppendFloat(message, timestamp);
+		AppendBody(message, go);
+		AppendFloat(message, echo);
+
+		//recent inputs ride along, so a lost C_REQ_FIRE still reaches the server
+		inputs.Append(message, timestamp);
+		return message;
+	}
+
+	std::string ReqFire(float timestamp, INPUTFRAME::History const& inputs)
+	{
+		std::string message{};
+		message.push_back(C_REQ_FIRE);
+		inputs.Append(message, timestamp);
+		return message;
+	}
+}
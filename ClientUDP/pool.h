@@ -0,0 +1,189 @@
+/*!
+\file		pool.h
+\author		darius (d.chan@digipen.edu)
+\co-author
+\par		Assignment 4
+\date		19/10/2026
+\brief
+fixed capacity object pool. all items are created up front and never
+move, so indices and references stay valid for the whole match and
+nothing is allocated while it runs. free slots are kept in a doubly
+linked list threaded through the slots, giving O(1) acquire and release,
+and a slot can also be taken by index when the server dictates it.
+
+Copyright (C) 2025 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the
+prior written consent of DigiPen Institute of Technology is prohibited.
+*/
+#pragma once
+#include <vector>
+
+//what Acquire does when every slot is in use
+enum OverflowPolicy
+{
+	P_REJECT,			//nothing is acquired
+	P_RECYCLE_OLDEST	//the item acquired the longest ago is reused
+};
+
+struct PoolStats
+{
+	int capacity;
+	int inUse;		//slots taken and not yet given back
+	int peak;		//most slots taken at once
+	int overflows;	//Acquire calls that found the pool full
+};
+
+//T needs an IsActive(T const&) overload. items deactivated without Release are
+//picked up again the next time the free list runs dry
+template <typename T>
+class Pool
+{
+public:
+	Pool(int capacity, T const& blank, OverflowPolicy policy)
+		: _items((size_t)capacity, blank), _blank{ blank }, _next((size_t)capacity), _prev((size_t)capacity),
+		_free((size_t)capacity), _born((size_t)capacity), _generation((size_t)capacity), _head{ -1 }, _clock{ 0 }, _policy{ policy }, _stats{ capacity, 0, 0, 0 }
+	{
+		Clear();
+	}
+
+	//every item back to blank, every slot free, the generations and the stats started over
+	void Clear()
+	{
+		_head = -1;
+		for (int i = (int)_items.size() - 1; i >= 0; --i)
+		{
+			_items[i] = _blank;
+			_generation[i] = 0;
+			Push(i);
+		}
+		_stats = { (int)_items.size(), 0, 0, 0 };
+	}
+
+	//index of a free slot, or -1 when full and the policy rejects. the item keeps its old contents
+	int Acquire()
+	{
+		if (_head < 0)
+		{
+			Reclaim();
+		}
+		if (_head >= 0)
+		{
+			int index = _head;
+			Unlink(index);
+			Take(index);
+			return index;
+		}
+
+		++_stats.overflows;
+		if (_policy == P_REJECT || _items.empty())
+		{
+			return -1;
+		}
+		int oldest{ 0 };
+		for (int i = 1; i < (int)_items.size(); ++i)
+		{
+			if (_born[i] < _born[oldest]) oldest = i;
+		}
+		_born[oldest] = ++_clock;
+		++_generation[oldest];
+		return oldest;
+	}
+
+	//takes the slot at index whether it is free or not, -1 if index is out of range
+	int AcquireAt(int index)
+	{
+		if (index < 0 || index >= (int)_items.size())
+		{
+			return -1;
+		}
+		if (_free[index])
+		{
+			Unlink(index);
+			Take(index);
+		}
+		else
+		{
+			_born[index] = ++_clock;
+			++_generation[index];
+		}
+		return index;
+	}
+
+	//gives a slot back, the caller has already deactivated the item
+	void Release(int index)
+	{
+		if (index < 0 || index >= (int)_items.size() || _free[index])
+		{
+			return;
+		}
+		Push(index);
+		--_stats.inUse;
+	}
+
+	T& operator[](int index) { return _items[index]; }
+	T const& operator[](int index) const { return _items[index]; }
+	size_t size() const { return _items.size(); }
+	typename std::vector<T>::iterator begin() { return _items.begin(); }
+	typename std::vector<T>::iterator end() { return _items.end(); }
+	typename std::vector<T>::const_iterator begin() const { return _items.begin(); }
+	typename std::vector<T>::const_iterator end() const { return _items.end(); }
+
+	//every slot, active or not, for code that walks the whole list
+	std::vector<T> const& Items() const { return _items; }
+
+	PoolStats const& Stats() const { return _stats; }
+
+	//bumped every time the slot is acquired, tells a reused slot apart from the item it held before
+	unsigned int Generation(int index) const { return _generation[index]; }
+
+private:
+	void Push(int index)
+	{
+		_free[index] = 1;
+		_prev[index] = -1;
+		_next[index] = _head;
+		if (_head >= 0) _prev[_head] = index;
+		_head = index;
+	}
+
+	void Unlink(int index)
+	{
+		if (_prev[index] >= 0) _next[_prev[index]] = _next[index];
+		else _head = _next[index];
+		if (_next[index] >= 0) _prev[_next[index]] = _prev[index];
+		_free[index] = 0;
+	}
+
+	void Take(int index)
+	{
+		_born[index] = ++_clock;
+		++_generation[index];
+		++_stats.inUse;
+		if (_stats.inUse > _stats.peak) _stats.peak = _stats.inUse;
+	}
+
+	//slots deactivated in place go back on the free list
+	void Reclaim()
+	{
+		for (int i = (int)_items.size() - 1; i >= 0; --i)
+		{
+			if (!_free[i] && !IsActive(_items[i]))
+			{
+				Push(i);
+				--_stats.inUse;
+			}
+		}
+	}
+
+	std::vector<T> _items;
+	T _blank;
+	std::vector<int> _next;
+	std::vector<int> _prev;
+	std::vector<char> _free;				//slot is on the free list
+	std::vector<unsigned long long> _born;	//when the slot was last acquired, for P_RECYCLE_OLDEST
+	std::vector<unsigned int> _generation;	//times the slot was acquired since the last Clear
+	int _head;
+	unsigned long long _clock;
+	OverflowPolicy _policy;
+	PoolStats _stats;
+};
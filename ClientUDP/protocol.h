@@ -0,0 +1,132 @@
+/*!
+\file		protocol.h
+\author		Elton Leosantosa (leosantosa.e@digipen.edu)
+\co-author	darius (d.chan@digipen.edu)
+\par		Assignment 4
+\date		19/10/2026
+\brief
+	Command ids and packet layouts shared by the server and the client
+
+Copyright (C) 2025 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the
+prior written consent of DigiPen Institute of Technology is prohibited.
+*/
+
+#ifndef PROTOCOL_H
+#define	PROTOCOL_H
+
+enum CommandID : unsigned char {
+    C_ERROR = 0,
+    C_STATE_UPDATE = 1,	//Regular client update
+    C_ALL_UPDATE = 2,	//Regular server update
+    C_REQ_FIRE = 3,		//Sends fire req to server
+    C_RSP_FIRE = 4,		//Send fire rsp from server to client
+    C_ASTEROID_SPAWN = 5,		//Send asteroid destroyed from server to client
+    C_ASTEROID_DESTROY = 6,
+    C_REQ_CONNECT = 7,	//Send to server to req connection
+    C_RSP_CONNECT = 8,	//Send to client which player client is, or not connected
+    C_GAME_START = 9,
+    C_GAME_END = 10,
+    C_TIME_SYNC = 11,	//highest authority, syncing time and position and vel values for all
+    C_ENTITY_UPDATE = 12,	//Highest priority asteroids and bullets for this client
+    C_FRAGMENT = 13,	//Piece of a message that is larger than the mtu
+    C_BATCH = 14,		//Several messages for the same peer in one datagram
+    C_CHALLENGE = 15,	//Cookie the client has to echo before it is given a slot
+    C_KEEPALIVE = 16,	//Keeps a connection alive while nothing else is sent
+    C_DISCONNECT = 17,	//Client is leaving, its slot is freed right away
+    C_FULL_STATE = 18	//Whole match for a client that joined late or reconnected
+};
+
+const int MAX_DATAGRAM_SIZE = 1500;	//recv buffer size, nothing larger is ever sent
+const int MAX_ASTEROIDS = 64;		//golist capacity on both ends, asteroid indices are always below this
+const int MAX_BULLETS = 32;			//bulletlist capacity on both ends
+const int STATE_UPDATE_INPUTS = 1 + 4 + 8 + 8 + 4 + 8 + 4;	//where the input frames start in a C_STATE_UPDATE
+
+//Structure for a packet to be sent to the server
+//	C_ERROR
+//	-ignored
+//C_STATE_UPDATE
+//	id - 1b, timestamp - 4b, pos - 8b, scale - 8b, rot - 4b, vel - 8b, echo - 4b, input frames
+//C_ALL_UPDATE
+//	id - 1b, timestamp - 4b, (pos - 8b, scale - 8b, rot - 4b, vel - 8b) * 4, echo - 4b
+//  echo is the other side's latest timestamp plus how long it was held, for measuring rtt
+//C_REQ_FIRE
+//	id - 1b, input frames
+//  input frames are count - 1b, (seq - 4b, timestamp - 4b, flags - 1b) * count, the client's newest
+//  inputs oldest first. every one is repeated in the next few packets, the server applies each seq once
+//C_RSP_FIRE
+//	id - 1b, timestamp - 4b, playerid - 4b, bullet index - 2b
+//C_ASTEROID_SPAWN
+//	id - 1b, timestamp - 4b, index - 2b
+//  index is the golist slot the server used, clients put the asteroid in the same one
+//C_ASTEROID_DESTROY
+//  id - 1b, index - 4b
+//C_REQ_CONNECT
+//	id - 1b, cookie - 4b, session - 4b
+//  cookie is 0 until the server answers with a C_CHALLENGE, session is 0 unless reconnecting
+//  never smaller than C_CHALLENGE so a spoofed request cannot be amplified
+//C_RSP_CONNECT
+//	id - 1b, playerid - 4b, session - 4b
+//  playerid is -1 when the server is full, session lets the client reconnect into the same slot
+//C_GAME_START
+//	id - 1b
+//C_GAME_END
+//	id - 1b, (highscore - 4b, date - 8b) * 5, playerscore - 4b * 4
+//C_TIME_SYNC
+//	id - 1b, timestamp - 4b, (pos - 8b, scale - 8b, rot - 4b, vel - 8b) * 4
+//C_ENTITY_UPDATE
+//	id - 1b, timestamp - 4b, count - 2b, (type - 1b, index - 2b, active - 1b, pos - 8b, rot - 4b, vel - 8b, extra - 4b) * count
+//  type 0 is an asteroid in golist, extra is its radius. type 1 is a bullet, extra is its remaining lifetime
+//C_FRAGMENT
+//	id - 1b, message id - 2b, index - 1b, count - 1b, fragment size - 2b, payload - fragment size (last may be shorter)
+//  the payloads of all fragments in index order make up the original message, starting with its own id
+//C_BATCH
+//	id - 1b, (length - 2b, message - length) * n
+//  every message keeps its own id, a batch is never put inside another batch
+//C_CHALLENGE
+//	id - 1b, cookie - 4b
+//C_KEEPALIVE
+//	id - 1b
+//C_DISCONNECT
+//	id - 1b
+//C_FULL_STATE
+//	id - 1b, timestamp - 4b, time left - 4b, asteroids spawned - 4b,
+//	player count - 1b, (pos - 4b, scale - 4b, rot - 2b, vel - 4b, score - 4b) * player count,
+//	golist size - 2b, asteroid count - 2b, (index - 2b, pos - 4b, radius - 2b, rot - 2b, vel - 4b) * asteroid count,
+//	bulletlist size - 2b, bullet count - 2b, (index - 2b, owner - 1b, pos - 4b, rot - 2b, vel - 4b, lifetime - 2b) * bullet count
+//  vectors are signed 16 bit fixed point, angles are 1/65536 of a turn, only active entities are listed
+
+//smallest valid size of each packet, anything shorter is dropped before it is parsed
+inline int MinimumSize(unsigned char id) {
+    switch (id) {
+    case C_STATE_UPDATE:     return 1 + 4 + 8 + 8 + 4 + 8;
+    case C_ALL_UPDATE:       return 1 + 4 + (8 + 8 + 4 + 8) * 4;
+    case C_REQ_FIRE:         return 1 + 1;
+    case C_RSP_FIRE:         return 1 + 4 + 4 + 2;
+    case C_ASTEROID_SPAWN:   return 1 + 4 + 2;
+    case C_ASTEROID_DESTROY: return 1 + 4;
+    case C_REQ_CONNECT:      return 1 + 4 + 4;
+    case C_RSP_CONNECT:      return 1 + 4 + 4;
+    case C_GAME_END:         return 1 + (4 + 8) * 5 + 4 * 4;
+    case C_TIME_SYNC:        return 1 + 4 + (8 + 8 + 4 + 8) * 4;
+    case C_ENTITY_UPDATE:    return 1 + 4 + 2;
+    case C_FRAGMENT:         return 1 + 2 + 1 + 1 + 2 + 1;
+    case C_BATCH:            return 1 + 2 + 1;
+    case C_CHALLENGE:        return 1 + 4;
+    case C_FULL_STATE:       return 1 + 4 + 4 + 4 + 1 + 2 + 2 + 2 + 2;
+    default:                 return 1;
+    }
+}
+
+//name of a CommandID as it is spelled above, "unknown" for anything else
+inline const char* CommandName(unsigned char id) {
+    static const char* const names[] = {
+        "C_ERROR", "C_STATE_UPDATE", "C_ALL_UPDATE", "C_REQ_FIRE", "C_RSP_FIRE", "C_ASTEROID_SPAWN",
+        "C_ASTEROID_DESTROY", "C_REQ_CONNECT", "C_RSP_CONNECT", "C_GAME_START", "C_GAME_END", "C_TIME_SYNC",
+        "C_ENTITY_UPDATE", "C_FRAGMENT", "C_BATCH", "C_CHALLENGE", "C_KEEPALIVE", "C_DISCONNECT", "C_FULL_STATE"
+    };
+    static_assert(sizeof(names) / sizeof(names[0]) == C_FULL_STATE + 1, "a CommandID has no name");
+    return id <= C_FULL_STATE ? names[id] : "unknown";
+}
+
+#endif
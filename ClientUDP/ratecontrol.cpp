@@ -0,0 +1,86 @@
+/*!
+\file		ratecontrol.cpp
+\author		darius (d.chan@digipen.edu)
+\co-author
+\par		Assignment 4
+\date		19/10/2026
+\brief
+per-peer send rate controller. estimates the bandwidth used towards a peer
+and adapts how often snapshots are sent with a delay-based AIMD.
+
+Copyright (C) 2025 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the
+prior written consent of DigiPen Institute of Technology is prohibited.
+*/
+#include "ratecontrol.h"
+#include <algorithm>
+
+namespace
+{
+	const float QUEUE_DELAY_LIMIT = 0.03f;	//rtt above the baseline that counts as congestion
+	const float RATE_STEP = 0.5f;			//sends per second added for every good rtt sample
+	const float RATE_BACKOFF = 0.7f;		//rate multiplier on congestion
+	const float RTT_SMOOTHING = 0.125f;
+	const float MIN_RTT_WINDOW = 10.f;		//seconds before the baseline is measured again
+}
+
+RateController::RateController(float minInterval, float maxInterval, float startInterval) :
+	_minRate{ 1.f / maxInterval },
+	_maxRate{ 1.f / minInterval },
+	_rate{ 1.f / startInterval },
+	_srtt{ -1.f },
+	_minRtt{ -1.f },
+	_minRttStart{},
+	_lastDecrease{}
+{
+}
+
+void RateController::OnRttSample(float rtt, float now)
+{
+	if (rtt < 0.f) return;	//echo from before a time sync
+
+	if (_srtt < 0.f) _srtt = rtt;
+	else _srtt += (rtt - _srtt) * RTT_SMOOTHING;
+
+	//baseline is the lowest rtt seen in the window, restarted so route changes are picked up
+	if (_minRtt < 0.f || rtt < _minRtt || now - _minRttStart > MIN_RTT_WINDOW)
+	{
+		_minRtt = rtt;
+		_minRttStart = now;
+	}
+
+	if (_srtt - _minRtt > QUEUE_DELAY_LIMIT)
+		Decrease(now);
+	else
+		_rate = std::min(_rate + RATE_STEP, _maxRate);
+}
+
+void RateController::OnSendFailed(float now)
+{
+	Decrease(now);
+}
+
+void RateController::Decrease(float now)
+{
+	//only back off once per round trip, the samples after a cut still carry the old queue
+	float holdOff = _srtt > 0.f ? _srtt : 1.f / _rate;
+	if (now - _lastDecrease < holdOff) return;
+
+	_rate = std::max(_rate * RATE_BACKOFF, _minRate);
+	_lastDecrease = now;
+}
+
+float RateController::Interval() const
+{
+	return 1.f / _rate;
+}
+
+float RateController::Rtt() const
+{
+	return _srtt;
+}
+
+float RateController::MinRtt() const
+{
+	return _minRtt;
+}
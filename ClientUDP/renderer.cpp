@@ -0,0 +1,163 @@
+/*!
+\file		renderer.cpp
+\author		darius (d.chan@digipen.edu)
+\co-author
+\par		Assignment 4
+\date		19/10/2026
+\brief
+batched drawing of gameobjects.
+
+Copyright (C) 2025 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the
+prior written consent of DigiPen Institute of Technology is prohibited.
+*/
+#include "renderer.h"
+#include <cmath>
+#include <xmmintrin.h>
+
+namespace
+{
+	//corners of the unit quad in the order the rect mesh used them, with its uvs
+	const float CORNER_U[4]{ 0.f, 1.f, 1.f, 0.f };
+	const float CORNER_V[4]{ 1.f, 1.f, 0.f, 0.f };
+
+	unsigned int ToARGB(Color const& col)
+	{
+		auto channel = [](float c) { return (unsigned int)(std::fmin(std::fmax(c, 0.f), 1.f) * 255.f + 0.5f); };
+		return channel(col.a) << 24 | channel(col.r) << 16 | channel(col.g) << 8 | channel(col.b);
+	}
+
+	bool SameColor(Color const& a, Color const& b)
+	{
+		return a.r == b.r && a.g == b.g && a.b == b.b && a.a == b.a;
+	}
+}
+
+namespace RENDER
+{
+	void Batcher::Submit(GameObject const& go, AEGfxTexture* texPtr)
+	{
+		if (!go.isActive) return;
+		_items.push_back({ go.t, go.col, FindBatch(texPtr, go.col) });
+	}
+
+	int Batcher::FindBatch(AEGfxTexture* texPtr, Color const& col)
+	{
+		//untextured objects carry their colour in the vertices, so they all share one key per texture
+		Color add = texPtr ? col : Color{ 0.f, 0.f, 0.f, 0.f };
+		//only a handful of keys exist in a frame, a linear search beats hashing
+		for (int i = 0; i < (int)_keys.size(); ++i)
+		{
+			if (_keys[i].tex == texPtr && SameColor(_keys[i].add, add)) return i;
+		}
+		_keys.push_back({ texPtr, add });
+		return (int)_keys.size() - 1;
+	}
+
+	void Batcher::Flush()
+	{
+		int batches = (int)_keys.size();
+
+		//counting sort by batch, stable so objects keep their submit order within a batch
+		_counts.assign(batches + 1, 0);
+		for (Item const& item : _items) ++_counts[item.batch + 1];
+		for (int i = 0; i < batches; ++i) _counts[i + 1] += _counts[i];
+		_order.resize(_items.size());
+		for (int i = 0; i < (int)_items.size(); ++i) _order[_counts[_items[i].batch]++] = i;
+		//_counts[b] is now where batch b + 1 starts
+		int first{ 0 };
+		for (int b = 0; b < batches; ++b)
+		{
+			DrawBatch(_keys[b], first, _counts[b] - first);
+			first = _counts[b];
+		}
+
+		_lastBatches = batches;
+		_items.clear();
+		_keys.clear();
+	}
+
+	void Batcher::DrawBatch(Key const& key, int first, int count)
+	{
+		if (count <= 0) return;
+
+		//gather, padded to a multiple of four for the SSE loop
+		int padded = (count + 3) & ~3;
+		for (std::vector<float>* v : { &_px, &_py, &_ax, &_ay, &_bx, &_by }) v->assign(padded, 0.f);
+		for (int c = 0; c < 4; ++c)
+		{
+			_cornerX[c].resize(padded);
+			_cornerY[c].resize(padded);
+		}
+		for (int i = 0; i < count; ++i)
+		{
+			Transform const& t = _items[_order[first + i]].t;
+			float rad = AEDegToRad(t.rot);
+			float c = cosf(rad), s = sinf(rad);
+			_px[i] = t.pos.x;
+			_py[i] = t.pos.y;
+			//half extents along the rotated x and y axes
+			_ax[i] = 0.5f * t.scale.x * c;
+			_ay[i] = 0.5f * t.scale.x * s;
+			_bx[i] = -0.5f * t.scale.y * s;
+			_by[i] = 0.5f * t.scale.y * c;
+		}
+
+		//corner = pos +- a +- b, in the order (-,-) (+,-) (+,+) (-,+)
+		for (int i = 0; i < padded; i += 4)
+		{
+			__m128 px = _mm_loadu_ps(&_px[i]), py = _mm_loadu_ps(&_py[i]);
+			__m128 ax = _mm_loadu_ps(&_ax[i]), ay = _mm_loadu_ps(&_ay[i]);
+			__m128 bx = _mm_loadu_ps(&_bx[i]), by = _mm_loadu_ps(&_by[i]);
+
+			__m128 lowX = _mm_sub_ps(px, ax), lowY = _mm_sub_ps(py, ay);
+			__m128 highX = _mm_add_ps(px, ax), highY = _mm_add_ps(py, ay);
+
+			_mm_storeu_ps(&_cornerX[0][i], _mm_sub_ps(lowX, bx));
+			_mm_storeu_ps(&_cornerY[0][i], _mm_sub_ps(lowY, by));
+			_mm_storeu_ps(&_cornerX[1][i], _mm_sub_ps(highX, bx));
+			_mm_storeu_ps(&_cornerY[1][i], _mm_sub_ps(highY, by));
+			_mm_storeu_ps(&_cornerX[2][i], _mm_add_ps(highX, bx));
+			_mm_storeu_ps(&_cornerY[2][i], _mm_add_ps(highY, by));
+			_mm_storeu_ps(&_cornerX[3][i], _mm_add_ps(lowX, bx));
+			_mm_storeu_ps(&_cornerY[3][i], _mm_add_ps(lowY, by));
+		}
+
+		//one mesh for the whole batch, already in world space
+		AEGfxMeshStart();
+		for (int i = 0; i < count; ++i)
+		{
+			unsigned int vc = key.tex ? 0xFFFFFFFF : ToARGB(_items[_order[first + i]].col);
+			AEGfxTriAdd(
+				_cornerX[0][i], _cornerY[0][i], vc, CORNER_U[0], CORNER_V[0],
+				_cornerX[1][i], _cornerY[1][i], vc, CORNER_U[1], CORNER_V[1],
+				_cornerX[3][i], _cornerY[3][i], vc, CORNER_U[3], CORNER_V[3]);
+			AEGfxTriAdd(
+				_cornerX[1][i], _cornerY[1][i], vc, CORNER_U[1], CORNER_V[1],
+				_cornerX[2][i], _cornerY[2][i], vc, CORNER_U[2], CORNER_V[2],
+				_cornerX[3][i], _cornerY[3][i], vc, CORNER_U[3], CORNER_V[3]);
+		}
+		AEGfxVertexList* mesh = AEGfxMeshEnd();
+
+		//same state GameObject::Render sets, once per batch
+		AEGfxSetRenderMode(key.tex ? AEGfxRenderMode::AE_GFX_RM_TEXTURE : AEGfxRenderMode::AE_GFX_RM_COLOR);
+		AEGfxTextureSet(key.tex, 0, 0);
+		AEGfxSetBlendMode(AE_GFX_BM_BLEND);
+		if (key.tex)
+		{
+			AEGfxSetBlendColor(0.f, 0.f, 0.f, 0.f);
+		}
+		else
+		{
+			AEGfxSetBlendColor(1.f, 1.f, 1.f, 1.f);
+		}
+		AEGfxSetColorToMultiply(1.f, 1.f, 1.f, 1.f);
+		AEGfxSetColorToAdd(key.add.r, key.add.g, key.add.b, key.add.a);
+		AEGfxSetTransparency(1.f);
+		AEMtx33 identity{};
+		AEMtx33Identity(&identity);
+		AEGfxSetTransform(identity.m);
+		AEGfxMeshDraw(mesh, AEGfxMeshDrawMode::AE_GFX_MDM_TRIANGLES);
+		AEGfxMeshFree(mesh);
+	}
+}
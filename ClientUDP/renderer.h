@@ -0,0 +1,63 @@
+/*!
+\file		renderer.h
+\author		darius (d.chan@digipen.edu)
+\co-author
+\par		Assignment 4
+\date		19/10/2026
+\brief
+batched drawing of gameobjects. objects are collected during the frame,
+grouped by texture and colour state in the order they were first seen so
+layering is kept, their quads are transformed to world space four at a
+time with SSE, and each group is drawn as one mesh with one set of state
+changes.
+
+Copyright (C) 2025 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the
+prior written consent of DigiPen Institute of Technology is prohibited.
+*/
+#pragma once
+#include "gameobject.h"
+#include <vector>
+
+namespace RENDER
+{
+	class Batcher
+	{
+	public:
+		//queues an object for this frame, inactive ones are skipped. only copies, so it is cheap under a lock
+		void Submit(GameObject const& go, AEGfxTexture* texPtr = nullptr);
+
+		//draws and forgets everything queued since the last flush
+		void Flush();
+
+		//groups drawn by the last flush
+		int Batches() const { return _lastBatches; }
+
+	private:
+		struct Item
+		{
+			Transform t;
+			Color col;
+			int batch;
+		};
+
+		//what has to be the same for objects to share a draw
+		struct Key
+		{
+			AEGfxTexture* tex;
+			Color add;	//textured objects are tinted through the add colour, which is per draw
+		};
+
+		int FindBatch(AEGfxTexture* texPtr, Color const& col);
+		void DrawBatch(Key const& key, int first, int count);
+
+		std::vector<Item> _items{};
+		std::vector<Key> _keys{};
+		std::vector<int> _order{};		//item indices grouped by batch
+		std::vector<int> _counts{};		//items per batch
+		//quad corners, structure of arrays so four objects transform at once
+		std::vector<float> _px{}, _py{}, _ax{}, _ay{}, _bx{}, _by{};
+		std::vector<float> _cornerX[4]{}, _cornerY[4]{};
+		int _lastBatches{};
+	};
+}
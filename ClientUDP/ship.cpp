@@ -0,0 +1,44 @@
+/*!
+\file		ship.cpp
+\author		darius (d.chan@digipen.edu)
+\co-author
+\par		Assignment 4
+\date		19/10/2026
+\brief
+turning and thrusting of a player's ship.
+
+Copyright (C) 2025 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the
+prior written consent of DigiPen Institute of Technology is prohibited.
+*/
+#include "ship.h"
+#include "Math.h"
+
+namespace SHIP
+{
+	void Steer(float& rot, AEVec2& vel, int turn, int thrust, float dt)
+	{
+		//rotation first, then acceleration along the new heading
+		if (turn)
+		{
+			rot += ROTATE_SPEED * dt * (float)turn;
+			rot = Wrap(rot, 0.f, 360.f);
+		}
+		if (thrust)
+		{
+			float rad{ AEDegToRad(rot) };
+			AEVec2 dir = { cosf(rad), sinf(rad) };
+			AEVec2 dv;	//change in vel
+			AEVec2Scale(&dv, &dir, ACCELERATION * dt * (float)thrust);
+			vel.x += dv.x;
+			vel.y += dv.y;
+			float mag = AEVec2Length(&vel);
+			if (mag > MAX_SPEED)
+			{
+				float factor = MAX_SPEED / mag;
+				vel.x *= factor;
+				vel.y *= factor;
+			}
+		}
+	}
+}
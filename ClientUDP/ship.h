@@ -0,0 +1,31 @@
+/*!
+\file		ship.h
+\author		darius (d.chan@digipen.edu)
+\co-author
+\par		Assignment 4
+\date		19/10/2026
+\brief
+how a player's ship handles. the client flies its own ship with this and
+the load bots fly theirs with the same numbers, so the server sees the
+same movement from both.
+
+Copyright (C) 2025 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the
+prior written consent of DigiPen Institute of Technology is prohibited.
+*/
+#pragma once
+#include "AEEngine.h"
+
+namespace SHIP
+{
+	const AEVec2 SCREEN{ 1600.f, 900.f };	//application window width & height, the ship wraps at its edges
+	const float ACCELERATION = 100.f;		//player acceleration - increase by 10 per second
+	const float MAX_SPEED = 200.f;			//player max speed
+	const float ROTATE_SPEED = 100.f;		//player rotate
+	const float FIRE_COOLDOWN = 0.5f;		//seconds between two shots
+	const float SCALE = 50.f;
+
+	//turns, then thrusts along the new heading for dt. turn and thrust are -1, 0 or 1.
+	//the speed is capped at MAX_SPEED, moving is left to GameObject::Update
+	void Steer(float& rot, AEVec2& vel, int turn, int thrust, float dt);
+}
@@ -0,0 +1,61 @@
+/*!
+\file		snapshot.h
+\author		darius (d.chan@digipen.edu)
+\co-author
+\par		Assignment 4
+\date		19/10/2026
+\brief
+full state of a running match in one C_FULL_STATE message, sent to a
+client that joins late or reconnects so it can carry on with the normal
+updates. positions, velocities and angles are quantized to 16 bits and
+only active asteroids and bullets are sent.
+
+Copyright (C) 2025 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the
+prior written consent of DigiPen Institute of Technology is prohibited.
+*/
+#pragma once
+#include "gameobject.h"
+#include <string>
+#include <vector>
+
+namespace SNAPSHOT
+{
+	const float POSITION_SCALE = 16.f;	//steps per unit, +-2048 covers the screen and the spawn margin
+	const float VELOCITY_SCALE = 16.f;	//steps per unit per second, bullets are the fastest at 1000
+	const float SIZE_SCALE = 16.f;		//steps per unit of scale
+	const float LIFETIME_SCALE = 1000.f;	//bullet lifetime in ms
+
+	//bytes of each record, the message is a header then the players, the asteroids and the bullets
+	const int PLAYER_SIZE = 4 + 4 + 2 + 4 + 4;		//pos, scale, rot, vel, score
+	const int ASTEROID_SIZE = 2 + 4 + 2 + 2 + 4;	//index, pos, radius, rot, vel
+	const int BULLET_SIZE = 2 + 1 + 4 + 2 + 4 + 2;	//index, owner, pos, rot, vel, lifetime
+
+	struct Header
+	{
+		float timestamp;
+		float timeLeft;			//seconds until the match ends
+		int asteroidsSpawned;	//lets the client catch its asteroid spawner up
+	};
+
+	struct PlayerState
+	{
+		Transform t;
+		AEVec2 vel;
+		int score;
+	};
+
+	//everything the client needs, inactive slots of golist and bulletlist are kept so indices still match
+	struct State
+	{
+		Header header;
+		std::vector<PlayerState> players;
+		std::vector<GameObject> golist;
+		std::vector<Bullet> bulletlist;
+	};
+
+	std::string Build(Header const& header, std::vector<PlayerState> const& players, std::vector<GameObject> const& golist, std::vector<Bullet> const& bulletlist);
+
+	//returns false if the message is malformed, state is then left partly filled
+	bool Read(const char* buffer, int length, State& state);
+}
@@ -0,0 +1,167 @@
+/*!
+\file		trace.cpp
+\author		darius (d.chan@digipen.edu)
+\co-author
+\par		Assignment 4
+\date		19/10/2026
+\brief
+per thread event buffers and writing them out in the chrome trace event
+format, complete events with microsecond timestamps.
+
+Copyright (C) 2025 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the
+prior written consent of DigiPen Institute of Technology is prohibited.
+*/
+#include "trace.h"
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace TRACE
+{
+	std::atomic<bool> enabled{ false };
+
+	namespace
+	{
+		struct Event
+		{
+			const char* name;
+			long long begin;
+			long long end;
+			int arg;
+		};
+
+		//only its thread adds to it, the lock is there for Write and is otherwise never contended
+		struct Buffer
+		{
+			std::mutex mutex;
+			std::vector<Event> events;
+			long long dropped{ 0 };
+			int tid{ 0 };
+			std::string name;
+		};
+
+		//buffers outlive their threads so a thread that ended still shows up
+		std::mutex buffersMutex{};
+		std::vector<std::unique_ptr<Buffer>> buffers{};
+		std::string processName{ "process" };
+		std::atomic<long long> origin{ 0 };	//Now() at Start, timestamps in the file count from it
+
+		Buffer& ThreadBuffer()
+		{
+			thread_local Buffer* buffer{ nullptr };
+			if (!buffer)
+			{
+				std::unique_ptr<Buffer> fresh{ std::make_unique<Buffer>() };
+				buffer = fresh.get();
+				std::lock_guard<std::mutex> lock{ buffersMutex };
+				fresh->tid = (int)buffers.size() + 1;
+				buffers.push_back(std::move(fresh));
+			}
+			return *buffer;
+		}
+
+		//microseconds since Start, what the format expects
+		double Microseconds(long long nanoseconds)
+		{
+			return (double)(nanoseconds - origin.load(std::memory_order_relaxed)) / 1000.0;
+		}
+	}
+
+	void Start(const char* process)
+	{
+		{
+			std::lock_guard<std::mutex> lock{ buffersMutex };
+			processName = process;
+		}
+		origin.store(Now(), std::memory_order_relaxed);
+		enabled.store(true, std::memory_order_relaxed);
+	}
+
+	void Stop()
+	{
+		enabled.store(false, std::memory_order_relaxed);
+	}
+
+	void NameThread(const char* name)
+	{
+		Buffer& buffer = ThreadBuffer();
+		std::lock_guard<std::mutex> lock{ buffer.mutex };
+		buffer.name = name;
+	}
+
+	long long Now()
+	{
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	void Complete(const char* name, long long begin, long long end, int arg)
+	{
+		Buffer& buffer = ThreadBuffer();
+		std::lock_guard<std::mutex> lock{ buffer.mutex };
+		if (buffer.events.size() >= (size_t)MAX_EVENTS)
+		{
+			++buffer.dropped;
+			return;
+		}
+		buffer.events.push_back(Event{ name, begin, end, arg });
+	}
+
+	bool Write(std::string const& path)
+	{
+		//take what every thread has so far, the threads carry on into empty buffers
+		struct Taken
+		{
+			int tid;
+			std::string name;
+			std::vector<Event> events;
+		};
+		std::vector<Taken> taken{};
+		std::string process{};
+		long long dropped{ 0 };
+		{
+			std::lock_guard<std::mutex> lock{ buffersMutex };
+			process = processName;
+			for (std::unique_ptr<Buffer>& buffer : buffers)
+			{
+				std::lock_guard<std::mutex> bufferLock{ buffer->mutex };
+				taken.push_back(Taken{ buffer->tid, buffer->name, {} });
+				taken.back().events.swap(buffer->events);
+				dropped += buffer->dropped;
+				buffer->dropped = 0;
+			}
+		}
+
+		std::ofstream file{ path };
+		if (!file)
+		{
+			return false;
+		}
+		file.setf(std::ios::fixed);
+		file.precision(3);
+		file << "{\"traceEvents\":[\n";
+		file << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"" << process << "\"}}";
+		for (Taken const& thread : taken)
+		{
+			if (!thread.name.empty())
+			{
+				file << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << thread.tid
+					<< ",\"args\":{\"name\":\"" << thread.name << "\"}}";
+			}
+			for (Event const& e : thread.events)
+			{
+				file << ",\n{\"name\":\"" << e.name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << thread.tid
+					<< ",\"ts\":" << Microseconds(e.begin) << ",\"dur\":" << (double)(e.end - e.begin) / 1000.0;
+				if (e.arg != NO_ARG)
+				{
+					file << ",\"args\":{\"id\":" << e.arg << "}";
+				}
+				file << "}";
+			}
+		}
+		file << "\n],\"displayTimeUnit\":\"ms\",\"otherData\":{\"dropped_events\":" << dropped << "}}\n";
+		return (bool)file;
+	}
+}
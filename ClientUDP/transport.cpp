@@ -0,0 +1,327 @@
+/*!
+\file		transport.cpp
+\author		darius (d.chan@digipen.edu)
+\co-author
+\par		Assignment 4
+\date		19/10/2026
+\brief
+udp, in-memory and simulated transports.
+
+Copyright (C) 2025 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the
+prior written consent of DigiPen Institute of Technology is prohibited.
+*/
+#include "transport.h"
+#include "trace.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <sstream>
+
+namespace
+{
+	unsigned long long Key(sockaddr_in const& addr)
+	{
+		return ((unsigned long long)addr.sin_addr.s_addr << 16) | addr.sin_port;
+	}
+}
+
+namespace TRANSPORT
+{
+	UdpTransport::UdpTransport(SOCKET sock) : _sock{ sock }
+	{
+	}
+
+	UdpTransport::~UdpTransport()
+	{
+		if (_sock != INVALID_SOCKET) closesocket(_sock);
+	}
+
+	int UdpTransport::SendTo(const char* data, int length, sockaddr_in const& to)
+	{
+		TRACE_SCOPE("sendto");
+		return sendto(_sock, data, length, 0, reinterpret_cast<const sockaddr*>(&to), sizeof(to));
+	}
+
+	int UdpTransport::RecvFrom(char* buffer, int length, sockaddr_in& from)
+	{
+#ifdef _WIN32
+		int fromLen = sizeof(from);
+#else
+		socklen_t fromLen = sizeof(from);
+#endif
+		return recvfrom(_sock, buffer, length, 0, reinterpret_cast<sockaddr*>(&from), &fromLen);
+	}
+
+	//one bound address on a Loopback, keeps the network alive while it exists
+	class Loopback::Endpoint : public Transport
+	{
+	public:
+		Endpoint(std::shared_ptr<Loopback> network, sockaddr_in const& addr) : _network{ std::move(network) }, _addr{ addr }
+		{
+		}
+
+		~Endpoint() override
+		{
+			_network->Unbind(Key(_addr));
+		}
+
+		int SendTo(const char* data, int length, sockaddr_in const& to) override
+		{
+			_network->Deliver(_addr, to, data, length);
+			return length;
+		}
+
+		int RecvFrom(char* buffer, int length, sockaddr_in& from) override
+		{
+			Datagram datagram{};
+			if (!_network->Take(Key(_addr), datagram))
+			{
+				WSASetLastError(WSAEWOULDBLOCK);
+				return SOCKET_ERROR;
+			}
+			from = datagram.from;
+			int size = (int)datagram.data.size();
+			std::memcpy(buffer, datagram.data.data(), std::min(size, length));
+			if (size > length)
+			{
+				//the rest is lost, as recvfrom does
+				WSASetLastError(WSAEMSGSIZE);
+				return SOCKET_ERROR;
+			}
+			return size;
+		}
+
+	private:
+		std::shared_ptr<Loopback> _network;
+		sockaddr_in _addr;
+	};
+
+	std::unique_ptr<Transport> Loopback::Bind(sockaddr_in const& addr)
+	{
+		{
+			std::lock_guard<std::mutex> lock{ _mutex };
+			if (!_inboxes.emplace(Key(addr), std::deque<Datagram>{}).second) return nullptr;	//address in use
+		}
+		return std::make_unique<Endpoint>(shared_from_this(), addr);
+	}
+
+	bool Loopback::Deliver(sockaddr_in const& from, sockaddr_in const& to, const char* data, int length)
+	{
+		std::lock_guard<std::mutex> lock{ _mutex };
+		auto inbox = _inboxes.find(Key(to));
+		if (inbox == _inboxes.end()) return false;
+		inbox->second.push_back({ from, std::string(data, length) });
+		return true;
+	}
+
+	bool Loopback::Take(unsigned long long addr, Datagram& datagram)
+	{
+		std::lock_guard<std::mutex> lock{ _mutex };
+		auto inbox = _inboxes.find(addr);
+		if (inbox == _inboxes.end() || inbox->second.empty()) return false;
+		datagram = std::move(inbox->second.front());
+		inbox->second.pop_front();
+		return true;
+	}
+
+	void Loopback::Unbind(unsigned long long addr)
+	{
+		std::lock_guard<std::mutex> lock{ _mutex };
+		_inboxes.erase(addr);
+	}
+
+	bool ParseImpairment(std::string const& line, Impairment& impairment)
+	{
+		std::istringstream iss{ line };
+		float values[6]{ impairment.latency * 1000.f, impairment.jitter * 1000.f, impairment.loss,
+			impairment.duplicate, impairment.reorder, impairment.bandwidth * 8.f / 1000.f };
+		int read = 0;
+		while (read < 6 && iss >> values[read]) ++read;
+		if (read == 0 || (!iss.eof() && iss.fail())) return false;
+
+		impairment.latency = std::max(values[0], 0.f) / 1000.f;
+		impairment.jitter = std::max(values[1], 0.f) / 1000.f;
+		impairment.loss = std::clamp(values[2], 0.f, 1.f);
+		impairment.duplicate = std::clamp(values[3], 0.f, 1.f);
+		impairment.reorder = std::clamp(values[4], 0.f, 1.f);
+		impairment.bandwidth = std::max(values[5], 0.f) * 1000.f / 8.f;
+		return true;
+	}
+
+	SimulatedLink::SimulatedLink(std::unique_ptr<Transport> inner, Impairment const& send, Impairment const& recv, unsigned int seed, Clock clock)
+		: _inner{ std::move(inner) }, _clock{ std::move(clock) }, _mutex{}, _rng{ seed },
+		_send{ send, {}, 0.0 }, _recv{ recv, {}, 0.0 }, _order{ 0 }, _stats{}, _scratch(65536),
+		_wake{}, _stopping{ false }, _delivery{}
+	{
+		if (!_clock) _delivery = std::thread{ &SimulatedLink::DeliveryThread, this };
+	}
+
+	SimulatedLink::~SimulatedLink()
+	{
+		{
+			std::lock_guard<std::mutex> lock{ _mutex };
+			_stopping = true;
+		}
+		_wake.notify_all();
+		if (_delivery.joinable()) _delivery.join();
+	}
+
+	int SimulatedLink::SendTo(const char* data, int length, sockaddr_in const& to)
+	{
+		{
+			std::lock_guard<std::mutex> lock{ _mutex };
+			double now = Now();
+			Impair(_send, data, length, to, now);
+			PumpLocked(now);
+		}
+		_wake.notify_all();
+		return length;		//a lost datagram looks sent, as it would over udp
+	}
+
+	int SimulatedLink::RecvFrom(char* buffer, int length, sockaddr_in& from)
+	{
+		std::lock_guard<std::mutex> lock{ _mutex };
+		double now = Now();
+
+		//everything the inner transport has goes through the link first
+		while (true)
+		{
+			sockaddr_in src{};
+			int bytes = _inner->RecvFrom(_scratch.data(), (int)_scratch.size(), src);
+			if (bytes == SOCKET_ERROR)
+			{
+				int errorCode = WSAGetLastError();
+				if (errorCode == WSAEWOULDBLOCK) break;
+				if (errorCode == WSAECONNRESET || errorCode == WSAEMSGSIZE) continue;
+				return SOCKET_ERROR;
+			}
+			Impair(_recv, _scratch.data(), bytes, src, now);
+		}
+
+		Pending pending{};
+		if (!PopDue(_recv, now, pending))
+		{
+			WSASetLastError(WSAEWOULDBLOCK);
+			return SOCKET_ERROR;
+		}
+		from = pending.addr;
+		int size = (int)pending.data.size();
+		std::memcpy(buffer, pending.data.data(), std::min(size, length));
+		if (size > length)
+		{
+			WSASetLastError(WSAEMSGSIZE);
+			return SOCKET_ERROR;
+		}
+		return size;
+	}
+
+	void SimulatedLink::Pump()
+	{
+		std::lock_guard<std::mutex> lock{ _mutex };
+		PumpLocked(Now());
+	}
+
+	LinkStats SimulatedLink::Stats() const
+	{
+		std::lock_guard<std::mutex> lock{ _mutex };
+		return _stats;
+	}
+
+	void SimulatedLink::Impair(Direction& direction, const char* data, int length, sockaddr_in const& addr, double now)
+	{
+		Impairment const& imp = direction.impairment;
+		std::uniform_real_distribution<float> unit(0.f, 1.f);
+		++_stats.sent;
+
+		//every draw is made whether it is used or not, so one setting does not change the others' sequence
+		bool lost = unit(_rng) < imp.loss;
+		bool twice = unit(_rng) < imp.duplicate;
+		bool held = unit(_rng) < imp.reorder;
+		float jitter = unit(_rng) * imp.jitter;
+		float copyJitter = unit(_rng) * imp.jitter;
+		float holdJitter = unit(_rng) * imp.jitter;
+		if (lost)
+		{
+			++_stats.dropped;
+			return;
+		}
+
+		//the capped link sends one datagram after another, a full queue drops at the tail
+		double departs = now;
+		if (imp.bandwidth > 0.f)
+		{
+			double start = std::max(now, direction.linkFreeAt);
+			if (start - now > imp.queueLimit)
+			{
+				++_stats.dropped;
+				return;
+			}
+			departs = start + length / (double)imp.bandwidth;
+			direction.linkFreeAt = departs;
+		}
+
+		double due = departs + imp.latency + jitter;
+		if (held)
+		{
+			due += imp.latency + holdJitter;
+			++_stats.reordered;
+		}
+		direction.queue.push_back({ due, _order++, addr, std::string(data, length) });
+		std::push_heap(direction.queue.begin(), direction.queue.end(), Later);
+		if (twice)
+		{
+			direction.queue.push_back({ departs + imp.latency + copyJitter, _order++, addr, std::string(data, length) });
+			std::push_heap(direction.queue.begin(), direction.queue.end(), Later);
+			++_stats.duplicated;
+		}
+	}
+
+	bool SimulatedLink::Later(Pending const& a, Pending const& b)
+	{
+		return a.due != b.due ? a.due > b.due : a.order > b.order;
+	}
+
+	bool SimulatedLink::PopDue(Direction& direction, double now, Pending& pending)
+	{
+		if (direction.queue.empty() || direction.queue.front().due > now) return false;
+		std::pop_heap(direction.queue.begin(), direction.queue.end(), Later);
+		pending = std::move(direction.queue.back());
+		direction.queue.pop_back();
+		return true;
+	}
+
+	void SimulatedLink::PumpLocked(double now)
+	{
+		Pending pending{};
+		while (PopDue(_send, now, pending))
+		{
+			//a failed send is just another lost datagram
+			_inner->SendTo(pending.data.data(), (int)pending.data.size(), pending.addr);
+		}
+	}
+
+	void SimulatedLink::DeliveryThread()
+	{
+		std::unique_lock<std::mutex> lock{ _mutex };
+		while (!_stopping)
+		{
+			double now = Now();
+			PumpLocked(now);
+			if (_send.queue.empty())
+			{
+				_wake.wait(lock);
+			}
+			else
+			{
+				_wake.wait_for(lock, std::chrono::duration<double>(_send.queue.front().due - now));
+			}
+		}
+	}
+
+	double SimulatedLink::Now() const
+	{
+		if (_clock) return _clock();
+		return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+}
@@ -0,0 +1,198 @@
+/*!
+\file		transport.h
+\author		darius (d.chan@digipen.edu)
+\co-author
+\par		Assignment 4
+\date		19/10/2026
+\brief
+where datagrams go. the game sends and receives through a Transport
+instead of calling sendto/recvfrom itself, so the same code runs over a
+real udp socket, over an in-memory network inside one process, or through
+a simulated link that adds latency, jitter, loss, duplication, reordering
+and a bandwidth cap. every transport behaves like a non-blocking udp
+socket: errors are SOCKET_ERROR with the reason in WSAGetLastError, and
+WSAEWOULDBLOCK when nothing is waiting. off windows those names map onto
+bsd sockets and errno, so the transports build on linux too and the
+in-memory network and simulated link can be run there without winsock.
+
+Copyright (C) 2025 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the
+prior written consent of DigiPen Institute of Technology is prohibited.
+*/
+#pragma once
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include "Windows.h"
+#include "winsock2.h"
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <cerrno>
+
+//the few winsock names the transports use, on top of bsd sockets
+using SOCKET = int;
+constexpr SOCKET INVALID_SOCKET{ -1 };
+constexpr int SOCKET_ERROR{ -1 };
+constexpr int WSAEWOULDBLOCK{ EWOULDBLOCK };
+constexpr int WSAEMSGSIZE{ EMSGSIZE };
+constexpr int WSAECONNRESET{ ECONNRESET };
+inline int closesocket(SOCKET sock) { return close(sock); }
+inline int WSAGetLastError() { return errno; }
+inline void WSASetLastError(int error) { errno = error; }
+#endif
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace TRANSPORT
+{
+	class Transport
+	{
+	public:
+		virtual ~Transport() = default;
+
+		//like sendto, returns the bytes sent or SOCKET_ERROR
+		virtual int SendTo(const char* data, int length, sockaddr_in const& to) = 0;
+
+		//like recvfrom on a non-blocking socket, returns the bytes received or SOCKET_ERROR
+		virtual int RecvFrom(char* buffer, int length, sockaddr_in& from) = 0;
+	};
+
+	//a bound, non-blocking udp socket. closed with the transport
+	class UdpTransport : public Transport
+	{
+	public:
+		explicit UdpTransport(SOCKET sock);
+		~UdpTransport() override;
+		UdpTransport(UdpTransport const&) = delete;
+		UdpTransport& operator=(UdpTransport const&) = delete;
+
+		int SendTo(const char* data, int length, sockaddr_in const& to) override;
+		int RecvFrom(char* buffer, int length, sockaddr_in& from) override;
+
+	private:
+		SOCKET _sock;
+	};
+
+	//perfect network between endpoints in one process, addressed like udp peers.
+	//a datagram to an address nobody has is dropped, like udp
+	class Loopback : public std::enable_shared_from_this<Loopback>
+	{
+	public:
+		//a transport bound to addr on this network. the address is freed with the transport
+		std::unique_ptr<Transport> Bind(sockaddr_in const& addr);
+
+	private:
+		class Endpoint;
+		struct Datagram
+		{
+			sockaddr_in from;
+			std::string data;
+		};
+
+		bool Deliver(sockaddr_in const& from, sockaddr_in const& to, const char* data, int length);
+		bool Take(unsigned long long addr, Datagram& datagram);
+		void Unbind(unsigned long long addr);
+
+		std::mutex _mutex;
+		std::map<unsigned long long, std::deque<Datagram>> _inboxes;	//by address and port
+	};
+
+	//what a simulated link does to the datagrams going one way
+	struct Impairment
+	{
+		float latency{};		//seconds added to every datagram
+		float jitter{};			//up to this many seconds more, at random
+		float loss{};			//chance in [0, 1] a datagram is dropped
+		float duplicate{};		//chance a datagram arrives twice
+		float reorder{};		//chance a datagram is held back by an extra latency + jitter, so later ones overtake it
+		float bandwidth{};		//bytes per second, 0 for no cap. datagrams queue behind each other
+		float queueLimit{ 0.5f };	//seconds of backlog the capped link holds, datagrams beyond it are dropped
+	};
+
+	//reads "latency_ms jitter_ms loss duplicate reorder bandwidth_kbps", missing values stay as they are.
+	//returns false if the line is not numbers
+	bool ParseImpairment(std::string const& line, Impairment& impairment);
+
+	//what a simulated link did so far
+	struct LinkStats
+	{
+		long long sent{};			//datagrams handed to the link, both ways
+		long long dropped{};		//lost, or over the queue limit
+		long long duplicated{};
+		long long reordered{};
+	};
+
+	//wraps another transport and impairs what goes through it, each way with its own settings.
+	//all randomness comes from one seeded engine, so the same seed and the same traffic give the same result.
+	//with the default clock a thread hands delayed datagrams to the inner transport when they are due.
+	//with a given clock nothing happens on its own, call Pump after moving the clock
+	class SimulatedLink : public Transport
+	{
+	public:
+		using Clock = std::function<double()>;	//seconds
+
+		SimulatedLink(std::unique_ptr<Transport> inner, Impairment const& send, Impairment const& recv, unsigned int seed, Clock clock = nullptr);
+		~SimulatedLink() override;
+		SimulatedLink(SimulatedLink const&) = delete;
+		SimulatedLink& operator=(SimulatedLink const&) = delete;
+
+		int SendTo(const char* data, int length, sockaddr_in const& to) override;
+		int RecvFrom(char* buffer, int length, sockaddr_in& from) override;
+
+		//sends every outgoing datagram that is due
+		void Pump();
+
+		LinkStats Stats() const;
+
+	private:
+		struct Pending
+		{
+			double due;
+			unsigned long long order;	//ties go out in the order they came in
+			sockaddr_in addr;			//destination going out, source coming in
+			std::string data;
+		};
+
+		struct Direction
+		{
+			Impairment impairment;
+			std::vector<Pending> queue;		//min heap on due
+			double linkFreeAt;				//when the capped link finishes sending what it holds
+		};
+
+		//queues the datagram, and its copy, with their delays, unless it is dropped
+		void Impair(Direction& direction, const char* data, int length, sockaddr_in const& addr, double now);
+		static bool Later(Pending const& a, Pending const& b);	//heap order, soonest due on top
+		bool PopDue(Direction& direction, double now, Pending& pending);
+		void PumpLocked(double now);
+		void DeliveryThread();
+		double Now() const;
+
+		std::unique_ptr<Transport> _inner;
+		Clock _clock;
+		mutable std::mutex _mutex;
+		std::mt19937 _rng;
+		Direction _send;
+		Direction _recv;
+		unsigned long long _order;
+		LinkStats _stats;
+		std::vector<char> _scratch;		//what the inner transport received, before it is queued
+
+		std::condition_variable _wake;
+		bool _stopping;
+		std::thread _delivery;
+	};
+}
@@ -0,0 +1,51 @@
+/*!
+\file		triplebuffer.h
+\author		darius (d.chan@digipen.edu)
+\co-author
+\par		Assignment 4
+\date		19/10/2026
+\brief
+lock free hand over of whole frames from one writer thread to one reader
+thread. the writer fills the back slot and publishes it, the reader takes
+the newest published slot. neither side ever waits for the other, the
+reader just keeps its current frame until a newer one is published.
+
+Copyright (C) 2025 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the
+prior written consent of DigiPen Institute of Technology is prohibited.
+*/
+#pragma once
+#include <atomic>
+
+template <typename T>
+class TripleBuffer
+{
+public:
+	//writer only. the slot keeps whatever was written to it three publishes ago
+	T& Back() { return _slots[_back]; }
+
+	//writer only. makes the back slot the newest frame and starts on another one
+	void Publish()
+	{
+		_back = _middle.exchange(_back | FRESH, std::memory_order_acq_rel) & INDEX;
+	}
+
+	//reader only. newest published frame, stays valid until the next call
+	T const& Front()
+	{
+		if (_middle.load(std::memory_order_relaxed) & FRESH)
+		{
+			_front = _middle.exchange(_front, std::memory_order_acq_rel) & INDEX;
+		}
+		return _slots[_front];
+	}
+
+private:
+	static constexpr int INDEX = 3;		//low bits of _middle are a slot index
+	static constexpr int FRESH = 4;		//set when _middle holds a frame the reader has not taken
+
+	T _slots[3]{};
+	int _back{ 0 };
+	int _front{ 1 };
+	std::atomic<int> _middle{ 2 };
+};
@@ -0,0 +1,391 @@
+/*!
+\file		bot.cpp
+\author		darius (d.chan@digipen.edu)
+\co-author
+\par		Assignment 4
+\date		19/10/2026
+\brief
+headless simulated clients for load testing the server.
+
+Copyright (C) 2025 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the
+prior written consent of DigiPen Institute of Technology is prohibited.
+*/
+#include "bot.h"
+#include "protocol.h"
+#include "coalesce.h"
+#include "message.h"
+#include "ship.h"
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <memory>
+#include <thread>
+
+namespace
+{
+	const double KEEPALIVE_INTERVAL = 1.0;
+	const double CONNECTION_TIMEOUT = 5.0;	//silence before reconnecting
+	const double FIRE_ANSWER_TIMEOUT = 2.0;	//a fire the server refused is never answered, stop waiting for it
+
+	const float TICK = 1.f / 60.f;			//seconds between bot steps
+
+	//the client's own ship at the start of a match
+	const GameObject SHIP_START{ {{0.f, 0.f},{SHIP::SCALE, SHIP::SCALE}, 0.f}, {}, ASSET::A_PLAYER, {1.f, 0.f, 0.f, 1.f}, true };
+
+	double Now()
+	{
+		return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+}
+
+namespace BOT
+{
+	void Stats::Merge(Stats const& other)
+	{
+		sent += other.sent;
+		received += other.received;
+		bytesSent += other.bytesSent;
+		bytesReceived += other.bytesReceived;
+		dropped += other.dropped;
+		matches += other.matches;
+		rtt.Merge(other.rtt);
+		fire.Merge(other.fire);
+	}
+
+	Bot::Bot(Config const& config, unsigned int seed)
+		: _config{ config }, _rng{ seed }, _now{ 0.0 }, _link{}, _state{ B_CONNECTING }, _reassembler{},
+		_handshake{}, _playerID{ -1 }, _keepaliveAt{ 0.0 }, _lastHeard{ 0.0 },
+		_clockOffset{ 0.0 }, _serverTimestamp{ 0.f }, _serverTimestampAt{ 0.0 }, _updateAt{ 0.0 },
+		_ship{ SHIP_START }, _thrust{ 0 }, _turn{ 0 }, _fire{ false }, _inputTimer{ 0.f }, _fireCooldown{ 0.f },
+		_inputs{}, _pendingFires{}
+	{
+		_handshake.Start(0, 0.0);
+	}
+
+	Bot::~Bot() = default;
+
+	bool Bot::Open()
+	{
+		SOCKET sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+		if (sock == INVALID_SOCKET) return false;
+
+		sockaddr_in local{};
+		local.sin_family = AF_INET;
+		local.sin_addr.s_addr = INADDR_ANY;
+		local.sin_port = 0;		//any free port, the server tells bots apart by it
+		if (bind(sock, reinterpret_cast<sockaddr*>(&local), sizeof(local)) != NO_ERROR)
+		{
+			closesocket(sock);
+			return false;
+		}
+		u_long enable = 1;
+		ioctlsocket(sock, FIONBIO, &enable);
+
+		return Open(std::make_unique<TRANSPORT::UdpTransport>(sock));
+	}
+
+	bool Bot::Open(std::unique_ptr<TRANSPORT::Transport> transport)
+	{
+		if (!transport) return false;
+
+		//the link runs on the bot's clock, so a thread of bots needs no thread per link
+		_link = std::make_unique<TRANSPORT::SimulatedLink>(std::move(transport), _config.link, _config.link, _rng(), [this] { return _now; });
+		return true;
+	}
+
+	void Bot::Tick(double now, float dt, Stats& stats, Progress& progress)
+	{
+		if (!_link || _state == B_REJECTED || _state == B_FAILED) return;
+
+		_now = now;
+		Receive(now, stats, progress);
+
+		switch (_state)
+		{
+		case B_CONNECTING:
+			Connect(now, stats, progress);
+			break;
+		case B_WAITING:
+			if (now >= _keepaliveAt)
+			{
+				Send(std::string(1, (char)C_KEEPALIVE), stats);
+				_keepaliveAt = now + KEEPALIVE_INTERVAL;
+			}
+			break;
+		case B_PLAYING:
+			Play(now, dt, stats);
+			break;
+		default:
+			break;
+		}
+
+		//a server that went quiet is reconnected to, into the same slot if it still holds it
+		if ((_state == B_WAITING || _state == B_PLAYING) && now - _lastHeard > CONNECTION_TIMEOUT)
+		{
+			SetState(B_CONNECTING, progress);
+			_handshake.Start(_handshake.Session(), now);
+		}
+
+		_link->Pump();
+	}
+
+	void Bot::Close(Stats& stats)
+	{
+		if (!_link) return;
+		if (_handshake.Session() != 0)
+		{
+			Send(std::string(1, (char)C_DISCONNECT), stats);
+		}
+		//the link is not ticked again, whatever it still holds goes out now
+		_now = std::numeric_limits<double>::max();
+		_link->Pump();
+		stats.dropped += _link->Stats().dropped;
+		_link.reset();
+	}
+
+	void Bot::Receive(double now, Stats& stats, Progress& progress)
+	{
+		char buff[MAX_DATAGRAM_SIZE];
+		while (true)
+		{
+			sockaddr_in from{};
+			int bytes = _link->RecvFrom(buff, MAX_DATAGRAM_SIZE, from);
+			if (bytes == SOCKET_ERROR || bytes == 0) break;
+			if (from.sin_addr.s_addr != _config.server.sin_addr.s_addr || from.sin_port != _config.server.sin_port) continue;
+
+			++stats.received;
+			stats.bytesReceived += bytes;
+			_lastHeard = now;
+
+			//what Network.cpp does: batches are split, fragments put back together
+			COALESCE::ForEach(buff, bytes, [&](const char* message, int length) {
+				std::string whole{};
+				if ((unsigned char)message[0] == C_FRAGMENT)
+				{
+					if (!_reassembler.Add(0, message, length, (float)now, whole)) return;
+					Handle(whole.data(), (int)whole.size(), now, stats, progress);
+				}
+				else
+				{
+					Handle(message, length, now, stats, progress);
+				}
+			});
+		}
+	}
+
+	void Bot::Handle(const char* buffer, int length, double now, Stats& stats, Progress& progress)
+	{
+		if (length < 1 || length < MinimumSize((unsigned char)buffer[0])) return;
+
+		switch ((unsigned char)buffer[0])
+		{
+		case C_CHALLENGE:
+		case C_RSP_CONNECT:
+			//the outcome is picked up by Connect
+			if (_state == B_CONNECTING)
+			{
+				_handshake.Handle(buffer, length, now);
+			}
+			break;
+		case C_GAME_START:
+			if (_state == B_WAITING)
+			{
+				++stats.matches;
+				_clockOffset = -now;
+				_serverTimestamp = 0.f;
+				_updateAt = now;
+				_inputs.Clear();
+				_pendingFires.clear();
+				_ship = SHIP_START;
+				SetState(B_PLAYING, progress);
+			}
+			break;
+		case C_TIME_SYNC:
+		case C_FULL_STATE:
+			//the server's clock is the match clock, like ProcessTimeSync
+			_clockOffset = ntohf(*(uint32_t*)(buffer + 1)) - now;
+			break;
+		case C_ALL_UPDATE:
+			if (_state == B_PLAYING)
+			{
+				_serverTimestamp = ntohf(*(uint32_t*)(buffer + 1));
+				_serverTimestampAt = now;
+				const int echoAt = MinimumSize(C_ALL_UPDATE);
+				if (length >= echoAt + 4)
+				{
+					float echo = ntohf(*(uint32_t*)(buffer + echoAt));
+					if (echo > 0.f) stats.rtt.Add(MatchTime(now) - echo);
+				}
+			}
+			break;
+		case C_RSP_FIRE:
+			if ((int)ntohl(*(uint32_t*)(buffer + 5)) == _playerID)
+			{
+				//answers come back in the order the server applied the fires, which is the order they were sent
+				while (!_pendingFires.empty() && now - _pendingFires.front() > FIRE_ANSWER_TIMEOUT)
+				{
+					_pendingFires.erase(_pendingFires.begin());
+				}
+				if (!_pendingFires.empty())
+				{
+					stats.fire.Add((float)(now - _pendingFires.front()));
+					_pendingFires.erase(_pendingFires.begin());
+				}
+			}
+			break;
+		case C_GAME_END:
+			if (_state == B_PLAYING)
+			{
+				_keepaliveAt = now;
+				SetState(B_WAITING, progress);
+			}
+			break;
+		default:
+			break;
+		}
+	}
+
+	void Bot::Send(std::string const& message, Stats& stats)
+	{
+		int bytes = _link->SendTo(message.data(), (int)message.size(), _config.server);
+		if (bytes == SOCKET_ERROR) return;
+		++stats.sent;
+		stats.bytesSent += bytes;
+	}
+
+	void Bot::SetState(BotState state, Progress& progress)
+	{
+		auto connected = [](BotState s) { return s == B_WAITING || s == B_PLAYING; };
+		if (connected(_state) && !connected(state)) --progress.connected;
+		if (!connected(_state) && connected(state)) ++progress.connected;
+		if (_state == B_PLAYING) --progress.playing;
+		if (state == B_PLAYING) ++progress.playing;
+		if (state == B_REJECTED) ++progress.rejected;
+		if (state == B_FAILED) ++progress.failed;
+		_state = state;
+	}
+
+	void Bot::Connect(double now, Stats& stats, Progress& progress)
+	{
+		std::string request{};
+		if (_handshake.Due(now, request))
+		{
+			Send(request, stats);
+		}
+
+		switch (_handshake.State())
+		{
+		case HANDSHAKE::S_CONNECTED:
+			_playerID = _handshake.Player();
+			_keepaliveAt = now;
+			_lastHeard = now;
+			SetState(B_WAITING, progress);
+			break;
+		case HANDSHAKE::S_FULL:
+			SetState(B_REJECTED, progress);
+			break;
+		case HANDSHAKE::S_NO_ANSWER:
+			SetState(B_FAILED, progress);
+			break;
+		default:
+			break;
+		}
+	}
+
+	void Bot::Play(double now, float dt, Stats& stats)
+	{
+		ChooseInput(dt);
+
+		//the client's UpdateInput, then its simulation step
+		SHIP::Steer(_ship.t.rot, _ship.vel, _turn, _thrust, dt);
+		_ship.Update(SHIP::SCREEN, dt);
+
+		//a fire goes out at once, like QueueFire
+		_fireCooldown -= dt;
+		if (_fire && _fireCooldown <= 0.f)
+		{
+			_fireCooldown = SHIP::FIRE_COOLDOWN;
+			float t = MatchTime(now);
+			_inputs.Push(t, INPUTFRAME::F_FIRE);
+			Send(MESSAGE::ReqFire(t, _inputs), stats);
+			_pendingFires.push_back(now);
+		}
+
+		if (now >= _updateAt)
+		{
+			//the echo is the newest server timestamp plus how long we held it, like CreateUpdate
+			float echo = _serverTimestamp > 0.f ? _serverTimestamp + (float)(now - _serverTimestampAt) : 0.f;
+			Send(MESSAGE::StateUpdate(MatchTime(now), _ship, echo, _inputs), stats);
+			_updateAt += 1.0 / _config.updateRate;
+			if (_updateAt < now) _updateAt = now;	//fell behind, do not burst to catch up
+		}
+	}
+
+	void Bot::ChooseInput(float dt)
+	{
+		if (_config.mode == M_SCRIPTED)
+		{
+			//a slow figure eight at full thrust, firing whenever the cooldown allows
+			_inputTimer += dt;
+			_thrust = 1;
+			_turn = ((int)(_inputTimer / 2.f) % 2) ? -1 : 1;
+			_fire = true;
+			return;
+		}
+
+		_inputTimer -= dt;
+		if (_inputTimer > 0.f) return;
+		std::uniform_int_distribution<int> dir(-1, 1);
+		std::uniform_real_distribution<float> unit(0.f, 1.f);
+		_thrust = dir(_rng);
+		_turn = dir(_rng);
+		_fire = unit(_rng) < 0.5f;
+		_inputTimer = 0.5f + unit(_rng) * 1.5f;
+	}
+
+	float Bot::MatchTime(double now) const
+	{
+		return (float)(now + _clockOffset);
+	}
+
+	void RunThread(Config const& config, int first, int count, std::atomic<bool> const& running, Progress& progress, Stats& stats)
+	{
+		std::vector<std::unique_ptr<Bot>> bots{};
+		bots.reserve(count);
+		for (int i = 0; i < count; ++i)
+		{
+			std::unique_ptr<Bot> bot = std::make_unique<Bot>(config, config.seed + (unsigned int)(first + i));
+			if (!bot->Open())
+			{
+				++progress.failed;
+				continue;
+			}
+			bots.push_back(std::move(bot));
+		}
+
+		//fixed steps, a late step is run with the time it actually took
+		const std::chrono::steady_clock::duration step = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<float>(TICK));
+		std::chrono::steady_clock::time_point next = std::chrono::steady_clock::now();
+		double last = Now();
+		while (running)
+		{
+			double now = Now();
+			float dt = (float)std::min(now - last, 0.25);
+			last = now;
+			for (std::unique_ptr<Bot>& bot : bots)
+			{
+				bot->Tick(now, dt, stats, progress);
+			}
+
+			next += step;
+			if (next < std::chrono::steady_clock::now()) next = std::chrono::steady_clock::now();
+			std::this_thread::sleep_until(next);
+		}
+
+		for (std::unique_ptr<Bot>& bot : bots)
+		{
+			bot->Close(stats);
+		}
+	}
+}
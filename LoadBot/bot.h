@@ -0,0 +1,156 @@
+/*!
+\file		bot.h
+\author		darius (d.chan@digipen.edu)
+\co-author
+\par		Assignment 4
+\date		19/10/2026
+\brief
+headless simulated clients for load testing the server. a bot speaks the
+same protocol as ClientUDP: it connects through the cookie handshake,
+waits in the match queue with keepalives, and in a match sends state
+updates with redundant input frames and fires. movement and fire come
+from random or scripted inputs. every bot has its own socket and its own
+impaired link, so loss and latency are applied per client.
+
+the handshake, the request layouts and the ship's handling are the
+client's own (handshake.h, message.h, ship.h), only the threads and the
+input are the bot's.
+
+Copyright (C) 2025 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the
+prior written consent of DigiPen Institute of Technology is prohibited.
+*/
+#pragma once
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include "Windows.h"
+#include "winsock2.h"
+
+#include "latency.h"
+#include "input.h"
+#include "fragment.h"
+#include "transport.h"
+#include "gameobject.h"
+#include "handshake.h"
+#include <string>
+#include <vector>
+#include <memory>
+#include <random>
+#include <atomic>
+
+namespace BOT
+{
+	enum InputMode
+	{
+		M_RANDOM,		//thrust, turn and fire change at random intervals
+		M_SCRIPTED		//every bot flies the same loop and fires whenever it can
+	};
+
+	struct Config
+	{
+		sockaddr_in server;
+		int bots;
+		int threads;
+		double seconds;		//how long to run once the bots are started
+		TRANSPORT::Impairment link;	//applied each way on every bot's link
+		float updateRate;	//C_STATE_UPDATE per second while in a match
+		InputMode mode;
+		unsigned int seed;
+	};
+
+	//counters shared by every thread while the test runs
+	struct Progress
+	{
+		std::atomic<int> connected{};
+		std::atomic<int> playing{};
+		std::atomic<int> rejected{};	//server full
+		std::atomic<int> failed{};		//never answered
+	};
+
+	//per thread results, merged at the end
+	struct Stats
+	{
+		long long sent{};
+		long long received{};
+		long long bytesSent{};
+		long long bytesReceived{};
+		long long dropped{};		//by the simulated links
+		int matches{};				//C_GAME_START seen, summed over bots
+		LATENCY::Histogram rtt{};	//client observed, from the server echoing our timestamps
+		LATENCY::Histogram fire{};	//C_REQ_FIRE sent until the server's C_RSP_FIRE for it arrived
+
+		void Merge(Stats const& other);
+	};
+
+	class Bot
+	{
+	public:
+		Bot(Config const& config, unsigned int seed);
+		~Bot();
+		Bot(Bot const&) = delete;
+		Bot& operator=(Bot const&) = delete;
+
+		//creates the socket on an ephemeral port behind a simulated link, false if that failed
+		bool Open();
+		//puts transport, already bound to the bot's address, behind the simulated link
+		bool Open(std::unique_ptr<TRANSPORT::Transport> transport);
+
+		//one step: takes in what arrived, moves, and sends what is due
+		void Tick(double now, float dt, Stats& stats, Progress& progress);
+
+		//frees the server slot
+		void Close(Stats& stats);
+
+	private:
+		enum BotState
+		{
+			B_CONNECTING,
+			B_WAITING,		//connected, in the match queue
+			B_PLAYING,
+			B_REJECTED,		//server full
+			B_FAILED		//server did not answer
+		};
+
+		void Receive(double now, Stats& stats, Progress& progress);
+		void Handle(const char* buffer, int length, double now, Stats& stats, Progress& progress);
+		void Send(std::string const& message, Stats& stats);
+		void SetState(BotState state, Progress& progress);
+
+		void Connect(double now, Stats& stats, Progress& progress);
+		void Play(double now, float dt, Stats& stats);
+		void ChooseInput(float dt);
+
+		//seconds on the server's match clock
+		float MatchTime(double now) const;
+
+		Config const& _config;
+		std::mt19937 _rng;
+		double _now;		//the link's clock, moved by Tick
+		std::unique_ptr<TRANSPORT::SimulatedLink> _link;
+		BotState _state;
+		FRAGMENT::Reassembler _reassembler;
+
+		//connection
+		HANDSHAKE::Handshake _handshake;
+		int _playerID;
+		double _keepaliveAt;
+		double _lastHeard;
+
+		//match
+		double _clockOffset;			//MatchTime is now + this
+		float _serverTimestamp;			//newest C_ALL_UPDATE timestamp, echoed back
+		double _serverTimestampAt;
+		double _updateAt;
+		GameObject _ship;				//flown the same as the client flies its own
+		int _thrust, _turn;
+		bool _fire;
+		float _inputTimer;
+		float _fireCooldown;
+		INPUTFRAME::History _inputs;
+		std::vector<double> _pendingFires;	//when each unanswered C_REQ_FIRE went out, oldest first
+	};
+
+	//runs bots [first, first + count) until running goes false, then closes them
+	void RunThread(Config const& config, int first, int count, std::atomic<bool> const& running, Progress& progress, Stats& stats);
+}
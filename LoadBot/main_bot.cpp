@@ -0,0 +1,169 @@
+/*!
+\file		main_bot.cpp
+\author		darius (d.chan@digipen.edu)
+\co-author
+\par		Assignment 4
+\date		19/10/2026
+\brief
+load generator. runs many headless bots against a server for a fixed time
+and prints the client observed round trip and fire latency percentiles.
+the server logs its own rtt percentiles at the end of every match.
+
+usage: LoadBot <server ip> <port> [--bots N] [--threads T] [--seconds S]
+               [--loss P] [--latency MS] [--jitter MS] [--duplicate P]
+               [--reorder P] [--bandwidth KBPS] [--rate HZ]
+               [--mode random|scripted] [--seed N]
+
+Copyright (C) 2025 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the
+prior written consent of DigiPen Institute of Technology is prohibited.
+*/
+#include "bot.h"
+#include "ws2tcpip.h"
+#include "timeapi.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <thread>
+
+#pragma comment(lib, "ws2_32.lib")
+#pragma comment(lib, "winmm.lib")
+
+namespace
+{
+	const double PROGRESS_INTERVAL = 5.0;
+
+	void Usage()
+	{
+		std::cerr << "usage: LoadBot <server ip> <port> [--bots N] [--threads T] [--seconds S]\n"
+			<< "               [--loss P] [--latency MS] [--jitter MS] [--duplicate P]\n"
+			<< "               [--reorder P] [--bandwidth KBPS] [--rate HZ]\n"
+			<< "               [--mode random|scripted] [--seed N]" << std::endl;
+	}
+
+	//false on anything it does not understand
+	bool ParseArgs(int argc, char* argv[], BOT::Config& config)
+	{
+		if (argc < 3) return false;
+
+		config.server = {};
+		config.server.sin_family = AF_INET;
+		if (inet_pton(AF_INET, argv[1], &config.server.sin_addr) != 1) return false;
+		int port = std::atoi(argv[2]);
+		if (port <= 0 || port > 65535) return false;
+		config.server.sin_port = htons((u_short)port);
+
+		for (int i = 3; i < argc; ++i)
+		{
+			if (i + 1 >= argc) return false;
+			const char* opt = argv[i];
+			const char* val = argv[++i];
+			if (!std::strcmp(opt, "--bots")) config.bots = std::atoi(val);
+			else if (!std::strcmp(opt, "--threads")) config.threads = std::atoi(val);
+			else if (!std::strcmp(opt, "--seconds")) config.seconds = std::atof(val);
+			else if (!std::strcmp(opt, "--loss")) config.link.loss = (float)std::atof(val);
+			else if (!std::strcmp(opt, "--latency")) config.link.latency = (float)std::atof(val) / 1000.f;
+			else if (!std::strcmp(opt, "--jitter")) config.link.jitter = (float)std::atof(val) / 1000.f;
+			else if (!std::strcmp(opt, "--duplicate")) config.link.duplicate = (float)std::atof(val);
+			else if (!std::strcmp(opt, "--reorder")) config.link.reorder = (float)std::atof(val);
+			else if (!std::strcmp(opt, "--bandwidth")) config.link.bandwidth = (float)std::atof(val) * 1000.f / 8.f;
+			else if (!std::strcmp(opt, "--rate")) config.updateRate = (float)std::atof(val);
+			else if (!std::strcmp(opt, "--seed")) config.seed = (unsigned int)std::strtoul(val, nullptr, 10);
+			else if (!std::strcmp(opt, "--mode"))
+			{
+				if (!std::strcmp(val, "random")) config.mode = BOT::M_RANDOM;
+				else if (!std::strcmp(val, "scripted")) config.mode = BOT::M_SCRIPTED;
+				else return false;
+			}
+			else return false;
+		}
+
+		return config.bots > 0 && config.threads > 0 && config.seconds > 0.0 && config.updateRate > 0.f
+			&& config.link.loss >= 0.f && config.link.loss <= 1.f && config.link.duplicate >= 0.f && config.link.duplicate <= 1.f
+			&& config.link.reorder >= 0.f && config.link.reorder <= 1.f
+			&& config.link.latency >= 0.f && config.link.jitter >= 0.f && config.link.bandwidth >= 0.f;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	BOT::Config config{};
+	config.bots = 4;
+	config.threads = 1;
+	config.seconds = 60.0;
+	config.updateRate = 30.f;
+	config.mode = BOT::M_RANDOM;
+	config.seed = 1;
+	if (!ParseArgs(argc, argv, config))
+	{
+		Usage();
+		return 1;
+	}
+	config.threads = std::min(config.threads, config.bots);
+
+	WSADATA wsaData{};
+	int res = WSAStartup(MAKEWORD(2, 2), &wsaData);
+	if (res != NO_ERROR)
+	{
+		std::cerr << "WSAStartup failed with error: " << res << std::endl;
+		return 1;
+	}
+	timeBeginPeriod(1);		//bots step at 60Hz, the default timer is too coarse for that
+
+	std::cout << "LoadBot: " << config.bots << " bots on " << config.threads << " threads for " << config.seconds << "s, loss "
+		<< config.link.loss * 100.f << "%, latency " << config.link.latency * 1000.f << "ms + " << config.link.jitter * 1000.f << "ms jitter, "
+		<< config.link.duplicate * 100.f << "% duplicated, " << config.link.reorder * 100.f << "% reordered, "
+		<< (config.link.bandwidth > 0.f ? std::to_string((int)(config.link.bandwidth * 8.f / 1000.f)) + "kbps, " : std::string{})
+		<< config.updateRate << "Hz updates, " << (config.mode == BOT::M_SCRIPTED ? "scripted" : "random") << " input" << std::endl;
+
+	std::atomic<bool> running{ true };
+	BOT::Progress progress{};
+	std::vector<BOT::Stats> stats(config.threads);
+	std::vector<std::thread> threads{};
+	int first = 0;
+	for (int t = 0; t < config.threads; ++t)
+	{
+		//spread the remainder over the first threads
+		int count = config.bots / config.threads + (t < config.bots % config.threads ? 1 : 0);
+		threads.emplace_back(BOT::RunThread, std::cref(config), first, count, std::cref(running), std::ref(progress), std::ref(stats[t]));
+		first += count;
+	}
+
+	const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	const std::chrono::steady_clock::time_point end = start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(config.seconds));
+	std::chrono::steady_clock::time_point report = start;
+	while (std::chrono::steady_clock::now() < end)
+	{
+		report += std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(PROGRESS_INTERVAL));
+		std::this_thread::sleep_until(std::min(report, end));
+		std::cout << "[" << (int)std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() << "s] connected "
+			<< progress.connected << ", playing " << progress.playing << ", rejected " << progress.rejected << ", failed " << progress.failed << std::endl;
+	}
+
+	running = false;
+	for (std::thread& t : threads)
+	{
+		t.join();
+	}
+
+	BOT::Stats total{};
+	for (BOT::Stats const& s : stats)
+	{
+		total.Merge(s);
+	}
+
+	std::cout << "\nbots: " << config.bots << ", rejected (server full) " << progress.rejected << ", failed " << progress.failed << "\n"
+		<< "matches started: " << total.matches << "\n"
+		<< "sent: " << total.sent << " packets, " << total.bytesSent << " bytes\n"
+		<< "received: " << total.received << " packets, " << total.bytesReceived << " bytes\n"
+		<< "dropped by simulated links: " << total.dropped << "\n"
+		<< "rtt  " << total.rtt.Summary() << "\n"
+		<< "fire " << total.fire.Summary() << "\n"
+		<< "server side rtt percentiles are printed by the server at the end of each match" << std::endl;
+
+	timeEndPeriod(1);
+	WSACleanup();
+	return 0;
+}
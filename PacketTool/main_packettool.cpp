@@ -0,0 +1,506 @@
+/*!
+\file		main_packettool.cpp
+\author		darius (d.chan@digipen.edu)
+\co-author
+\par		Assignment 4
+\date		19/10/2026
+\brief
+offline tool for capture files written by the server or the client with
+--capture. decode prints every datagram with each message in it spelled
+out, stats prints messages and bandwidth per CommandID, replay sends the
+datagrams a capture saw going to the server into a running server again,
+one socket per original client and at the original times.
+
+usage: PacketTool decode <file>
+       PacketTool stats <file>
+       PacketTool replay <file> <server ip> <port> [--speed X]
+
+Copyright (C) 2025 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the
+prior written consent of DigiPen Institute of Technology is prohibited.
+*/
+#include "capture.h"
+#include "coalesce.h"
+#include "fragment.h"
+#include "input.h"
+#include "message.h"
+#include "protocol.h"
+#include "replication.h"
+#include "snapshot.h"
+#include "ws2tcpip.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#pragma comment(lib, "ws2_32.lib")
+
+namespace
+{
+	const double COOKIE_WAIT = 1.0;		//seconds a replayed connect waits for the server's challenge
+	const double DRAIN_TIME = 1.0;		//seconds replies are still read after the last datagram
+
+	void Usage()
+	{
+		std::cerr << "usage: PacketTool decode <file>\n"
+			<< "       PacketTool stats <file>\n"
+			<< "       PacketTool replay <file> <server ip> <port> [--speed X]" << std::endl;
+	}
+
+	float Float(const char* at)
+	{
+		return ntohf(*(uint32_t*)at);
+	}
+
+	unsigned int U32(const char* at)
+	{
+		return ntohl(*(uint32_t*)at);
+	}
+
+	unsigned short U16(const char* at)
+	{
+		return ntohs(*(uint16_t*)at);
+	}
+
+	std::string Address(sockaddr_in const& addr)
+	{
+		char ip[INET_ADDRSTRLEN]{};
+		inet_ntop(AF_INET, &addr.sin_addr, ip, sizeof(ip));
+		return std::string{ ip } + ":" + std::to_string(ntohs(addr.sin_port));
+	}
+
+	unsigned long long Key(sockaddr_in const& addr)
+	{
+		return ((unsigned long long)addr.sin_addr.s_addr << 16) | addr.sin_port;
+	}
+
+	//pos, scale, rot, vel as the updates send them, scale is left out
+	void Body(std::ostream& out, const char* at)
+	{
+		out << "pos=(" << Float(at) << "," << Float(at + 4) << ") rot=" << Float(at + 16)
+			<< " vel=(" << Float(at + 20) << "," << Float(at + 24) << ")";
+	}
+
+	void Inputs(std::ostream& out, const char* at, int length)
+	{
+		std::vector<INPUTFRAME::Frame> frames{};
+		if (INPUTFRAME::Read(at, length, frames) < 0)
+		{
+			out << " inputs=truncated";
+			return;
+		}
+		out << " inputs=[";
+		for (size_t i = 0; i < frames.size(); ++i)
+		{
+			out << (i ? " " : "") << frames[i].seq << "@" << frames[i].timestamp << (frames[i].flags & INPUTFRAME::F_FIRE ? "F" : "");
+		}
+		out << "]";
+	}
+
+	//walks the counts of a C_FULL_STATE, the entities themselves are only counted
+	void FullState(std::ostream& out, const char* data, int length)
+	{
+		out << " timestamp=" << Float(data + 1) << " timeleft=" << Float(data + 5) << " spawned=" << U32(data + 9);
+		int offset = 13;
+		int players = (unsigned char)data[offset];
+		offset += 1 + players * SNAPSHOT::PLAYER_SIZE;
+		if (offset + 4 > length)
+		{
+			out << " truncated";
+			return;
+		}
+		int asteroids = U16(data + offset + 2);
+		out << " players=" << players << " golist=" << U16(data + offset) << " asteroids=" << asteroids;
+		offset += 4 + asteroids * SNAPSHOT::ASTEROID_SIZE;
+		if (offset + 4 > length)
+		{
+			out << " truncated";
+			return;
+		}
+		int bullets = U16(data + offset + 2);
+		out << " bulletlist=" << U16(data + offset) << " bullets=" << bullets;
+		offset += 4 + bullets * SNAPSHOT::BULLET_SIZE;
+		if (offset != length) out << " (" << length - offset << "b unaccounted)";
+	}
+
+	//one message, no batch or fragment around it, on one line
+	std::string Describe(const char* data, int length)
+	{
+		std::ostringstream out{};
+		unsigned char id = (unsigned char)data[0];
+		out << CommandName(id) << " " << length << "b";
+		if (length < MinimumSize(id))
+		{
+			out << " too short";
+			return out.str();
+		}
+
+		switch (id)
+		{
+		case C_STATE_UPDATE:
+			out << " timestamp=" << Float(data + 1) << " ";
+			Body(out, data + 5);
+			if (length >= STATE_UPDATE_INPUTS)
+			{
+				out << " echo=" << Float(data + 5 + MESSAGE::BODY_SIZE);
+				Inputs(out, data + STATE_UPDATE_INPUTS, length - STATE_UPDATE_INPUTS);
+			}
+			break;
+		case C_ALL_UPDATE:
+		case C_TIME_SYNC:
+			out << " timestamp=" << Float(data + 1);
+			for (int i = 0; i < 4; ++i)
+			{
+				out << " p" << i << ":";
+				Body(out, data + 5 + i * MESSAGE::BODY_SIZE);
+			}
+			if (id == C_ALL_UPDATE && length >= 5 + 4 * MESSAGE::BODY_SIZE + 4) out << " echo=" << Float(data + 5 + 4 * MESSAGE::BODY_SIZE);
+			break;
+		case C_REQ_FIRE:
+			Inputs(out, data + 1, length - 1);
+			break;
+		case C_RSP_FIRE:
+			out << " timestamp=" << Float(data + 1) << " player=" << (int)U32(data + 5) << " bullet=" << U16(data + 9);
+			break;
+		case C_ASTEROID_SPAWN:
+			out << " timestamp=" << Float(data + 1) << " index=" << U16(data + 5);
+			break;
+		case C_ASTEROID_DESTROY:
+			out << " index=" << U32(data + 1);
+			break;
+		case C_REQ_CONNECT:
+			out << " cookie=" << std::hex << U32(data + 1) << " session=" << U32(data + 5) << std::dec;
+			break;
+		case C_RSP_CONNECT:
+			out << " player=" << (int)U32(data + 1) << " session=" << std::hex << U32(data + 5) << std::dec;
+			break;
+		case C_GAME_END:
+			out << " scores=[";
+			for (int i = 0; i < 4; ++i)
+			{
+				out << (i ? " " : "") << (int)U32(data + 1 + 12 * 5 + 4 * i);
+			}
+			out << "] highscores=[";
+			for (int i = 0; i < 5; ++i)
+			{
+				out << (i ? " " : "") << (int)U32(data + 1 + 12 * i);
+			}
+			out << "]";
+			break;
+		case C_ENTITY_UPDATE:
+		{
+			int count = U16(data + 5);
+			out << " timestamp=" << Float(data + 1) << " count=" << count;
+			if (REPLICATION::HEADER_SIZE + count * REPLICATION::ENTITY_SIZE > length)
+			{
+				out << " truncated";
+				break;
+			}
+			for (int i = 0; i < count; ++i)
+			{
+				const char* e = data + REPLICATION::HEADER_SIZE + i * REPLICATION::ENTITY_SIZE;
+				out << (e[0] ? " bullet#" : " asteroid#") << U16(e + 1) << (e[3] ? "" : "(gone)")
+					<< " pos=(" << Float(e + 4) << "," << Float(e + 8) << ")";
+			}
+			break;
+		}
+		case C_FRAGMENT:
+			out << " message=" << U16(data + 1) << " part=" << (int)(unsigned char)data[3] + 1 << "/" << (int)(unsigned char)data[4];
+			break;
+		case C_CHALLENGE:
+			out << " cookie=" << std::hex << U32(data + 1) << std::dec;
+			break;
+		case C_FULL_STATE:
+			FullState(out, data, length);
+			break;
+		default:
+			break;
+		}
+		return out.str();
+	}
+
+	bool OpenCapture(std::string const& path, CAPTURE::Reader& reader)
+	{
+		if (!reader.Open(path))
+		{
+			std::cerr << path << " is missing or not a capture file" << std::endl;
+			return false;
+		}
+		return true;
+	}
+
+	int Decode(std::string const& path)
+	{
+		CAPTURE::Reader reader{};
+		if (!OpenCapture(path, reader)) return 1;
+		std::cout << path << ": captured by the " << (reader.GetRole() == CAPTURE::R_SERVER ? "server" : "client") << "\n";
+
+		std::cout << std::fixed << std::setprecision(3);
+		FRAGMENT::Reassembler reassembler{};
+		CAPTURE::Record record{};
+		while (reader.Next(record))
+		{
+			std::cout << std::setw(10) << record.time << (record.direction == CAPTURE::D_IN ? " <- " : " -> ")
+				<< Address(record.peer) << " " << record.data.size() << "b\n";
+			bool whole = COALESCE::ForEach(record.data.data(), (int)record.data.size(), [&](const char* data, int length)
+				{
+					std::cout << "    " << Describe(data, length) << "\n";
+					std::string message{};
+					if ((unsigned char)data[0] == C_FRAGMENT
+						&& reassembler.Add((Key(record.peer) << 1 | record.direction), data, length, (float)record.time, message))
+					{
+						std::cout << "    = " << Describe(message.data(), (int)message.size()) << "\n";
+					}
+				});
+			if (!whole) std::cout << "    malformed batch\n";
+		}
+		return 0;
+	}
+
+	struct Tally
+	{
+		long long messages;
+		long long bytes;
+	};
+
+	int Stats(std::string const& path)
+	{
+		CAPTURE::Reader reader{};
+		if (!OpenCapture(path, reader)) return 1;
+
+		//per direction: datagrams as they were on the wire, and every message by its own id.
+		//a batch is counted once with only its own header and lengths, its messages under their ids
+		Tally datagrams[2]{};
+		std::map<unsigned char, Tally> messages[2]{};
+		double first{ -1.0 }, last{ 0.0 };
+		CAPTURE::Record record{};
+		while (reader.Next(record))
+		{
+			if (first < 0.0) first = record.time;
+			last = record.time;
+			int size = (int)record.data.size();
+			++datagrams[record.direction].messages;
+			datagrams[record.direction].bytes += size;
+			std::map<unsigned char, Tally>& byId = messages[record.direction];
+			int inside{ 0 };
+			COALESCE::ForEach(record.data.data(), size, [&](const char* data, int length)
+				{
+					Tally& tally = byId[(unsigned char)data[0]];
+					++tally.messages;
+					tally.bytes += length;
+					inside += length;
+				});
+			if (size > 0 && (unsigned char)record.data[0] == C_BATCH)
+			{
+				++byId[C_BATCH].messages;
+				byId[C_BATCH].bytes += size - inside;
+			}
+		}
+		double duration = std::max(last - std::max(first, 0.0), 1e-6);
+
+		std::cout << path << ": captured by the " << (reader.GetRole() == CAPTURE::R_SERVER ? "server" : "client")
+			<< ", " << std::fixed << std::setprecision(3) << duration << "s\n";
+		const char* names[2] = { "received", "sent" };
+		for (int d = 0; d < 2; ++d)
+		{
+			Tally const& total = datagrams[d];
+			std::cout << "\n" << names[d] << ": " << total.messages << " datagrams, " << total.bytes << " bytes, "
+				<< std::setprecision(1) << (double)total.bytes / duration << " B/s\n";
+			if (total.messages == 0) continue;
+			std::cout << "  " << std::left << std::setw(20) << "command" << std::right << std::setw(10) << "messages"
+				<< std::setw(12) << "bytes" << std::setw(8) << "share" << std::setw(12) << "B/s" << std::setw(10) << "avg" << "\n";
+			std::vector<std::pair<unsigned char, Tally>> rows{ messages[d].begin(), messages[d].end() };
+			std::sort(rows.begin(), rows.end(), [](auto const& a, auto const& b) { return a.second.bytes > b.second.bytes; });
+			for (auto const& [id, tally] : rows)
+			{
+				std::cout << "  " << std::left << std::setw(20) << CommandName(id) << std::right << std::setw(10) << tally.messages
+					<< std::setw(12) << tally.bytes << std::setw(7) << 100.0 * (double)tally.bytes / (double)total.bytes << "%"
+					<< std::setw(12) << (double)tally.bytes / duration
+					<< std::setw(10) << (tally.messages ? (double)tally.bytes / (double)tally.messages : 0.0) << "\n";
+			}
+		}
+		return 0;
+	}
+
+	//one original client during a replay
+	struct Client
+	{
+		std::unique_ptr<TRANSPORT::UdpTransport> transport;
+		unsigned int cookie{ 0 };		//the live server's, 0 until it challenged this client
+		unsigned int session{ 0 };
+		long long replies{ 0 };
+	};
+
+	//reads every reply waiting on the client's socket, remembering the cookie and session it is given
+	void ReadReplies(Client& client)
+	{
+		char buffer[MAX_DATAGRAM_SIZE];
+		sockaddr_in from{};
+		int received{};
+		while ((received = client.transport->RecvFrom(buffer, MAX_DATAGRAM_SIZE, from)) > 0)
+		{
+			++client.replies;
+			COALESCE::ForEach(buffer, received, [&](const char* data, int length)
+				{
+					if (length < MinimumSize((unsigned char)data[0])) return;
+					if ((unsigned char)data[0] == C_CHALLENGE) client.cookie = U32(data + 1);
+					else if ((unsigned char)data[0] == C_RSP_CONNECT) client.session = U32(data + 5);
+				});
+		}
+	}
+
+	std::unique_ptr<TRANSPORT::UdpTransport> OpenSocket()
+	{
+		SOCKET sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+		if (sock == INVALID_SOCKET) return nullptr;
+
+		sockaddr_in local{};
+		local.sin_family = AF_INET;
+		local.sin_addr.s_addr = INADDR_ANY;
+		local.sin_port = 0;
+		if (bind(sock, reinterpret_cast<sockaddr*>(&local), sizeof(local)) != NO_ERROR)
+		{
+			closesocket(sock);
+			return nullptr;
+		}
+		u_long enable = 1;
+		ioctlsocket(sock, FIONBIO, &enable);
+		return std::make_unique<TRANSPORT::UdpTransport>(sock);
+	}
+
+	//the cookie is a secret of the server process that was captured and the session was handed
+	//out by it, so a connect carries the live server's values instead wherever the original had one
+	void RewriteConnect(std::string& data, Client const& client)
+	{
+		if ((int)data.size() < MinimumSize(C_REQ_CONNECT) || (unsigned char)data[0] != C_REQ_CONNECT) return;
+		if (U32(data.data() + 1) != 0)
+		{
+			uint32_t cookie = htonl(client.cookie);
+			std::memcpy(&data[1], &cookie, 4);
+		}
+		if (U32(data.data() + 5) != 0)
+		{
+			uint32_t session = htonl(client.session);
+			std::memcpy(&data[5], &session, 4);
+		}
+	}
+
+	int Replay(std::string const& path, sockaddr_in const& server, double speed)
+	{
+		CAPTURE::Reader reader{};
+		if (!OpenCapture(path, reader)) return 1;
+
+		//a server capture has what it received, a client capture what it sent, from one client
+		bool serverCapture = reader.GetRole() == CAPTURE::R_SERVER;
+		CAPTURE::Direction toServer = serverCapture ? CAPTURE::D_IN : CAPTURE::D_OUT;
+		std::vector<CAPTURE::Record> records{};
+		CAPTURE::Record record{};
+		while (reader.Next(record))
+		{
+			if (record.direction == toServer && !record.data.empty()) records.push_back(record);
+		}
+		if (records.empty())
+		{
+			std::cerr << path << " has nothing that was sent to the server" << std::endl;
+			return 1;
+		}
+
+		std::map<unsigned long long, Client> clients{};
+		auto start = std::chrono::steady_clock::now();
+		auto Elapsed = [&start] { return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count(); };
+		auto ReadAll = [&clients]
+			{
+				for (auto& [key, client] : clients) ReadReplies(client);
+			};
+		auto WaitUntil = [&](double until, auto&& done)
+			{
+				while (Elapsed() < until && !done())
+				{
+					ReadAll();
+					std::this_thread::sleep_for(std::chrono::milliseconds(1));
+				}
+				ReadAll();
+			};
+
+		double offset = records.front().time;
+		long long sent{ 0 }, failed{ 0 };
+		for (CAPTURE::Record& r : records)
+		{
+			WaitUntil((r.time - offset) / speed, [] { return false; });
+
+			Client& client = clients[serverCapture ? Key(r.peer) : 0];
+			if (!client.transport && !(client.transport = OpenSocket()))
+			{
+				std::cerr << "could not open a socket" << std::endl;
+				return 1;
+			}
+			if ((unsigned char)r.data[0] == C_REQ_CONNECT && (int)r.data.size() >= MinimumSize(C_REQ_CONNECT))
+			{
+				if (U32(r.data.data() + 1) != 0 && client.cookie == 0)
+				{
+					WaitUntil(Elapsed() + COOKIE_WAIT, [&client] { return client.cookie != 0; });
+				}
+				RewriteConnect(r.data, client);
+			}
+			if (client.transport->SendTo(r.data.data(), (int)r.data.size(), server) == SOCKET_ERROR) ++failed;
+			else ++sent;
+		}
+		WaitUntil(Elapsed() + DRAIN_TIME, [] { return false; });
+
+		long long replies{ 0 };
+		for (auto const& [key, client] : clients) replies += client.replies;
+		std::cout << "replayed " << sent << " datagrams from " << clients.size() << " clients in " << std::fixed << std::setprecision(3)
+			<< Elapsed() << "s (" << failed << " failed), " << replies << " replies" << std::endl;
+		return 0;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	if (argc < 3)
+	{
+		Usage();
+		return 1;
+	}
+	std::string mode{ argv[1] };
+	std::string path{ argv[2] };
+	if (mode == "decode" && argc == 3) return Decode(path);
+	if (mode == "stats" && argc == 3) return Stats(path);
+	if (mode != "replay" || (argc != 5 && argc != 7))
+	{
+		Usage();
+		return 1;
+	}
+
+	sockaddr_in server{};
+	server.sin_family = AF_INET;
+	int port = std::atoi(argv[4]);
+	double speed{ 1.0 };
+	if (argc == 7)
+	{
+		speed = std::strcmp(argv[5], "--speed") == 0 ? std::atof(argv[6]) : 0.0;
+	}
+	if (inet_pton(AF_INET, argv[3], &server.sin_addr) != 1 || port <= 0 || port > 65535 || speed <= 0.0)
+	{
+		Usage();
+		return 1;
+	}
+	server.sin_port = htons((u_short)port);
+
+	WSADATA wsaData{};
+	int res = WSAStartup(MAKEWORD(2, 2), &wsaData);
+	if (res != NO_ERROR)
+	{
+		std::cerr << "WSAStartup failed with error: " << res << std::endl;
+		return 1;
+	}
+	int result = Replay(path, server, speed);
+	WSACleanup();
+	return result;
+}
@@ -0,0 +1,452 @@
+/*!
+\file		main_serverbench.cpp
+\author		darius (d.chan@digipen.edu)
+\co-author
+\par		Assignment 4
+\date		19/10/2026
+\brief
+end to end server tick benchmark. the real server code and headless bots
+run in one process over an in-memory network, on a simulated clock that is
+moved one frame at a time as fast as the machine allows. the server's
+receive, tick and send steps run one after the other on this thread, each
+one timed, so a match of traffic gives the ticks per second the server can
+sustain, where a tick's time goes, and what each client is sent.
+
+usage: ServerBench [--clients N] [--seconds S] [--rate HZ] [--seed N]
+                   [--link "latency_ms jitter_ms loss duplicate reorder bandwidth_kbps"]
+                   [--out file.json] [--profile] [--trace trace.json]
+                   [--hashes hashes.txt] [--replay hashes.txt]
+
+with --profile the server's zones are on as well and their histograms are
+printed at the end, zones nested in a phase add their own cost to it.
+--trace writes the measured ticks as a chrome trace timeline.
+--hashes runs the server in deterministic mode and writes the state hash
+after every tick of the match, two runs with the same options have to
+print the same final hash. --replay plays the match of such a file again
+from the inputs it logged, without bots or a network, and prints the first
+tick whose hash differs.
+
+Copyright (C) 2025 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the
+prior written consent of DigiPen Institute of Technology is prohibited.
+*/
+#include "bot.h"
+#include "server.h"
+#include "connection.h"
+#include "protocol.h"
+#include "profile.h"
+#include "trace.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <thread>
+
+#pragma comment(lib, "ws2_32.lib")
+
+namespace
+{
+	const float TICK = 1.f / 60.f;			//server frame and bot step, in simulated seconds
+	const double MAX_WARMUP = 30.0;			//simulated seconds the bots get to connect and start a match
+	const int MAX_CLIENTS = 4;				//server slots
+	const unsigned short SERVER_PORT = 9000;
+	const unsigned short CLIENT_PORT = 50000;	//first bot, the rest follow
+
+	struct Options
+	{
+		int clients;
+		double seconds;			//simulated match time measured
+		float rate;				//bot C_STATE_UPDATE per second
+		unsigned int seed;
+		TRANSPORT::Impairment link;
+		std::string out;
+		bool profile;			//server zones on, their percentiles printed after the run
+		std::string trace;		//chrome trace of the measured ticks, none when empty
+		std::string hashes;		//deterministic mode and its tick hashes, off when empty
+		std::string replay;		//a hashes file to play again instead of a run, none when empty
+	};
+
+	//what the server sent to one address
+	struct Traffic
+	{
+		long long packets{};
+		long long bytes{};
+	};
+
+	//the server's side of the network. counts what goes to each address and times every send,
+	//so time spent handing datagrams to the network can be told apart from building them
+	class MeteredTransport : public TRANSPORT::Transport
+	{
+	public:
+		explicit MeteredTransport(std::unique_ptr<TRANSPORT::Transport> inner) : _inner{ std::move(inner) }, _sendSeconds{ 0.0 }
+		{
+		}
+
+		int SendTo(const char* data, int length, sockaddr_in const& to) override
+		{
+			std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+			int sent = _inner->SendTo(data, length, to);
+			_sendSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+			if (sent != SOCKET_ERROR)
+			{
+				Traffic& traffic = _traffic[Key(to)];
+				++traffic.packets;
+				traffic.bytes += sent;
+			}
+			return sent;
+		}
+
+		int RecvFrom(char* buffer, int length, sockaddr_in& from) override
+		{
+			return _inner->RecvFrom(buffer, length, from);
+		}
+
+		double SendSeconds() const { return _sendSeconds; }
+
+		Traffic To(sockaddr_in const& addr) const
+		{
+			auto traffic = _traffic.find(Key(addr));
+			return traffic == _traffic.end() ? Traffic{} : traffic->second;
+		}
+
+		void Reset()
+		{
+			_traffic.clear();
+			_sendSeconds = 0.0;
+		}
+
+	private:
+		static unsigned long long Key(sockaddr_in const& addr)
+		{
+			return ((unsigned long long)addr.sin_addr.s_addr << 16) | addr.sin_port;
+		}
+
+		std::unique_ptr<TRANSPORT::Transport> _inner;
+		std::map<unsigned long long, Traffic> _traffic;
+		double _sendSeconds;
+	};
+
+	//seconds of server time per tick, summed over the run
+	struct Phases
+	{
+		double receive{};	//draining the network and handling every message, connections and matchmaking
+		double simulate{};
+		double collide{};
+		double encode{};	//building updates and flushing queued events, minus the sends themselves
+		double send{};		//inside the transport's SendTo, wherever it was called from
+
+		double Total() const { return receive + simulate + collide + encode + send; }
+	};
+
+	sockaddr_in Address(unsigned long host, unsigned short port)
+	{
+		sockaddr_in addr{};
+		addr.sin_family = AF_INET;
+		addr.sin_addr.s_addr = htonl(host);
+		addr.sin_port = htons(port);
+		return addr;
+	}
+
+	void Usage()
+	{
+		std::cerr << "usage: ServerBench [--clients N] [--seconds S] [--rate HZ] [--seed N]\n"
+			<< "                   [--link \"latency_ms jitter_ms loss duplicate reorder bandwidth_kbps\"]\n"
+			<< "                   [--out file.json] [--profile] [--trace trace.json]\n"
+			<< "                   [--hashes hashes.txt] [--replay hashes.txt]" << std::endl;
+	}
+
+	//false on anything it does not understand
+	bool ParseArgs(int argc, char* argv[], Options& options)
+	{
+		for (int i = 1; i < argc; ++i)
+		{
+			if (!std::strcmp(argv[i], "--profile"))
+			{
+				options.profile = true;
+				continue;
+			}
+			if (i + 1 >= argc) return false;
+			const char* opt = argv[i];
+			const char* val = argv[++i];
+			if (!std::strcmp(opt, "--clients")) options.clients = std::atoi(val);
+			else if (!std::strcmp(opt, "--seconds")) options.seconds = std::atof(val);
+			else if (!std::strcmp(opt, "--rate")) options.rate = (float)std::atof(val);
+			else if (!std::strcmp(opt, "--seed")) options.seed = (unsigned int)std::strtoul(val, nullptr, 10);
+			else if (!std::strcmp(opt, "--link"))
+			{
+				if (!TRANSPORT::ParseImpairment(val, options.link)) return false;
+			}
+			else if (!std::strcmp(opt, "--out")) options.out = val;
+			else if (!std::strcmp(opt, "--trace")) options.trace = val;
+			else if (!std::strcmp(opt, "--hashes")) options.hashes = val;
+			else if (!std::strcmp(opt, "--replay")) options.replay = val;
+			else return false;
+		}
+		return options.clients > 0 && options.clients <= MAX_CLIENTS && options.seconds > 0.0 && options.rate > 0.f;
+	}
+
+	//the match of a hashes file again, 0 if every tick hashed the same
+	int Replay(TRANSPORT::Transport& net, std::string const& path)
+	{
+		DETERMINISM::TickLog log{};
+		if (!log.Read(path))
+		{
+			std::cerr << "cannot read " << path << std::endl;
+			return 1;
+		}
+		deterministic = true;
+		int diverged = ReplayMatch(net, log);
+		if (diverged >= 0)
+		{
+			std::cout << "replay diverged at tick " << diverged << " of " << log.Ticks() << ", hash " << std::hex << matchLog.Hash((size_t)diverged)
+				<< " logged " << log.Hash((size_t)diverged) << std::dec << std::endl;
+			return 1;
+		}
+		std::cout << log.Ticks() << " ticks replayed, state hash " << std::hex << matchLog.Combined() << std::dec << std::endl;
+		return 0;
+	}
+
+	void WriteJson(std::ostream& os, Options const& options, long long ticks, Phases const& phases, double maxTick,
+		std::vector<Traffic> const& traffic)
+	{
+		std::time_t now = std::time(nullptr);
+		std::tm localTime{};
+		char date[32]{};
+		if (localtime_s(&localTime, &now) == 0)
+		{
+			std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", &localTime);
+		}
+
+		const double perTick = 1e9 / (double)ticks;
+		os << "{\n  \"context\": {\n"
+			<< "    \"date\": \"" << date << "\",\n"
+			<< "    \"num_cpus\": " << std::thread::hardware_concurrency() << ",\n"
+#ifdef _DEBUG
+			<< "    \"build_type\": \"debug\"\n"
+#else
+			<< "    \"build_type\": \"release\"\n"
+#endif
+			<< "  },\n  \"benchmarks\": [\n    {\n"
+			<< "      \"name\": \"ServerTick/" << options.clients << "\",\n"
+			<< "      \"iterations\": " << ticks << ",\n"
+			<< "      \"real_time\": " << std::setprecision(6) << phases.Total() * perTick << ",\n"
+			<< "      \"time_unit\": \"ns\",\n"
+			<< "      \"ticks_per_second\": " << (double)ticks / phases.Total() << ",\n"
+			<< "      \"max_tick_ns\": " << maxTick * 1e9 << ",\n"
+			<< "      \"receive_ns\": " << phases.receive * perTick << ",\n"
+			<< "      \"simulate_ns\": " << phases.simulate * perTick << ",\n"
+			<< "      \"collide_ns\": " << phases.collide * perTick << ",\n"
+			<< "      \"encode_ns\": " << phases.encode * perTick << ",\n"
+			<< "      \"send_ns\": " << phases.send * perTick << ",\n"
+			<< "      \"clients\": [";
+		for (size_t i = 0; i < traffic.size(); ++i)
+		{
+			os << (i ? ", " : "") << "{ \"packets_per_second\": " << (double)traffic[i].packets / options.seconds
+				<< ", \"bytes_per_second\": " << (double)traffic[i].bytes / options.seconds << " }";
+		}
+		os << "]\n    }\n  ]\n}\n";
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	Options options{ MAX_CLIENTS, 50.0, 30.f, 1, {}, "serverbench.json", false, "", "", "" };
+	if (!ParseArgs(argc, argv, options))
+	{
+		Usage();
+		return 1;
+	}
+
+	//every clock the server and the bots read is this one
+	double now = 0.0;
+	CONNECTION::SetClock([&now] { return now; });
+	PROFILE::SetEnabled(options.profile);
+	deterministic = !options.hashes.empty();
+
+	std::shared_ptr<TRANSPORT::Loopback> network = std::make_shared<TRANSPORT::Loopback>();
+	const sockaddr_in serverAddr = Address(0x7F000001, SERVER_PORT);
+	MeteredTransport net{ network->Bind(serverAddr) };
+	InitServer();
+
+	if (!options.replay.empty())
+	{
+		return Replay(net, options.replay);
+	}
+
+	BOT::Config config{};
+	config.server = serverAddr;
+	config.bots = options.clients;
+	config.threads = 1;
+	config.seconds = options.seconds;
+	config.link = options.link;
+	config.updateRate = options.rate;
+	config.mode = BOT::M_SCRIPTED;		//fires whenever it can, the heaviest a real client gets
+	config.seed = options.seed;
+
+	std::vector<std::unique_ptr<BOT::Bot>> bots{};
+	std::vector<sockaddr_in> botAddrs{};
+	for (int i = 0; i < options.clients; ++i)
+	{
+		botAddrs.push_back(Address(0x7F000001, (unsigned short)(CLIENT_PORT + i)));
+		bots.push_back(std::make_unique<BOT::Bot>(config, options.seed + (unsigned int)i));
+		bots.back()->Open(network->Bind(botAddrs.back()));
+	}
+	BOT::Stats botStats{};
+	BOT::Progress progress{};
+
+	FRAGMENT::Reassembler reassembler{};
+	std::string message{};
+	char buffer[MAX_DATAGRAM_SIZE];
+
+	using Clock = std::chrono::steady_clock;
+	Phases phases{};
+	double maxTick{};
+	long long ticks{};
+	const long long measuredTicks = std::llround(options.seconds / TICK);
+	bool measuring{ false };
+	Clock::time_point wallStart{};
+
+	while (ticks < measuredTicks)
+	{
+		now += TICK;
+		if (!measuring && has_started)
+		{
+			//connecting and the start of the match are not measured
+			measuring = true;
+			net.Reset();
+			PROFILE::Clear();
+			if (!options.trace.empty())
+			{
+				TRACE::Start("serverbench");
+			}
+			wallStart = Clock::now();
+		}
+		for (std::unique_ptr<BOT::Bot>& bot : bots)
+		{
+			bot->Tick(now, TICK, botStats, progress);
+		}
+
+		//what the receive thread does with everything that arrived since the last frame
+		double sendBefore = net.SendSeconds();
+		Clock::time_point start = Clock::now();
+		sockaddr_in from{};
+		int bytes{};
+		while ((bytes = net.RecvFrom(buffer, sizeof(buffer), from)) != SOCKET_ERROR)
+		{
+			HandleDatagram(net, reassembler, message, buffer, bytes, from);
+		}
+		Matchmake(net);
+		ExpireClients();
+		Clock::time_point received = Clock::now();
+		double sendReceived = net.SendSeconds();
+
+		if (!game_start)
+		{
+			if (!measuring && now > MAX_WARMUP)
+			{
+				std::cerr << "no match started after " << MAX_WARMUP << " simulated seconds, " << progress.connected
+					<< " of " << options.clients << " clients connected" << std::endl;
+				return 1;
+			}
+			continue;
+		}
+
+		//the main loop's frame, then the send thread's pass over the clients that are due
+		TickTimes times{};
+		ServerTick(net, TICK, &times);
+		Clock::time_point ticked = Clock::now();
+		if (!has_started)
+		{
+			SendGameStart(net);
+		}
+		else
+		{
+			SendUpdates(net);
+		}
+		Clock::time_point sent = Clock::now();
+		if (!measuring)
+		{
+			continue;
+		}
+
+		double receiveSend = sendReceived - sendBefore;
+		double tickSend = net.SendSeconds() - sendReceived;
+		phases.receive += std::chrono::duration<double>(received - start).count() - receiveSend;
+		phases.simulate += times.simulate;
+		phases.collide += times.collide;
+		phases.encode += times.flush + std::chrono::duration<double>(sent - ticked).count() - tickSend;
+		phases.send += receiveSend + tickSend;
+		maxTick = std::max(maxTick, std::chrono::duration<double>(sent - start).count());
+		++ticks;
+		if (options.profile)
+		{
+			//outside the timed phases, once a frame like the server's main loop
+			PROFILE::Collect();
+		}
+	}
+	double wall = std::chrono::duration<double>(Clock::now() - wallStart).count();
+	TRACE::Stop();
+
+	for (std::unique_ptr<BOT::Bot>& bot : bots)
+	{
+		bot->Close(botStats);
+	}
+	CONNECTION::SetClock(nullptr);
+
+	const double perTick = 1e6 / (double)ticks;
+	std::cout << "\n" << options.clients << " clients, " << ticks << " ticks (" << options.seconds << "s of match) in " << wall << "s\n"
+		<< "sustained " << (long long)((double)ticks / phases.Total()) << " ticks/s on server time, "
+		<< (long long)((double)ticks / wall) << " ticks/s with the bots\n"
+		<< std::fixed << std::setprecision(2)
+		<< "per tick (us): receive " << phases.receive * perTick << ", simulate " << phases.simulate * perTick
+		<< ", collide " << phases.collide * perTick << ", encode " << phases.encode * perTick << ", send " << phases.send * perTick
+		<< ", total " << phases.Total() * perTick << ", max " << maxTick * 1e6 << "\n";
+
+	std::vector<Traffic> traffic{};
+	for (int i = 0; i < options.clients; ++i)
+	{
+		traffic.push_back(net.To(botAddrs[i]));
+		std::cout << "client " << i << ": " << traffic.back().packets << " packets, " << traffic.back().bytes << " bytes out, "
+			<< std::setprecision(0) << (double)traffic.back().bytes / options.seconds << " B/s\n" << std::setprecision(2);
+	}
+	std::cout << "client rtt " << botStats.rtt.Summary() << std::defaultfloat << std::endl;
+	if (options.profile)
+	{
+		std::cout << "server zones\n" << PROFILE::Report();
+	}
+
+	std::ofstream file{ options.out };
+	if (!file)
+	{
+		std::cerr << "cannot write " << options.out << std::endl;
+		return 1;
+	}
+	WriteJson(file, options, ticks, phases, maxTick, traffic);
+	std::cout << "results written to " << options.out << std::endl;
+	if (!options.trace.empty())
+	{
+		if (!TRACE::Write(options.trace))
+		{
+			std::cerr << "cannot write " << options.trace << std::endl;
+			return 1;
+		}
+		std::cout << "trace written to " << options.trace << std::endl;
+	}
+	if (!options.hashes.empty())
+	{
+		std::cout << matchLog.Ticks() << " ticks, state hash " << std::hex << matchLog.Combined() << std::dec << std::endl;
+		if (!matchLog.Write(options.hashes))
+		{
+			std::cerr << "cannot write " << options.hashes << std::endl;
+			return 1;
+		}
+		std::cout << "tick hashes written to " << options.hashes << std::endl;
+	}
+	return 0;
+}
@@ -0,0 +1,87 @@
+/*!
+\file		coalesce.cpp
+\author		darius (d.chan@digipen.edu)
+\co-author
+\par		Assignment 4
+\date		19/10/2026
+\brief
+packs several small messages for the same peer into one C_BATCH datagram.
+
+Copyright (C) 2025 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the
+prior written consent of DigiPen Institute of Technology is prohibited.
+*/
+#include "coalesce.h"
+#include "fragment.h"
+
+namespace COALESCE
+{
+	namespace
+	{
+		//length is written big endian by hand so the header does not need winsock
+		void AppendEntry(std::string& batch, std::string const& message)
+		{
+			batch += (char)((message.size() >> 8) & 0xFF);
+			batch += (char)(message.size() & 0xFF);
+			batch += message;
+		}
+	}
+
+	Aggregator::Aggregator() : _batch{}, _first{}, _count{ 0 }
+	{
+	}
+
+	void Aggregator::Add(std::string const& message, std::vector<std::string>& ready)
+	{
+		const int mtu = FRAGMENT::MTU();
+		const int entrySize = LENGTH_SIZE + (int)message.size();
+
+		//would never fit next to anything else, keep the order and send it alone
+		if (HEADER_SIZE + entrySize > mtu)
+		{
+			Flush(ready);
+			ready.push_back(message);
+			return;
+		}
+
+		int batchSize = (_count == 0) ? HEADER_SIZE : (_count == 1 ? HEADER_SIZE + LENGTH_SIZE + (int)_first.size() : (int)_batch.size());
+		if (batchSize + entrySize > mtu)
+		{
+			Flush(ready);
+		}
+
+		if (_count == 0)
+		{
+			_first = message;
+		}
+		else
+		{
+			if (_count == 1)
+			{
+				_batch.clear();
+				_batch += C_BATCH;
+				AppendEntry(_batch, _first);
+			}
+			AppendEntry(_batch, message);
+		}
+		++_count;
+	}
+
+	void Aggregator::Flush(std::vector<std::string>& ready)
+	{
+		if (_count == 1)
+		{
+			ready.push_back(_first);
+		}
+		else if (_count > 1)
+		{
+			ready.push_back(_batch);
+		}
+		_count = 0;
+	}
+
+	bool Aggregator::Empty() const
+	{
+		return _count == 0;
+	}
+}
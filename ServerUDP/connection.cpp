@@ -0,0 +1,200 @@
+/*!
+\file		connection.cpp
+\author		darius (d.chan@digipen.edu)
+\co-author
+\par		Assignment 4
+\date		19/10/2026
+\brief
+connection state of every player slot, challenge cookies, timeouts and
+reconnecting into the same slot.
+
+Copyright (C) 2025 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the
+prior written consent of DigiPen Institute of Technology is prohibited.
+*/
+#include "connection.h"
+#include <chrono>
+#include <cmath>
+
+namespace CONNECTION
+{
+	namespace
+	{
+		//splitmix64 finaliser, cheap and good enough to make cookies unguessable with a secret key
+		unsigned long long Mix(unsigned long long x)
+		{
+			x += 0x9E3779B97F4A7C15ull;
+			x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+			x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+			return x ^ (x >> 31);
+		}
+
+		unsigned long long MakeSecret()
+		{
+			std::random_device rd{};
+			return ((unsigned long long)rd() << 32) | rd();
+		}
+
+		const unsigned long long secret{ MakeSecret() };
+
+		std::function<double()> clock{};
+
+		unsigned int CookieFor(unsigned long address, unsigned short port, long long window)
+		{
+			unsigned long long peer = ((unsigned long long)address << 16) | port;
+			unsigned int cookie = (unsigned int)Mix(secret ^ Mix(peer) ^ Mix((unsigned long long)window));
+			return cookie ? cookie : 1;		//0 means no cookie yet
+		}
+	}
+
+	double Now()
+	{
+		if (clock) return clock();
+		return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	void SetClock(std::function<double()> replacement)
+	{
+		clock = std::move(replacement);
+	}
+
+	unsigned int MakeCookie(unsigned long address, unsigned short port, double now)
+	{
+		return CookieFor(address, port, (long long)std::floor(now / COOKIE_LIFETIME));
+	}
+
+	bool CheckCookie(unsigned int cookie, unsigned long address, unsigned short port, double now)
+	{
+		if (cookie == 0) return false;
+		long long window = (long long)std::floor(now / COOKIE_LIFETIME);
+		return cookie == CookieFor(address, port, window) || cookie == CookieFor(address, port, window - 1);
+	}
+
+	SlotTable::SlotTable(int capacity) : _slots((size_t)capacity, { S_FREE, {}, 0, 0.0 }), _free{}, _rng{ std::random_device{}() }
+	{
+		for (int i = capacity - 1; i >= 0; --i)
+		{
+			_free.push_back(i);
+		}
+	}
+
+	int SlotTable::Find(std::string const& ipPort) const
+	{
+		for (size_t i = 0; i < _slots.size(); ++i)
+		{
+			if (_slots[i].state == S_CONNECTED && _slots[i].ipPort == ipPort) return (int)i;
+		}
+		return -1;
+	}
+
+	int SlotTable::Acquire(std::string const& ipPort, unsigned int session, double now, bool& resumed)
+	{
+		resumed = false;
+		int index{ -1 };
+
+		//same session, possibly from a new address. a connected slot is never handed over,
+		//otherwise anyone who learnt the session could take the player from its client
+		if (session != 0)
+		{
+			for (size_t i = 0; i < _slots.size(); ++i)
+			{
+				if (_slots[i].state == S_LINGERING && _slots[i].session == session)
+				{
+					index = (int)i;
+					resumed = true;
+					break;
+				}
+			}
+		}
+
+		if (index < 0 && !_free.empty())
+		{
+			index = _free.back();
+			_free.pop_back();
+		}
+
+		//no free slot, the one dropped the longest ago gives way
+		if (index < 0)
+		{
+			for (size_t i = 0; i < _slots.size(); ++i)
+			{
+				if (_slots[i].state == S_LINGERING && (index < 0 || _slots[i].lastHeard < _slots[index].lastHeard))
+				{
+					index = (int)i;
+				}
+			}
+			if (index < 0) return -1;
+		}
+
+		Slot& slot = _slots[index];
+		if (!resumed)
+		{
+			do
+			{
+				slot.session = _rng();
+			} while (slot.session == 0);
+		}
+		slot.state = S_CONNECTED;
+		slot.ipPort = ipPort;
+		slot.lastHeard = now;
+		return index;
+	}
+
+	void SlotTable::Touch(int index, double now)
+	{
+		_slots[index].lastHeard = now;
+	}
+
+	void SlotTable::Release(int index, double now, bool linger)
+	{
+		Slot& slot = _slots[index];
+		if (slot.state == S_FREE) return;
+		slot.ipPort.clear();
+		slot.lastHeard = now;
+		if (linger)
+		{
+			slot.state = S_LINGERING;
+			return;
+		}
+		slot.state = S_FREE;
+		slot.session = 0;
+		_free.push_back(index);
+	}
+
+	void SlotTable::Expire(double now, std::vector<int>& expired)
+	{
+		for (size_t i = 0; i < _slots.size(); ++i)
+		{
+			Slot& slot = _slots[i];
+			if (slot.state == S_CONNECTED && now - slot.lastHeard > TIMEOUT)
+			{
+				Release((int)i, now, true);
+				expired.push_back((int)i);
+			}
+			else if (slot.state == S_LINGERING && now - slot.lastHeard > RECONNECT_WINDOW)
+			{
+				Release((int)i, now, false);
+			}
+		}
+	}
+
+	unsigned int SlotTable::Session(int index) const
+	{
+		return _slots[index].session;
+	}
+
+	std::string const& SlotTable::IpPort(int index) const
+	{
+		return _slots[index].ipPort;
+	}
+
+	int SlotTable::Connected() const
+	{
+		int count{};
+		for (Slot const& slot : _slots)
+		{
+			if (slot.state == S_CONNECTED) ++count;
+		}
+		return count;
+	}
+}
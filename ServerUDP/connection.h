@@ -0,0 +1,88 @@
+/*!
+\file		connection.h
+\author		darius (d.chan@digipen.edu)
+\co-author
+\par		Assignment 4
+\date		19/10/2026
+\brief
+connection state of every player slot. a client has to echo a cookie from
+a C_CHALLENGE before it is given a slot, so spoofed addresses cannot use
+the slots up. silent clients are timed out and their slot is held for a
+while so the same session can reconnect into it.
+
+Copyright (C) 2025 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the
+prior written consent of DigiPen Institute of Technology is prohibited.
+*/
+#pragma once
+#include <functional>
+#include <string>
+#include <vector>
+#include <random>
+
+namespace CONNECTION
+{
+	const double TIMEOUT = 5.0;				//seconds of silence before a client is dropped
+	const double RECONNECT_WINDOW = 30.0;	//seconds a dropped slot is held for its session
+	const double COOKIE_LIFETIME = 10.0;	//cookies rotate this often, the previous one is still accepted
+	const double SWEEP_INTERVAL = 0.25;		//seconds between timeout checks
+
+	//seconds on a steady clock, connections are timed even while no game is running
+	double Now();
+
+	//replaces the clock behind Now, for driving the server faster than real time. nullptr goes
+	//back to the steady clock. set it before any thread calls Now
+	void SetClock(std::function<double()> clock);
+
+	//nothing is stored for an address until it echoes a cookie made here
+	unsigned int MakeCookie(unsigned long address, unsigned short port, double now);
+	bool CheckCookie(unsigned int cookie, unsigned long address, unsigned short port, double now);
+
+	class SlotTable
+	{
+	public:
+		explicit SlotTable(int capacity);
+
+		//slot connected from ipPort, -1 if none
+		int Find(std::string const& ipPort) const;
+
+		//gives ipPort a slot: the one lingering for session if there is one, otherwise a free one,
+		//otherwise the one dropped the longest ago. resumed is set when the session got its old slot back.
+		//a session whose slot is still connected gets a new slot. returns -1 when every slot is connected
+		int Acquire(std::string const& ipPort, unsigned int session, double now, bool& resumed);
+
+		//anything heard from the slot's client
+		void Touch(int index, double now);
+
+		//client left, a slot that lingers can still be resumed by its session
+		void Release(int index, double now, bool linger);
+
+		//drops connected slots that have been silent for longer than TIMEOUT and
+		//frees lingering ones past RECONNECT_WINDOW. the dropped slots are added to expired
+		void Expire(double now, std::vector<int>& expired);
+
+		unsigned int Session(int index) const;
+		std::string const& IpPort(int index) const;
+		int Connected() const;
+
+	private:
+		enum State
+		{
+			S_FREE,
+			S_CONNECTED,
+			S_LINGERING
+		};
+
+		struct Slot
+		{
+			State state;
+			std::string ipPort;
+			unsigned int session;
+			double lastHeard;	//or when it started lingering
+		};
+
+		std::vector<Slot> _slots;
+		std::vector<int> _free;		//indices of free slots, taken from the back
+		std::mt19937 _rng;
+	};
+}
@@ -0,0 +1,109 @@
+/*!
+\file		contention.h
+\author		darius (d.chan@digipen.edu)
+\co-author
+\par		Assignment 4
+\date		19/10/2026
+\brief
+a mutex that keeps track of who locks it. every CONTENTION::Lock remembers
+the file, line and function it was taken at, and while profiling is on
+each of those sites counts its acquisitions, how many of them found the
+mutex taken, how long they waited for it and how long they held it.
+Report lists every profiled mutex with the sites that waited the longest.
+while a site holds the mutex nothing else can touch its numbers, so they
+need no atomics or locks of their own. with profiling off a Lock costs one
+relaxed atomic load over a plain lock.
+
+Copyright (C) 2025 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the
+prior written consent of DigiPen Institute of Technology is prohibited.
+*/
+#pragma once
+#include <atomic>
+#include <mutex>
+#include <source_location>
+#include <string>
+#include <vector>
+
+namespace CONTENTION
+{
+	const int REPORT_SITES = 5;		//sites listed per mutex, the ones that waited the longest
+
+	extern std::atomic<bool> enabled;
+
+	inline bool Enabled()
+	{
+		return enabled.load(std::memory_order_relaxed);
+	}
+
+	void SetEnabled(bool on);
+
+	//what one call site did with one mutex, times in nanoseconds
+	struct SiteStats
+	{
+		const char* file;
+		unsigned line;
+		const char* function;
+		long long acquisitions;
+		long long contended;	//found the mutex taken and had to wait
+		long long waited;
+		long long maxWait;
+		long long held;
+		long long maxHold;
+	};
+
+	class ProfiledMutex
+	{
+	public:
+		explicit ProfiledMutex(const char* name);
+		~ProfiledMutex();
+		ProfiledMutex(ProfiledMutex const&) = delete;
+		ProfiledMutex& operator=(ProfiledMutex const&) = delete;
+
+		void lock(std::source_location const& site = std::source_location::current());
+		void unlock();
+
+		const char* Name() const { return _name; }
+
+		//every site so far, copied under the lock
+		std::vector<SiteStats> Sites();
+		void Clear();
+
+	private:
+		SiteStats& Site(std::source_location const& site);
+
+		const char* _name;
+		std::string _waitName;		//trace event for waiting on it
+		std::mutex _mutex;
+		std::vector<SiteStats> _sites;	//only touched while _mutex is held
+		SiteStats* _owner;				//site holding the mutex if it was profiled when it took it
+		long long _acquiredAt;
+	};
+
+	//like std::lock_guard, and the place it is constructed is the site the time is counted against
+	class Lock
+	{
+	public:
+		explicit Lock(ProfiledMutex& mutex, std::source_location const& site = std::source_location::current()) : _mutex{ mutex }
+		{
+			_mutex.lock(site);
+		}
+
+		~Lock()
+		{
+			_mutex.unlock();
+		}
+
+		Lock(Lock const&) = delete;
+		Lock& operator=(Lock const&) = delete;
+
+	private:
+		ProfiledMutex& _mutex;
+	};
+
+	//every profiled mutex, the most waited on first, with its worst sites. times in microseconds
+	std::string Report();
+
+	//starts every mutex's numbers over
+	void Clear();
+}
@@ -0,0 +1,236 @@
+/*!
+\file		determinism.cpp
+\author		darius (d.chan@digipen.edu)
+\co-author
+\par		Assignment 4
+\date		19/10/2026
+\brief
+input ordering, the state hash and the per tick log of deterministic mode.
+
+Copyright (C) 2025 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the
+prior written consent of DigiPen Institute of Technology is prohibited.
+*/
+#include "determinism.h"
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iterator>
+#include <sstream>
+
+namespace DETERMINISM
+{
+	namespace
+	{
+		const unsigned long long FNV_OFFSET = 14695981039346656037ull;
+		const unsigned long long FNV_PRIME = 1099511628211ull;
+
+		//how each kind is written in the log, in InputKind order
+		const char* const KIND_NAMES[] = { "state", "fire", "connect", "resume", "join", "leave", "quit" };
+
+		//"x,y" of a log line
+		bool ReadPair(const char* text, AEVec2& value)
+		{
+			char* end{};
+			value.x = std::strtof(text, &end);
+			if (*end != ',') return false;
+			value.y = std::strtof(end + 1, &end);
+			return *end == '\0';
+		}
+
+		//"  p<player> t=<time> <kind> <field>=<value>..." as Write puts it
+		bool ReadInput(std::string const& line, Input& input)
+		{
+			std::istringstream in{ line };
+			std::string player{}, time{}, kind{}, field{};
+			if (!(in >> player >> time >> kind) || player[0] != 'p' || time.compare(0, 2, "t=") != 0)
+			{
+				return false;
+			}
+			input = Input{};
+			input.player = std::atoi(player.c_str() + 1);
+			input.timestamp = std::strtof(time.c_str() + 2, nullptr);
+			const char* const* name = std::find(std::begin(KIND_NAMES), std::end(KIND_NAMES), kind);
+			if (name == std::end(KIND_NAMES))
+			{
+				return false;
+			}
+			input.kind = (InputKind)(name - std::begin(KIND_NAMES));
+
+			while (in >> field)
+			{
+				size_t equals = field.find('=');
+				if (equals == std::string::npos) return false;
+				std::string key = field.substr(0, equals);
+				const char* value = field.c_str() + equals + 1;
+				bool ok{ true };
+				if (key == "seq") input.seq = (unsigned int)std::strtoul(value, nullptr, 10);
+				else if (key == "pos") ok = ReadPair(value, input.t.pos);
+				else if (key == "scale") ok = ReadPair(value, input.t.scale);
+				else if (key == "rot") input.t.rot = std::strtof(value, nullptr);
+				else if (key == "vel") ok = ReadPair(value, input.vel);
+				else ok = false;
+				if (!ok) return false;
+			}
+			return true;
+		}
+	}
+
+	void Order(std::vector<Input>& inputs)
+	{
+		//seq breaks the last tie, two fire frames of one player never share it.
+		//events of one player are equal to each other, stable keeps them as they happened
+		std::stable_sort(inputs.begin(), inputs.end(), [](Input const& a, Input const& b)
+			{
+				if (a.player != b.player) return a.player < b.player;
+				if (IsEvent(a.kind) || IsEvent(b.kind)) return IsEvent(a.kind) && !IsEvent(b.kind);
+				if (a.timestamp != b.timestamp) return a.timestamp < b.timestamp;
+				if (a.kind != b.kind) return a.kind < b.kind;
+				return a.seq < b.seq;
+			});
+	}
+
+	StateHash::StateHash() : _value{ FNV_OFFSET }
+	{
+	}
+
+	void StateHash::Add(const void* data, size_t size)
+	{
+		const unsigned char* bytes = static_cast<const unsigned char*>(data);
+		for (size_t i = 0; i < size; ++i)
+		{
+			_value = (_value ^ bytes[i]) * FNV_PRIME;
+		}
+	}
+
+	void StateHash::Add(float value)
+	{
+		Add(&value, sizeof(value));
+	}
+
+	void StateHash::Add(int value)
+	{
+		Add(&value, sizeof(value));
+	}
+
+	void StateHash::Add(unsigned int value)
+	{
+		Add(&value, sizeof(value));
+	}
+
+	void StateHash::Add(bool value)
+	{
+		unsigned char byte = value ? 1 : 0;
+		Add(&byte, 1);
+	}
+
+	//field by field, the padding of the struct is never hashed
+	void StateHash::Add(GameObject const& go)
+	{
+		Add(go.isActive);
+		Add(go.t.pos.x);
+		Add(go.t.pos.y);
+		Add(go.t.scale.x);
+		Add(go.t.scale.y);
+		Add(go.t.rot);
+		Add(go.vel.x);
+		Add(go.vel.y);
+	}
+
+	void TickLog::Add(unsigned long long hash, std::vector<Input> const& inputs)
+	{
+		_hashes.push_back(hash);
+		_firstInput.push_back(_inputs.size());
+		_inputs.insert(_inputs.end(), inputs.begin(), inputs.end());
+	}
+
+	void TickLog::Clear()
+	{
+		_hashes.clear();
+		_firstInput.clear();
+		_inputs.clear();
+	}
+
+	void TickLog::Inputs(size_t tick, std::vector<Input>& inputs) const
+	{
+		size_t end = tick + 1 < _firstInput.size() ? _firstInput[tick + 1] : _inputs.size();
+		inputs.assign(_inputs.begin() + _firstInput[tick], _inputs.begin() + end);
+	}
+
+	unsigned long long TickLog::Combined() const
+	{
+		StateHash combined{};
+		combined.Add(_hashes.data(), _hashes.size() * sizeof(unsigned long long));
+		return combined.Value();
+	}
+
+	bool TickLog::Write(std::string const& path) const
+	{
+		std::ofstream file{ path };
+		if (!file)
+		{
+			return false;
+		}
+		file << std::hexfloat;
+		for (size_t tick = 0; tick < _hashes.size(); ++tick)
+		{
+			file << tick << " " << std::hex << std::setw(16) << std::setfill('0') << _hashes[tick] << std::dec << "\n";
+			size_t end = tick + 1 < _firstInput.size() ? _firstInput[tick + 1] : _inputs.size();
+			for (size_t i = _firstInput[tick]; i < end; ++i)
+			{
+				Input const& in = _inputs[i];
+				file << "  p" << in.player << " t=" << in.timestamp << " " << KIND_NAMES[in.kind];
+				if (in.kind != I_STATE)
+				{
+					file << " seq=" << in.seq << "\n";
+				}
+				else
+				{
+					file << " pos=" << in.t.pos.x << "," << in.t.pos.y << " scale=" << in.t.scale.x << "," << in.t.scale.y << " rot=" << in.t.rot
+						<< " vel=" << in.vel.x << "," << in.vel.y << "\n";
+				}
+			}
+		}
+		return (bool)file;
+	}
+
+	bool TickLog::Read(std::string const& path)
+	{
+		std::ifstream file{ path };
+		if (!file)
+		{
+			return false;
+		}
+		Clear();
+		std::string line{};
+		while (std::getline(file, line))
+		{
+			if (line.empty())
+			{
+				continue;
+			}
+			//inputs are indented under the tick that applied them
+			if (line[0] == ' ')
+			{
+				Input input{};
+				if (_hashes.empty() || !ReadInput(line, input))
+				{
+					return false;
+				}
+				_inputs.push_back(input);
+				continue;
+			}
+			std::istringstream in{ line };
+			size_t tick{};
+			unsigned long long hash{};
+			if (!(in >> tick >> std::hex >> hash) || tick != _hashes.size())
+			{
+				return false;
+			}
+			_hashes.push_back(hash);
+			_firstInput.push_back(_inputs.size());
+		}
+		return true;
+	}
+}
@@ -0,0 +1,107 @@
+/*!
+\file		determinism.h
+\author		darius (d.chan@digipen.edu)
+\co-author
+\par		Assignment 4
+\date		19/10/2026
+\brief
+pieces of the server's deterministic mode. client inputs are held until
+the next tick and applied there in a fixed order, and after every tick
+the whole simulation is hashed. a match then only depends on the inputs
+each tick applied, so two runs given the same inputs hash the same at
+every tick, and the first tick whose hash differs is where they diverged.
+
+players connecting, leaving or joining the match between ticks change the
+simulation as well, so those go through the tick as inputs too. the log of
+a match has one line per tick, "tick hash", followed by the inputs that
+tick applied. floats are written in hex so nothing is lost, and a log read
+back has everything needed to play its match again.
+
+Copyright (C) 2025 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the
+prior written consent of DigiPen Institute of Technology is prohibited.
+*/
+#pragma once
+#include "gameobject.h"
+#include <string>
+#include <vector>
+
+namespace DETERMINISM
+{
+	enum InputKind : unsigned char
+	{
+		I_STATE = 0,	//a C_STATE_UPDATE that passed validation
+		I_FIRE = 1,		//a fire input frame not applied before
+		I_CONNECT = 2,	//a new connection took the player's slot
+		I_RESUME = 3,	//the player's connection came back
+		I_JOIN = 4,		//the player went into the match
+		I_LEAVE = 5,	//the player's connection went away
+		I_QUIT = 6		//the player left the match
+	};
+
+	//state and fire are what a client sent, everything after them happens to a player
+	inline bool IsEvent(InputKind kind) { return kind > I_FIRE; }
+
+	//one client input waiting for the tick that applies it
+	struct Input
+	{
+		InputKind kind;
+		int player;
+		float timestamp;	//client time it was made at, server time for an event
+		unsigned int seq;	//input frame seq of a fire, newest seq applied for a join, 0 otherwise
+		Transform t;		//state only
+		AEVec2 vel;			//state only
+	};
+
+	//the order a tick applies its inputs in: by player, the player's events first in the order
+	//they happened, then by when the client made them, a state before a fire made at the same time.
+	//arrival order never matters
+	void Order(std::vector<Input>& inputs);
+
+	//64 bit fnv-1a over the exact bits of what is added, floats included
+	class StateHash
+	{
+	public:
+		StateHash();
+
+		void Add(const void* data, size_t size);
+		void Add(float value);
+		void Add(int value);
+		void Add(unsigned int value);
+		void Add(bool value);
+		void Add(GameObject const& go);
+
+		unsigned long long Value() const { return _value; }
+
+	private:
+		unsigned long long _value;
+	};
+
+	//the hash after every tick of a match and the inputs the tick applied
+	class TickLog
+	{
+	public:
+		void Add(unsigned long long hash, std::vector<Input> const& inputs);
+		void Clear();
+
+		size_t Ticks() const { return _hashes.size(); }
+		unsigned long long Hash(size_t tick) const { return _hashes[tick]; }
+
+		//replaces inputs with the ones tick applied
+		void Inputs(size_t tick, std::vector<Input>& inputs) const;
+
+		//hash of every tick hash so far, equal for two matches only if every tick was
+		unsigned long long Combined() const;
+
+		//false if the file could not be written
+		bool Write(std::string const& path) const;
+
+		//a log written by Write, false if the file could not be read or is not one
+		bool Read(std::string const& path);
+
+	private:
+		std::vector<unsigned long long> _hashes;
+		std::vector<size_t> _firstInput;	//index in _inputs of each tick's first input
+		std::vector<Input> _inputs;
+	};
+}
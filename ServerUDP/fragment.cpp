@@ -0,0 +1,159 @@
+/*!
+\file		fragment.cpp
+\author		darius (d.chan@digipen.edu)
+\co-author
+\par		Assignment 4
+\date		19/10/2026
+\brief
+splits messages larger than the mtu into numbered C_FRAGMENT datagrams and
+puts them back together on the other side.
+
+Copyright (C) 2025 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the
+prior written consent of DigiPen Institute of Technology is prohibited.
+*/
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+
+#include "Windows.h"
+#include "winsock2.h"	// htons, ntohs
+
+#include "fragment.h"
+#include "protocol.h"
+#include <atomic>
+
+namespace FRAGMENT
+{
+	namespace
+	{
+		std::atomic<int> mtu{ DEFAULT_MTU };
+		std::atomic<unsigned short> nextMessageId{};
+	}
+
+	void SetMTU(int newMtu)
+	{
+		if (newMtu < HEADER_SIZE + 1) newMtu = HEADER_SIZE + 1;
+		if (newMtu > MAX_DATAGRAM_SIZE) newMtu = MAX_DATAGRAM_SIZE;
+		mtu = newMtu;
+	}
+
+	int MTU()
+	{
+		return mtu;
+	}
+
+	std::vector<std::string> Split(std::string const& message)
+	{
+		const int size = mtu;
+		if ((int)message.size() <= size) return { message };
+
+		const int fragmentSize = size - HEADER_SIZE;
+		int count = ((int)message.size() + fragmentSize - 1) / fragmentSize;
+		if (count > MAX_FRAGMENTS) return {};	//too big to ever be reassembled
+
+		unsigned short messageId = htons(nextMessageId++);
+		unsigned short netFragmentSize = htons((unsigned short)fragmentSize);
+
+		std::vector<std::string> fragments((size_t)count);
+		for (int i = 0; i < count; ++i)
+		{
+			std::string& f = fragments[i];
+			f.reserve(size);
+			f += C_FRAGMENT;
+			f.append((char*)(&messageId), (char*)(&messageId) + 2);
+			f += (char)i;
+			f += (char)count;
+			f.append((char*)(&netFragmentSize), (char*)(&netFragmentSize) + 2);
+			f.append(message, (size_t)i * fragmentSize, (size_t)fragmentSize);
+		}
+		return fragments;
+	}
+
+	Reassembler::Reassembler() : _pending{}
+	{
+	}
+
+	Reassembler::Pending* Reassembler::Find(unsigned long long peer, unsigned short messageId, float now)
+	{
+		Pending* oldest{ &_pending[0] };
+		Pending* unused{};
+		for (Pending& p : _pending)
+		{
+			if (!p.inUse)
+			{
+				if (!unused) unused = &p;
+				continue;
+			}
+			if (p.peer == peer && p.messageId == messageId) return &p;
+			if (p.firstSeen < oldest->firstSeen) oldest = &p;
+		}
+
+		//all slots busy, the oldest message gives way
+		Pending* p = unused ? unused : oldest;
+		p->inUse = true;
+		p->peer = peer;
+		p->messageId = messageId;
+		p->count = 0;
+		p->received = 0;
+		p->lastSize = -1;
+		p->firstSeen = now;
+		p->data.clear();
+		return p;
+	}
+
+	bool Reassembler::Add(unsigned long long peer, const char* buffer, int length, float now, std::string& message)
+	{
+		if (length <= HEADER_SIZE) return false;
+		Evict(now);
+
+		unsigned short messageId = ntohs(*(unsigned short*)(buffer + 1));
+		int index = (unsigned char)buffer[3];
+		int count = (unsigned char)buffer[4];
+		int fragmentSize = ntohs(*(unsigned short*)(buffer + 5));
+		int payload = length - HEADER_SIZE;
+
+		//reject anything that could not have come from Split, this also bounds the memory per message
+		if (count < 2 || count > MAX_FRAGMENTS || index >= count) return false;
+		if (fragmentSize == 0 || fragmentSize > MAX_DATAGRAM_SIZE - HEADER_SIZE) return false;
+		if (index < count - 1 ? payload != fragmentSize : payload > fragmentSize) return false;
+
+		Pending* p = Find(peer, messageId, now);
+		if (p->count == 0)
+		{
+			p->count = (unsigned char)count;
+			p->fragmentSize = (unsigned short)fragmentSize;
+			p->data.resize((size_t)count * fragmentSize);
+		}
+		else if (p->count != count || p->fragmentSize != fragmentSize)
+		{
+			p->inUse = false;	//inconsistent with earlier fragments
+			return false;
+		}
+
+		unsigned long long bit = 1ull << index;
+		if (p->received & bit) return false;	//duplicate
+		p->received |= bit;
+		std::copy(buffer + HEADER_SIZE, buffer + length, p->data.begin() + (size_t)index * fragmentSize);
+		if (index == count - 1) p->lastSize = payload;
+
+		unsigned long long all = (count == 64) ? ~0ull : (1ull << count) - 1;
+		if (p->received != all) return false;
+
+		p->data.resize((size_t)(count - 1) * fragmentSize + p->lastSize);
+		message.swap(p->data);
+		p->inUse = false;
+		return true;
+	}
+
+	void Reassembler::Evict(float now)
+	{
+		for (Pending& p : _pending)
+		{
+			if (p.inUse && now - p.firstSeen > REASSEMBLY_TIMEOUT)
+			{
+				p.inUse = false;
+			}
+		}
+	}
+}
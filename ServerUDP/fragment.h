@@ -0,0 +1,69 @@
+/*!
+\file		fragment.h
+\author		darius (d.chan@digipen.edu)
+\co-author
+\par		Assignment 4
+\date		19/10/2026
+\brief
+splits messages larger than the mtu into numbered C_FRAGMENT datagrams and
+puts them back together on the other side. reassembly memory is bounded:
+only a few messages can be in flight at once and incomplete ones are
+dropped after a timeout.
+
+Copyright (C) 2025 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the
+prior written consent of DigiPen Institute of Technology is prohibited.
+*/
+#pragma once
+#include <string>
+#include <vector>
+#include <array>
+
+namespace FRAGMENT
+{
+	const int HEADER_SIZE = 1 + 2 + 1 + 1 + 2;	//id, message id, fragment index, fragment count, fragment size
+	const int DEFAULT_MTU = 1200;
+	const int MAX_FRAGMENTS = 64;
+	const int MAX_PENDING = 16;					//messages reassembled at the same time
+	const float REASSEMBLY_TIMEOUT = 1.f;		//seconds before an incomplete message is dropped
+
+	//largest datagram Split will produce, must not be above MAX_DATAGRAM_SIZE
+	void SetMTU(int mtu);
+	int MTU();
+
+	//splits message into C_FRAGMENT datagrams no larger than the mtu.
+	//a message that already fits is returned as the only element, unchanged
+	std::vector<std::string> Split(std::string const& message);
+
+	//collects C_FRAGMENT datagrams until a whole message is there
+	class Reassembler
+	{
+	public:
+		Reassembler();
+
+		//peer identifies the sender so fragments of different peers never mix.
+		//returns true and fills message when this fragment completes one
+		bool Add(unsigned long long peer, const char* buffer, int length, float now, std::string& message);
+
+		//drops messages that have waited longer than REASSEMBLY_TIMEOUT, also done by Add
+		void Evict(float now);
+
+	private:
+		struct Pending
+		{
+			bool inUse;
+			unsigned long long peer;
+			unsigned short messageId;
+			unsigned char count;
+			unsigned short fragmentSize;
+			unsigned long long received;	//bit per fragment index
+			int lastSize;					//size of the last fragment, -1 until it arrives
+			float firstSeen;
+			std::string data;
+		};
+
+		Pending* Find(unsigned long long peer, unsigned short messageId, float now);
+
+		std::array<Pending, MAX_PENDING> _pending;
+	};
+}
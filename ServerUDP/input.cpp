@@ -0,0 +1,119 @@
+/*!
+\file		input.cpp
+\author		darius (d.chan@digipen.edu)
+\co-author
+\par		Assignment 4
+\date		19/10/2026
+\brief
+redundant input frames.
+
+Copyright (C) 2025 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the
+prior written consent of DigiPen Institute of Technology is prohibited.
+*/
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+
+#include "Windows.h"
+#include "winsock2.h"	// htonf, htonl
+
+#include "input.h"
+#include <algorithm>
+
+namespace INPUTFRAME
+{
+	History::History() : _frames{}, _head{ 0 }, _count{ 0 }, _nextSeq{ 1 }
+	{
+	}
+
+	unsigned int History::Push(float timestamp, unsigned char flags)
+	{
+		_frames[_head] = { _nextSeq, timestamp, flags };
+		_head = (_head + 1) % REDUNDANCY;
+		_count = std::min(_count + 1, REDUNDANCY);
+		return _nextSeq++;
+	}
+
+	void History::Append(std::string& packet, float now) const
+	{
+		size_t countAt = packet.size();
+		packet += (char)0;
+
+		unsigned char count{};
+		for (int i = _count; i > 0; --i)
+		{
+			Frame const& f = _frames[(_head - i + REDUNDANCY) % REDUNDANCY];
+			if (now - f.timestamp > WINDOW) continue;
+
+			unsigned int tmp = htonl(f.seq);
+			packet.append((char*)(&tmp), (char*)(&tmp) + 4);
+			tmp = htonf(f.timestamp);
+			packet.append((char*)(&tmp), (char*)(&tmp) + 4);
+			packet += (char)f.flags;
+			++count;
+		}
+		packet[countAt] = (char)count;
+	}
+
+	void History::Clear()
+	{
+		_head = 0;
+		_count = 0;
+	}
+
+	int Read(const char* buffer, int length, std::vector<Frame>& frames)
+	{
+		frames.clear();
+		if (length < COUNT_SIZE) return -1;
+
+		int count = (unsigned char)buffer[0];
+		int size = COUNT_SIZE + count * FRAME_SIZE;
+		if (length < size) return -1;
+
+		for (int i = 0; i < count; ++i)
+		{
+			const char* frame = buffer + COUNT_SIZE + i * FRAME_SIZE;
+			Frame f{};
+			f.seq = ntohl(*(uint32_t*)(frame));
+			f.timestamp = ntohf(*(uint32_t*)(frame + 4));
+			f.flags = (unsigned char)frame[8];
+			frames.push_back(f);
+		}
+		return size;
+	}
+
+	Receiver::Receiver() : _lastSeq{ 0 }
+	{
+	}
+
+	void Receiver::Accept(std::vector<Frame> const& frames, std::vector<Frame>& fresh)
+	{
+		fresh.clear();
+		//the client writes oldest first, anything out of order is garbage and is skipped
+		for (Frame const& f : frames)
+		{
+			if (f.seq <= _lastSeq) continue;
+			if (!fresh.empty() && f.seq <= fresh.back().seq) continue;
+			fresh.push_back(f);
+		}
+		if (!fresh.empty()) _lastSeq = fresh.back().seq;
+	}
+
+	bool Receiver::Accept(unsigned int seq)
+	{
+		if (seq <= _lastSeq) return false;
+		_lastSeq = seq;
+		return true;
+	}
+
+	void Receiver::Reset()
+	{
+		_lastSeq = 0;
+	}
+
+	void Receiver::Restore(unsigned int lastSeq)
+	{
+		_lastSeq = lastSeq;
+	}
+}
@@ -0,0 +1,91 @@
+/*!
+\file		input.h
+\author		darius (d.chan@digipen.edu)
+\co-author
+\par		Assignment 4
+\date		19/10/2026
+\brief
+redundant input frames. every client packet carries the client's last few
+sequence numbered input frames, so an input lost with one datagram arrives
+with the next one instead of waiting for a resend. the server keeps the
+highest sequence number it applied per player and applies only newer
+frames, oldest first.
+
+Copyright (C) 2025 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the
+prior written consent of DigiPen Institute of Technology is prohibited.
+*/
+#pragma once
+#include <string>
+#include <vector>
+
+namespace INPUTFRAME
+{
+	const int REDUNDANCY = 4;			//frames repeated in every packet
+	const float WINDOW = 1.f;			//seconds a frame keeps being repeated, the server cannot rewind further anyway
+	const int COUNT_SIZE = 1;
+	const int FRAME_SIZE = 4 + 4 + 1;	//seq, timestamp, flags
+
+	enum InputFlag : unsigned char
+	{
+		F_FIRE = 1 << 0
+	};
+
+	struct Frame
+	{
+		unsigned int seq;		//starts at 1, never reused on a connection
+		float timestamp;		//client appTime the input happened at
+		unsigned char flags;
+	};
+
+	//client side, the newest frames waiting to be repeated
+	class History
+	{
+	public:
+		History();
+
+		//records an input, returns its seq
+		unsigned int Push(float timestamp, unsigned char flags);
+
+		//count - 1b, (seq - 4b, timestamp - 4b, flags - 1b) * count, oldest first.
+		//frames older than WINDOW at now are left out, so an idle client only sends the count
+		void Append(std::string& packet, float now) const;
+
+		//forgets the frames, seq keeps counting so the server never mistakes a new frame for an old one
+		void Clear();
+
+	private:
+		Frame _frames[REDUNDANCY];	//ring, _count newest ending before _head
+		int _head;
+		int _count;
+		unsigned int _nextSeq;
+	};
+
+	//reads a block written by History::Append. returns the bytes it used, -1 if it is truncated
+	int Read(const char* buffer, int length, std::vector<Frame>& frames);
+
+	//server side, one per player
+	class Receiver
+	{
+	public:
+		Receiver();
+
+		//adds the frames not applied yet to fresh, oldest first, and marks them applied
+		void Accept(std::vector<Frame> const& frames, std::vector<Frame>& fresh);
+
+		//one frame at a time, true if seq was not applied yet and marks it applied
+		bool Accept(unsigned int seq);
+
+		//the next frame is accepted whatever its seq, for a new connection
+		void Reset();
+
+		//picks up after lastSeq, for a player that goes back into a match with what it had applied
+		void Restore(unsigned int lastSeq);
+
+		//newest frame applied, 0 before the first
+		unsigned int LastSeq() const { return _lastSeq; }
+
+	private:
+		unsigned int _lastSeq;
+	};
+}
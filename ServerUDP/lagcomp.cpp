@@ -0,0 +1,181 @@
+/*!
+\file		lagcomp.cpp
+\author		darius (d.chan@digipen.edu)
+\co-author
+\par		Assignment 4
+\date		19/10/2026
+\brief
+lag compensation for the server. keeps a ring of entity states for the
+last few ticks so that a fire request can be resolved against what the
+shooter saw at the time they fired, instead of the present positions.
+
+Copyright (C) 2025 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the
+prior written consent of DigiPen Institute of Technology is prohibited.
+*/
+#include "lagcomp.h"
+#include "collision.h"
+#include <array>
+#include <mutex>
+
+namespace LAGCOMP
+{
+	namespace
+	{
+		//written by the main loop, read by the receive thread
+		std::mutex historyMutex;
+		std::array<Snapshot, HISTORY_SIZE> history{};
+		size_t head{};		//next slot to be written
+		size_t count{};		//number of valid snapshots in the ring
+
+		//age 0 is the newest snapshot
+		Snapshot const& At(size_t age)
+		{
+			return history[(head + HISTORY_SIZE - 1 - age) % HISTORY_SIZE];
+		}
+
+		EntityState ToState(GameObject const& go, unsigned int generation)
+		{
+			return { go.t, go.vel, go.isActive, generation };
+		}
+
+		//field by field like StateHash::Add(GameObject), the padding is never hashed
+		void HashState(DETERMINISM::StateHash& hash, EntityState const& state)
+		{
+			hash.Add(state.isActive);
+			hash.Add(state.t.pos.x);
+			hash.Add(state.t.pos.y);
+			hash.Add(state.t.scale.x);
+			hash.Add(state.t.scale.y);
+			hash.Add(state.t.rot);
+			hash.Add(state.vel.x);
+			hash.Add(state.vel.y);
+			hash.Add(state.generation);
+		}
+	}
+
+	void Record(float timestamp, Player const* players, size_t playerCount, Pool<GameObject> const& golist)
+	{
+		std::lock_guard<std::mutex> lock(historyMutex);
+		Snapshot& s = history[head];
+		s.timestamp = timestamp;
+
+		//resize only allocates until the ring has seen the largest golist
+		s.players.resize(playerCount);
+		for (size_t i = 0; i < playerCount; ++i)
+		{
+			s.players[i] = ToState(players[i].go, 0);
+		}
+		s.asteroids.resize(golist.size());
+		for (size_t i = 0; i < golist.size(); ++i)
+		{
+			s.asteroids[i] = ToState(golist[(int)i], golist.Generation((int)i));
+		}
+
+		head = (head + 1) % HISTORY_SIZE;
+		if (count < HISTORY_SIZE) ++count;
+	}
+
+	void Clear()
+	{
+		std::lock_guard<std::mutex> lock(historyMutex);
+		head = count = 0;
+	}
+
+	void Hash(DETERMINISM::StateHash& hash)
+	{
+		std::lock_guard<std::mutex> lock(historyMutex);
+		hash.Add((int)count);
+		for (size_t age = count; age-- > 0;)
+		{
+			Snapshot const& s = At(age);
+			hash.Add(s.timestamp);
+			for (EntityState const& p : s.players) HashState(hash, p);
+			for (EntityState const& a : s.asteroids) HashState(hash, a);
+		}
+	}
+
+	ShotResult ResolveShot(float fireTime, float now, int playerID, GameObject bullet, float lifeTime)
+	{
+		ShotResult result{ fireTime, -1, 0, bullet, lifeTime };
+
+		//bound the rewind so a client cannot claim hits arbitrarily far in the past
+		if (result.fireTime > now) result.fireTime = now;
+		if (result.fireTime < now - MAX_REWIND) result.fireTime = now - MAX_REWIND;
+
+		std::lock_guard<std::mutex> lock(historyMutex);
+		if (count == 0)
+		{
+			//nothing recorded yet, shot stays at the present
+			result.fireTime = now;
+			return result;
+		}
+
+		//find the newest snapshot that is not newer than the fire time
+		size_t age = 0;
+		while (age + 1 < count && At(age).timestamp > result.fireTime) ++age;
+		Snapshot const& from = At(age);
+		if (from.timestamp > result.fireTime) result.fireTime = from.timestamp;	//history does not go back that far
+		if (playerID < 0 || playerID >= (int)from.players.size()) return result;
+
+		//shooter state at the fire time, position interpolated towards the next newer snapshot
+		EntityState shooter = from.players[playerID];
+		if (age > 0)
+		{
+			Snapshot const& to = At(age - 1);
+			float span = to.timestamp - from.timestamp;
+			if (span > 0.f && playerID < (int)to.players.size())
+			{
+				float a = (result.fireTime - from.timestamp) / span;
+				AEVec2 const& next = to.players[playerID].t.pos;
+				shooter.t.pos.x += (next.x - shooter.t.pos.x) * a;
+				shooter.t.pos.y += (next.y - shooter.t.pos.y) * a;
+			}
+		}
+
+		float speed{ AEVec2Length(&bullet.vel) };
+		float rad{ AEDegToRad(shooter.t.rot) };
+		GameObject& b = result.bullet;
+		b.t.pos = shooter.t.pos;
+		b.t.rot = shooter.t.rot;
+		b.vel = { cosf(rad) * speed, sinf(rad) * speed };
+
+		//replay the bullet through every recorded tick from the fire time up to the present
+		GameObject asteroid{ bullet };
+		float time = result.fireTime;
+		for (size_t i = age + 1; i-- > 0;)
+		{
+			Snapshot const& s = At(i);
+			float next = (i == 0) ? now : At(i - 1).timestamp;
+			float dt = next > time ? next - time : 0.f;
+
+			for (size_t j = 0; j < s.asteroids.size(); ++j)
+			{
+				EntityState const& a = s.asteroids[j];
+				if (!a.isActive) continue;
+
+				//asteroid as it was at this tick, moved to the bullet's time
+				asteroid.t = a.t;
+				asteroid.vel = a.vel;
+				asteroid.t.pos.x += a.vel.x * (time - s.timestamp);
+				asteroid.t.pos.y += a.vel.y * (time - s.timestamp);
+				if (COLLISION::IsWithinDistanceCheckDynamic(b, asteroid, dt))
+				{
+					result.hitIndex = (int)j;
+					result.hitGeneration = a.generation;
+					return result;
+				}
+			}
+
+			b.t.pos.x += b.vel.x * dt;
+			b.t.pos.y += b.vel.y * dt;
+			time = next;
+			if ((result.lifeTime -= dt) < 0.f)
+			{
+				b.isActive = false;
+				break;
+			}
+		}
+		return result;
+	}
+}
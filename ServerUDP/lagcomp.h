@@ -0,0 +1,67 @@
+/*!
+\file		lagcomp.h
+\author		darius (d.chan@digipen.edu)
+\co-author
+\par		Assignment 4
+\date		19/10/2026
+\brief
+lag compensation for the server. keeps a ring of entity states for the
+last few ticks so that a fire request can be resolved against what the
+shooter saw at the time they fired, instead of the present positions.
+
+Copyright (C) 2025 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the
+prior written consent of DigiPen Institute of Technology is prohibited.
+*/
+#pragma once
+#include "gameobject.h"
+#include "pool.h"
+#include "determinism.h"
+#include <vector>
+
+namespace LAGCOMP
+{
+	const float MAX_REWIND = 0.25f;		//furthest back (seconds) a fire request can be rewound
+	const size_t HISTORY_SIZE = 64;		//ticks kept in the ring, must cover MAX_REWIND at the tick rate
+
+	//state of a single entity needed to redo a collision check
+	struct EntityState
+	{
+		Transform t;
+		AEVec2 vel;
+		bool isActive;
+		unsigned int generation;	//pool generation of the slot, 0 for players
+	};
+
+	//state of every entity at one server tick
+	struct Snapshot
+	{
+		float timestamp;
+		std::vector<EntityState> players;
+		std::vector<EntityState> asteroids;		//index matches golist
+	};
+
+	//outcome of a rewound shot
+	struct ShotResult
+	{
+		float fireTime;			//the time the shot was resolved from (after clamping)
+		int hitIndex;			//golist index of the asteroid hit, -1 if nothing was hit
+		unsigned int hitGeneration;	//golist generation of that slot when it was hit
+		GameObject bullet;		//bullet moved forward to the present if nothing was hit
+		float lifeTime;			//remaining bullet lifetime at the present
+	};
+
+	//saves the state of this tick into the ring, called once per tick after collision
+	void Record(float timestamp, Player const* players, size_t playerCount, Pool<GameObject> const& golist);
+
+	//clears all recorded history, called when a match starts
+	void Clear();
+
+	//adds every recorded snapshot to hash, oldest first. a rewound shot depends on all of them
+	void Hash(DETERMINISM::StateHash& hash);
+
+	//rewinds to the shooter's view time (bounded by MAX_REWIND) and replays the bullet up to now.
+	//bullet is the bullet as shot from the present, its position, rotation and velocity are
+	//replaced with the shooter's state at the fire time when history is available
+	ShotResult ResolveShot(float fireTime, float now, int playerID, GameObject bullet, float lifeTime);
+}
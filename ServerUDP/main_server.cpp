@@ -35,11 +35,35 @@ prior written consent of DigiPen Institute of Technology is prohibited.
 #include <chrono>
 #include <ctime>
 #include <random>
+#include <algorithm>
 
+#include "protocol.h"
 #include "taskqueue.h"
 #include "highscore.h"
 #include "collision.h"
 #include "gameobject.h"
+#include "lagcomp.h"
+#include "ratecontrol.h"
+#include "replication.h"
+#include "fragment.h"
+#include "coalesce.h"
+#include "connection.h"
+#include "snapshot.h"
+#include "matchmaking.h"
+#include "validation.h"
+#include "pool.h"
+#include "input.h"
+#include "latency.h"
+#include "transport.h"
+#include "message.h"
+#include "server.h"
+#include "profile.h"
+#include "metrics.h"
+#include "trace.h"
+#include "contention.h"
+#include "capture.h"
+#include "determinism.h"
+#include "spawn.h"
 #include "AlphaEngine/include/AEEngine.h"
 
 #define WINSOCK_VERSION     2
@@ -47,96 +71,111 @@ prior written consent of DigiPen Institute of Technology is prohibited.
 #define MAX_STR_LEN         1000
 
 #define MAX_PLAYERS         4
-#define TOTAL_PLAYERS       1
-#define UPDATE_RATE         50
+#define TOTAL_PLAYERS       1       // fewest players a match starts with
+#define MATCH_MAX_WAIT      5       // seconds the queue waits for a full room before starting with fewer
+#define BACKFILL_CUTOFF     15      // seconds left in a match below which no one is added from the queue
+#define UPDATE_RATE         50      // starting ms between C_ALL_UPDATE to a client
+#define MIN_UPDATE_RATE     33      // fastest a good link is updated
+#define MAX_UPDATE_RATE     200     // slowest a congested link is updated
+#define SEND_TICK           5       // ms the send thread sleeps between checking which client is due
 #define TIME_SYNC           5
 #define TOTAL_TIME          60
+#define FRAME_RATE          60      // frames per second the main loop is held to, a tick longer than one frame is an overrun
+#define ASTEROID_SEED       1       // the clients seed their own spawner the same to follow C_ASTEROID_SPAWN
 
 
-
-
-
-enum CommandID : unsigned char {
-    C_ERROR = 0,
-    C_STATE_UPDATE = 1,	//Regular client update
-    C_ALL_UPDATE = 2,	//Regular server update
-    C_REQ_FIRE = 3,		//Sends fire req to server
-    C_RSP_FIRE = 4,		//Send fire rsp from server to client
-    C_ASTEROID_SPAWN = 5,		//Send asteroid destroyed from server to client
-    C_ASTEROID_DESTROY = 6,
-    C_REQ_CONNECT = 7,	//Send to server to req connection
-    C_RSP_CONNECT = 8,	//Send to client which player client is, or not connected
-    C_GAME_START = 9,
-    C_GAME_END = 10,
-    C_TIME_SYNC = 11	//highest authority, syncing time and position and vel values for all
-};
-
-//Structure for a packet to be sent to the server
-
-     //	C_ERROR
-    //	-ignored
-    //C_STATE_UPDATE
-    //	id - 1b, timestamp - 4b, pos - 8b, scale - 8b, rot - 4b, vel - 8b
-    //C_ALL_UPDATE
-    //	id - 1b, timestamp - 4b, (pos - 8b, scale - 8b, rot - 4b, vel - 8b) * 4
-    //C_REQ_FIRE
-    //	id - 1b, timestamp - 4b
-    //C_RSP_FIRE
-    //	id - 1b, timestamp - 4b, playerid - 4b
-    //C_ASTEROID_SPAWN
-    //	id - 1b, timestamp - 4b
-    //C_ASTEROID_DESTROY
-    //  id - 1b, index - 4b
-    //C_REQ_CONNECT
-    //	id - 1b
-    //C_RSP_CONNECT
-    //	id - 1b, playerid - 4b
-    //C_GAME_START
-    //	id - 1b
-    //C_GAME_END
-    //	id - 1b, (highscore - 4b, date - 8b) * 5, playerscore - 4b * 4
-    //C_TIME_SYNC
-    //	id - 1b, timestamp - 4b, (pos - 8b, scale - 8b, rot - 4b, vel - 8b) * 4
-
 // Global variable
 std::unordered_map<std::string, sockaddr_in> clients;  // Map of "IP:Port" -> SOCKET
-std::mutex Mutex;
+CONTENTION::ProfiledMutex Mutex{ "Mutex" };
 std::unordered_map<std::string, int> playersIndex;  // Map of player "IP:Port" -> index
 std::array<Player, MAX_PLAYERS> playersInfo;                  // Array of player information, index based on above index, pair of player info and score
-
-std::vector<Bullet> bulletlist{};			//every bullet in the game
-std::vector<GameObject> golist{};			//every other gameobject in the game
+std::array<RateController, MAX_PLAYERS> sendRates;            // C_ALL_UPDATE rate towards each player, adapted to their link
+std::array<float, MAX_PLAYERS> nextSendTime{};                // appTime each player is next due an update
+std::array<float, MAX_PLAYERS> timestampRecvTime{};           // appTime the player's latest timestamp arrived, for the echo
+std::array<REPLICATION::Accumulator, MAX_PLAYERS> replication;  // priority of every asteroid and bullet towards each player
+std::array<float, MAX_PLAYERS> lastReplicationTime{};         // appTime each player last got a C_ENTITY_UPDATE
+std::unordered_map<std::string, COALESCE::Aggregator> outgoing; // Map of "IP:Port" -> messages waiting to be sent in one datagram
+CONNECTION::SlotTable slots{ MAX_PLAYERS };                   // which player index each connection holds, with timeouts
+std::array<bool, MAX_PLAYERS> inMatch{};                      // players in the running match, every other connection waits in the queue
+MATCHMAKING::Queue matchQueue{};
+const MATCHMAKING::Policy matchPolicy{ TOTAL_PLAYERS, MAX_PLAYERS, MATCH_MAX_WAIT, BACKFILL_CUTOFF };
+std::array<VALIDATION::TokenBucket, MAX_PLAYERS> packetBudget;  // messages each player may still send, refilled over time
+std::array<float, MAX_PLAYERS> lastFireTime{};                // fire time of each player's last accepted shot
+std::array<VALIDATION::Movement, MAX_PLAYERS> lastMove{};       // position of each player's last accepted state update
+std::array<INPUTFRAME::Receiver, MAX_PLAYERS> inputReceivers{}; // newest input frame applied for each player
+bool deterministic{ false };                                   // --deterministic, see server.h
+std::vector<DETERMINISM::Input> pendingInputs{};               // deterministic mode: inputs that arrived since the last tick
+std::vector<DETERMINISM::Input> tickInputs{};                  // deterministic mode: the inputs the last tick applied
+DETERMINISM::TickLog matchLog{};
+LATENCY::Histogram rttHistogram{};                             // every client's rtt samples this match
+
+// operational metrics, served in the prometheus text format with --metrics <port>
+METRICS::Counter& staleStates = METRICS::Default().AddCounter("server_stale_state_updates_total",
+    "C_STATE_UPDATEs dropped for being no newer than the last one from the same player");
+METRICS::Counter& clampedMoves = METRICS::Default().AddCounter("server_clamped_moves_total",
+    "C_STATE_UPDATEs whose position was further than MAX_SPEED allows since the last one and was pulled back");
+METRICS::Counter& tickOverruns = METRICS::Default().AddCounter("server_tick_overruns_total", "Ticks that took longer than a frame");
+METRICS::Histogram& tickSeconds = METRICS::Default().AddHistogram("server_tick_seconds", "Time spent in one ServerTick",
+    { 0.0001, 0.00025, 0.0005, 0.001, 0.0025, 0.005, 0.01, 1.0 / FRAME_RATE, 0.025, 0.05, 0.1 });
+METRICS::Gauge& playersConnected = METRICS::Default().AddGauge("server_players_connected", "Clients holding a player slot");
+METRICS::Gauge& playersPlaying = METRICS::Default().AddGauge("server_players_in_match", "Players in the running match");
+METRICS::Gauge& asteroidsActive = METRICS::Default().AddGauge("server_entities_active", "Active entities at the end of the last tick", "kind=\"asteroid\"");
+METRICS::Gauge& bulletsActive = METRICS::Default().AddGauge("server_entities_active", "Active entities at the end of the last tick", "kind=\"bullet\"");
+
+// every bullet and asteroid in the game, allocated once so nothing moves or allocates during a match
+Pool<Bullet> bulletlist{ MAX_BULLETS, Bullet{ { {{0.f, 0.f},{10.f, 10.f}, 0.f}, {}, ASSET::A_BULLET, {1.f, 1.f, 1.f, 1.f}, false }, 0.f, 0 }, P_RECYCLE_OLDEST };
+Pool<GameObject> golist{ MAX_ASTEROIDS, GameObject{ {{0.f, 0.f},{0.f, 0.f}, 0.f}, {}, ASSET::A_ASTEROID, {0.f, 0.f, 0.f, 1.f}, false }, P_RECYCLE_OLDEST };
 
 bool keep_running = true;
 bool game_start = false;
 bool has_started = false;
 f32 timer = TOTAL_TIME;
+int asteroidsSpawned{};     // spawn messages sent so far, late joiners catch their spawner up to this
+std::mt19937 asteroidRng(ASTEROID_SEED);	// the match's only random stream, reseeded when it starts
+float spawnCountDown{};
 
 const float BULLET_SPEED = 1000.f;
 const float ASTEROID_SPAWN_SPEED = 2.f; //seconds
-const float ASTEROID_MIN_SIZE = 50.f;	//min radius
-const float ASTEROID_MAX_SIZE = 100.f;	//max radius
-const float ASTEROID_MOVE_SPEED = 100.f;
 const int SCORE_PER_ASTEROID = 50;
 const int NEG_SCORE_PER_HIT = 10;		//player got hit
 
 float latest_timestamp{};
 
 const AEVec2 screen{ 1600.f, 900.f };	//application window width & height
+const GameObject SHIP_START{ {{0.f, 0.f},{50.f, 50.f}, 0.f}, {}, ASSET::A_PLAYER, {1.f, 0.f, 0.f, 1.f}, true };	//every ship before its player's first state update
 
 f32 appTime{};
 
 // Forward declares
-void ReceiveThread(SOCKET serverSock);
-void SendThread(SOCKET serverSock);
-void Spawn_Asteroids(SOCKET serverSock);
+void ReceiveThread(TRANSPORT::Transport& serverSock);
+void HandlePacket(TRANSPORT::Transport& serverSock, const char* buffer, int bytes_received, sockaddr_in client_addr);
+void ApplyInputs(TRANSPORT::Transport& serverSock, int tmpId, const char* block, int length);
+void ApplyFire(TRANSPORT::Transport& serverSock, int tmpId, float timestamp);
+void ApplyPendingInputs(TRANSPORT::Transport& serverSock);
+void PlayerEvent(DETERMINISM::InputKind kind, int index);
+void ApplyPlayerEvent(DETERMINISM::Input const& event);
+unsigned long long HashState();
+int SendFragmented(TRANSPORT::Transport& serverSock, std::string const& message, sockaddr_in const& addr);
+int QueueMessage(TRANSPORT::Transport& serverSock, std::string const& message, std::string const& ipPort);
+void QueueBroadcast(TRANSPORT::Transport& serverSock, std::string const& message);
+int FlushMessages(TRANSPORT::Transport& serverSock, std::string const& ipPort);
+void FlushAllMessages(TRANSPORT::Transport& serverSock);
+void AddClient(int index, std::string const& ipPort, sockaddr_in const& addr, bool resumed);
+void RemoveClient(int index, std::string const& ipPort);
+std::string BuildFullState();
+void SendMatchState(TRANSPORT::Transport& serverSock, sockaddr_in const& addr);
+void StartMatch(std::vector<int> const& players);
+void JoinMatch(TRANSPORT::Transport& serverSock, int index);
+void EndMatch(TRANSPORT::Transport& serverSock);
+void SendThread(TRANSPORT::Transport& serverSock);
+void Spawn_Asteroids(TRANSPORT::Transport& serverSock);
 void InterpolateGameobject(GameObject& go, float timestamp);
-void Destroy_Asteroids(SOCKET serverSock, int astId);
-void SimpleDynamicCollisionCheck(float dt, SOCKET serverSocket);
-Bullet& Shoot(AEVec2 const& pos, float angle, int playerID);
-GameObject& SpawnAsteroid();
-float RandomFloat(std::mt19937& rng, float min, float max);
-int RandomInt(std::mt19937& rng, int min, int max);
+void Destroy_Asteroids(TRANSPORT::Transport& serverSock, int astId);
+void SimpleDynamicCollisionCheck(float dt, TRANSPORT::Transport& serverSocket);
+int Shoot(AEVec2 const& pos, float angle, int playerID);
+
+#ifndef SERVER_NO_MAIN
+std::string CommandLineValue(const wchar_t* cmdLine, const wchar_t* option);
 
 int APIENTRY wWinMain(_In_ HINSTANCE hInstance,
     _In_opt_ HINSTANCE hPrevInstance,
@@ -145,9 +184,30 @@ int APIENTRY wWinMain(_In_ HINSTANCE hInstance,
 {
 
     UNREFERENCED_PARAMETER(hPrevInstance);
-    UNREFERENCED_PARAMETER(lpCmdLine);
 
-    AESysInit(hInstance, nCmdShow, 10, 10, 1, 60, true, NULL);
+    // --profile times the hot paths from the start, P prints what they took so far
+    if (wcsstr(lpCmdLine, L"--profile"))
+    {
+        PROFILE::SetEnabled(true);
+    }
+    // --locks counts waits and holds of Mutex by call site, L prints the worst and so does the end of every match
+    if (wcsstr(lpCmdLine, L"--locks"))
+    {
+        CONTENTION::SetEnabled(true);
+    }
+    // --deterministic ticks at a fixed dt and applies inputs only between ticks, the hash after every tick goes to server_hashes_<match>.txt
+    if (wcsstr(lpCmdLine, L"--deterministic"))
+    {
+        deterministic = true;
+    }
+    // --trace writes a timeline of every thread after each match, server_trace_<match>.json
+    if (wcsstr(lpCmdLine, L"--trace"))
+    {
+        TRACE::Start("server");
+        TRACE::NameThread("main");
+    }
+
+    AESysInit(hInstance, nCmdShow, 10, 10, 1, FRAME_RATE, true, NULL);
 
     sockaddr_in server_addr{};
     //char buffer[1024];
@@ -160,6 +220,9 @@ int APIENTRY wWinMain(_In_ HINSTANCE hInstance,
         return 0;
     }
     std::getline(file, portNumber);
+    // optional second line impairs the server's link for testing, "latency_ms jitter_ms loss duplicate reorder bandwidth_kbps"
+    std::string impairmentLine{};
+    std::getline(file, impairmentLine);
 
     // Initialize Winsock
     WSADATA wsaData{};
@@ -224,42 +287,199 @@ int APIENTRY wWinMain(_In_ HINSTANCE hInstance,
 
     std::cout << "Server is listening on port " << portNumber <<" ip "<<serverIPAddr<< " ...\n";
 
-    std::thread recv_thread(ReceiveThread,soc);
-    std::thread send_thread(SendThread,soc);
+    std::unique_ptr<TRANSPORT::Transport> transport = std::make_unique<TRANSPORT::UdpTransport>(soc);
+    TRANSPORT::Impairment impairment{};
+    if (!impairmentLine.empty() && TRANSPORT::ParseImpairment(impairmentLine, impairment))
+    {
+        // same impairment both ways, seeded so a run can be repeated
+        transport = std::make_unique<TRANSPORT::SimulatedLink>(std::move(transport), impairment, impairment, 1);
+        std::cout << "Simulating " << impairment.latency * 1000.f << "ms +" << impairment.jitter * 1000.f << "ms latency, "
+            << impairment.loss * 100.f << "% loss, " << impairment.duplicate * 100.f << "% duplicates, "
+            << impairment.reorder * 100.f << "% reordered, " << impairment.bandwidth * 8.f / 1000.f << "kbps cap\n";
+    }
+    // --capture <file> records every datagram as the server saw it, PacketTool decodes and replays it
+    std::string capturePath = CommandLineValue(lpCmdLine, L"--capture");
+    if (!capturePath.empty())
+    {
+        std::unique_ptr<CAPTURE::Writer> writer = std::make_unique<CAPTURE::Writer>();
+        if (writer->Open(capturePath, CAPTURE::R_SERVER))
+        {
+            transport = std::make_unique<CAPTURE::CaptureTransport>(std::move(transport), std::move(writer));
+            std::cout << "Capturing to " << capturePath << "\n";
+        }
+        else
+        {
+            std::cerr << "cannot write " << capturePath << std::endl;
+        }
+    }
+    // counted above the simulated link, what the server meant to send and what got through to it
+    transport = std::make_unique<METRICS::CountingTransport>(std::move(transport), METRICS::Default());
+    TRANSPORT::Transport& net = *transport;
+
+    // --metrics <port> serves the counters on this machine for a prometheus scraper
+    if (const wchar_t* metricsArg = wcsstr(lpCmdLine, L"--metrics"))
+    {
+        unsigned short metricsPort = static_cast<unsigned short>(wcstoul(metricsArg + wcslen(L"--metrics"), nullptr, 10));
+        if (METRICS::Serve(METRICS::Default(), metricsPort))
+        {
+            std::cout << "Metrics at http://127.0.0.1:" << metricsPort << "/metrics\n";
+        }
+        else
+        {
+            std::cerr << "cannot serve metrics on port " << metricsPort << std::endl;
+        }
+    }
+
+    std::thread recv_thread(ReceiveThread, std::ref(net));
+    std::thread send_thread(SendThread, std::ref(net));
 
     send_thread.detach();
     recv_thread.detach();
     
-    for (int i = 0; i < MAX_PLAYERS; i++)
-    {
-        Player player{ {{{0.f, 0.f},{50.f, 50.f}, 0.f}, {}, "player", {1.f, 0.f, 0.f, 1.f}, true}, 0 };
-        playersInfo[i] = player;
-    }
+    InitServer();
 
+    int tracedMatches{};
+    int hashedMatches{};
     while (true)
     {
+        // start a match from the queue, or top up the running one
+        Matchmake(net);
+
         if (!game_start)
         {
+            std::this_thread::sleep_for(std::chrono::milliseconds(SEND_TICK));
             continue;
         }
 
-        f32 dt = static_cast<f32>(AEFrameRateControllerGetFrameTime());
-        appTime += dt;
-        timer -= dt;
+        // every tick the same length, a slow frame puts the match behind the clock instead of taking a longer step
+        f32 dt = deterministic ? FIXED_DT : static_cast<f32>(AEFrameRateControllerGetFrameTime());
 
         AESysFrameStart();
 
-        static float countDown{};
-        countDown -= dt;
-        if (countDown <= 0.f)
+        ServerTick(net, dt);
+
+        // the match that just ended, outside the lock so nobody waits on the file
+        if (!game_start && TRACE::Enabled())
+        {
+            std::string tracePath{ "server_trace_" + std::to_string(++tracedMatches) + ".json" };
+            bool written = TRACE::Write(tracePath);
+            std::lock_guard<std::mutex> usersLock{ _stdoutMutex };
+            if (written)
+            {
+                std::cout << "Trace written to " << tracePath << std::endl;
+            }
+            else
+            {
+                std::cerr << "cannot write " << tracePath << std::endl;
+            }
+        }
+        if (!game_start && deterministic)
+        {
+            std::string hashPath{ "server_hashes_" + std::to_string(++hashedMatches) + ".txt" };
+            bool written = matchLog.Write(hashPath);
+            std::lock_guard<std::mutex> usersLock{ _stdoutMutex };
+            std::cout << matchLog.Ticks() << " ticks, state hash " << std::hex << matchLog.Combined() << std::dec << std::endl;
+            if (!written)
+            {
+                std::cerr << "cannot write " << hashPath << std::endl;
+            }
+        }
+        // reported here and not in EndMatch, the report takes Mutex itself
+        if (CONTENTION::Enabled() && (!game_start || AEInputCheckTriggered(AEVK_L)))
+        {
+            std::string locks = CONTENTION::Report();
+            if (!game_start)
+            {
+                CONTENTION::Clear();
+            }
+            std::lock_guard<std::mutex> usersLock{ _stdoutMutex };
+            std::cout << locks;
+        }
+
+        // samples move out of the threads' rings every frame so they never fill up. where a match's time
+        // went is printed once it ends, outside Mutex like the lock report, and the next one starts empty
+        if (PROFILE::Enabled())
+        {
+            PROFILE::Collect();
+            if (!game_start || AEInputCheckTriggered(AEVK_P))
+            {
+                std::string zones = PROFILE::Report();
+                if (!game_start)
+                {
+                    PROFILE::Clear();
+                }
+                std::lock_guard<std::mutex> usersLock{ _stdoutMutex };
+                std::cout << zones;
+            }
+        }
+
+        AESysFrameEnd();
+    }
+
+    AESysExit();
+}
+
+// The word after option on the command line, empty if the option is not there
+std::string CommandLineValue(const wchar_t* cmdLine, const wchar_t* option)
+{
+    const wchar_t* found = wcsstr(cmdLine, option);
+    if (!found)
+    {
+        return {};
+    }
+    found += wcslen(option);
+    while (*found == L' ')
+    {
+        ++found;
+    }
+    std::string value{};
+    for (; *found && *found != L' '; ++found)
+    {
+        value += static_cast<char>(*found);
+    }
+    return value;
+}
+#endif
+
+// Every player slot back to its defaults
+void InitServer()
+{
+    for (int i = 0; i < MAX_PLAYERS; i++)
+    {
+        Player player{ SHIP_START, 0 };
+        playersInfo[i] = player;
+        sendRates[i] = RateController(MIN_UPDATE_RATE / 1000.f, MAX_UPDATE_RATE / 1000.f, UPDATE_RATE / 1000.f);
+    }
+}
+
+// One frame of the match: spawn, move, collide, record and flush
+void ServerTick(TRANSPORT::Transport& net, float dt, TickTimes* times)
+{
+    PROFILE_ZONE("tick");
+    using Clock = std::chrono::steady_clock;
+    Clock::time_point start = Clock::now();
+
+    // inputs that arrived since the last tick, all at once before anything moves
+    if (deterministic)
+    {
+        ApplyPendingInputs(net);
+    }
+
+    appTime += dt;
+    timer -= dt;
+
+    {
+        PROFILE_ZONE("tick.simulate");
+        spawnCountDown -= dt;
+        if (spawnCountDown <= 0.f)
         {
-            countDown = ASTEROID_SPAWN_SPEED;
-            Spawn_Asteroids(soc);
-            
+            spawnCountDown = ASTEROID_SPAWN_SPEED;
+            Spawn_Asteroids(net);
+
         }
 
         //update
-        for (auto& p : playersInfo) 
+        for (auto& p : playersInfo)
         {
             p.go.Update(screen, dt);
         }
@@ -270,70 +490,76 @@ int APIENTRY wWinMain(_In_ HINSTANCE hInstance,
             b.Update(screen, dt);
         }
         //RandomizeAsteroidSpawn(dt);
+    }
+    Clock::time_point simulated = Clock::now();
 
+    {
+        PROFILE_ZONE("tick.collide");
         //collision check
-        SimpleDynamicCollisionCheck(dt,soc);
-
-
-        if (timer <= 0.f)
-        {
-            keep_running = false;
-            game_start = false;
-            std::cout << " finish" << std::endl;
+        SimpleDynamicCollisionCheck(dt,net);
 
-            std::string message{};
-            message += C_GAME_END;
+        //save this tick for rewinding fire requests
+        LAGCOMP::Record(appTime, playersInfo.data(), playersInfo.size(), golist);
+    }
+    Clock::time_point collided = Clock::now();
 
-            HIGHSCORE::ReadFromHighscoreFile();
+    //everything queued for a client this tick goes out together
+    {
+        PROFILE_ZONE("tick.flush");
+        CONTENTION::Lock lock{ Mutex };
 
-            // add player to highscore
-            for (int i =0;i<TOTAL_PLAYERS;i++)
-            {
-                std::string name{ "player " };
-                name += (i+1);
-                HIGHSCORE::AddHighscore(playersInfo[i].score,name);
-            }
-            // send highscores
-            for (auto& score : HIGHSCORE::highScores)
+        // bullets that expired or hit something this tick give their slot back here, under the same lock
+        // ApplyFire acquires slots with. Release leaves a slot that is free already alone
+        for (int i = 0; i < (int)bulletlist.size(); ++i)
+        {
+            if (!IsActive(bulletlist[i]))
             {
-                unsigned int tmp = htonl(score.score);
-                message.append((char*)(&tmp), (char*)(&tmp) + 4);
-
-                long long tmpll = htonll(score.playDate);
-                message.append((char*)(&tmpll), (char*)(&tmpll) + 8);
-
+                bulletlist.Release(i);
             }
+        }
+        FlushAllMessages(net);
+    }
+    Clock::time_point flushed = Clock::now();
 
-            // send player scores
-            for (auto& player : playersInfo)
-            {
-                unsigned int tmp = htonl(player.score);
-                message.append((char*)(&tmp), (char*)(&tmp) + 4);
-            }
-            // send all clients
-            for (auto& client : clients)
-            {
-                sendto(soc, message.c_str(), (int)message.length(), 0, reinterpret_cast<sockaddr*>(&client.second), sizeof(client.second));
-            }
+    if (times)
+    {
+        times->simulate = std::chrono::duration<double>(simulated - start).count();
+        times->collide = std::chrono::duration<double>(collided - simulated).count();
+        times->flush = std::chrono::duration<double>(flushed - collided).count();
+    }
 
-            HIGHSCORE::WriteToHighscoreFile();
-        }
+    double tickTime = std::chrono::duration<double>(flushed - start).count();
+    tickSeconds.Observe(tickTime);
+    if (tickTime > 1.0 / FRAME_RATE)
+    {
+        tickOverruns.Add();
+    }
+    asteroidsActive.Set((double)std::count_if(golist.begin(), golist.end(), [](GameObject const& a) { return IsActive(a); }));
+    bulletsActive.Set((double)std::count_if(bulletlist.begin(), bulletlist.end(), [](Bullet const& b) { return IsActive(b); }));
+    playersPlaying.Set((double)std::count(inMatch.begin(), inMatch.end(), true));
 
-        AESysFrameEnd();
+    if (deterministic)
+    {
+        matchLog.Add(HashState(), tickInputs);
     }
 
-    AESysExit();
+    if (timer <= 0.f)
+    {
+        EndMatch(net);
+    }
 }
 
-void ReceiveThread(SOCKET serverSock) 
+void ReceiveThread(TRANSPORT::Transport& serverSock) 
 {
-    char buffer[MAX_STR_LEN];
+    TRACE::NameThread("receive");
+    char buffer[MAX_DATAGRAM_SIZE];
+    FRAGMENT::Reassembler reassembler{};
+    std::string message{};
     sockaddr_in client_addr{};
-    int client_addr_len = sizeof(client_addr);
 
     while (keep_running) 
     {
-        int bytes_received = recvfrom(serverSock, buffer, sizeof(buffer), 0, reinterpret_cast<sockaddr*> (&client_addr), &client_addr_len);
+        int bytes_received = serverSock.RecvFrom(buffer, sizeof(buffer), client_addr);
 
         if (bytes_received == SOCKET_ERROR) {
             //std::cerr << "Recvfrom failed: " << WSAGetLastError() << std::endl;
@@ -351,465 +577,1121 @@ void ReceiveThread(SOCKET serverSock)
                 //std::cerr << "trying again..." << std::endl;
                 continue;
             }
+            if (errorCode == WSAECONNRESET || errorCode == WSAEMSGSIZE)
+            {
+                // a client that went away answered with port unreachable, or a datagram was too big. the socket is fine
+                continue;
+            }
             std::lock_guard<std::mutex> usersLock{ _stdoutMutex };
             std::cerr << "recv() failed." << std::endl;
             break;
         }
 
-        char client_ip[INET_ADDRSTRLEN];
-        inet_ntop(AF_INET, &client_addr.sin_addr, client_ip, INET_ADDRSTRLEN);
-
-        std::string IpPort = client_ip;
-        IpPort += ":";
-        IpPort += std::to_string(ntohs(client_addr.sin_port));
+        HandleDatagram(serverSock, reassembler, message, buffer, bytes_received, client_addr);
+    }
+}
 
-        if (buffer[0] == C_REQ_CONNECT)
+void HandleDatagram(TRANSPORT::Transport& serverSock, FRAGMENT::Reassembler& reassembler, std::string& message,
+    const char* buffer, int bytes_received, sockaddr_in const& client_addr)
+{
+    PROFILE_ZONE("receive");
+    if (buffer[0] == C_FRAGMENT)
+    {
+        // piece of a larger message, handle it once every piece is here
+        unsigned long long peer = ((unsigned long long)client_addr.sin_addr.s_addr << 16) | client_addr.sin_port;
+        if (reassembler.Add(peer, buffer, bytes_received, appTime, message))
         {
-            if (clients.size() < TOTAL_PLAYERS)
-            {
-                std::pair<std::string, int> newIndex{};
-
-                {
-                    std::lock_guard<std::mutex> lock(Mutex);
-                    newIndex = std::pair<std::string, int>(IpPort, (int)clients.size());
-                    playersIndex.insert(newIndex);
-
-                    std::pair<std::string, sockaddr_in> newClient(IpPort, client_addr);
-                    clients.insert(newClient);
-                }
+            HandlePacket(serverSock, message.data(), (int)message.size(), client_addr);
+        }
+        return;
+    }
 
-                std::string message{};
-                message += C_RSP_CONNECT;
+    // a batch holds several messages, anything else is handled as is
+    COALESCE::ForEach(buffer, bytes_received, [&](const char* data, int length) {
+        HandlePacket(serverSock, data, length, client_addr);
+    });
+}
 
-                int tmp = htonl(newIndex.second);
-                message.append((char*)(&tmp), (char*)(&tmp) + 4);
+// Handles one whole message from a client
+void HandlePacket(TRANSPORT::Transport& serverSock, const char* buffer, int bytes_received, sockaddr_in client_addr)
+{
+    // drop anything too short to parse
+    if (bytes_received < 1 || bytes_received < MinimumSize((unsigned char)buffer[0]))
+    {
+        return;
+    }
+    TRACE_SCOPE_ARG("packet", (unsigned char)buffer[0]);
 
-                sendto(serverSock, message.c_str(), (int)message.length(), 0, reinterpret_cast<sockaddr*>(&client_addr), sizeof(client_addr));
+    char client_ip[INET_ADDRSTRLEN];
+    inet_ntop(AF_INET, &client_addr.sin_addr, client_ip, INET_ADDRSTRLEN);
 
-                if (clients.size() == TOTAL_PLAYERS)
-                {
-                    game_start = true;
-                    appTime = 0;
+    std::string IpPort = client_ip;
+    IpPort += ":";
+    IpPort += std::to_string(ntohs(client_addr.sin_port));
 
-                    // send all clients
-                  /*  for (auto& client : clients)
-                    {
-                        sendto(serverSock, message.c_str(), (int)message.length(), 0, reinterpret_cast<sockaddr*>(&client.second), sizeof(client.second));
-                    }*/
-                }
-            }
-        }
+    double now = CONNECTION::Now();
 
-        // Player fire
-        if (buffer[0] == C_REQ_FIRE)
+    if (buffer[0] == C_REQ_CONNECT)
+    {
+        // stateless challenge first, a slot is only given to an address that can receive
+        unsigned int cookie = ntohl(*(uint32_t*)(buffer + 1));
+        unsigned int session = ntohl(*(uint32_t*)(buffer + 5));
+        if (!CONNECTION::CheckCookie(cookie, client_addr.sin_addr.s_addr, client_addr.sin_port, now))
         {
-            int tmpId{};
-            // find player ID who sent
-
-            {
-                std::lock_guard<std::mutex> lock(Mutex);
-                for (auto& player : playersIndex)
-                {
-                    if (player.first == IpPort)
-                    {
-                        tmpId = player.second;
-                    }
-                }
-            }
-
-            float timestamp = ntohf(*(uint32_t*)(buffer + 1));
-
             std::string message{};
-            message += C_RSP_FIRE;
-
-            unsigned int tmp = htonf(appTime);
-            message.append((char*)(&tmp), (char*)(&tmp) + 4);
+            message += C_CHALLENGE;
 
-            tmp = htonl(tmpId);
+            unsigned int tmp = htonl(CONNECTION::MakeCookie(client_addr.sin_addr.s_addr, client_addr.sin_port, now));
             message.append((char*)(&tmp), (char*)(&tmp) + 4);
-            
-            // Send to all that player ID fire
-            for (auto& ips : clients)
-            {
-                sendto(serverSock, message.c_str(), (int)message.length(), 0, reinterpret_cast<sockaddr*>(&ips.second), sizeof(ips.second));
-            }
 
-            Shoot(playersInfo[tmpId].go.t.pos, playersInfo[tmpId].go.t.rot, tmpId);
+            serverSock.SendTo(message.c_str(), (int)message.length(), client_addr);
+            return;
         }
 
-        // State update from client
-        // id - 1b, timestamp - 4b, pos - 8b, scale - 8b, rot - 4b, vel - 8b
-        if (buffer[0] == C_STATE_UPDATE)
+        int index{};
+        unsigned int slotSession{};
+        bool playing{ false };
         {
-            int tmpId{};
-            // find player ID who sent
+            CONTENTION::Lock lock{ Mutex };
+            // a retransmitted request gets the same answer again
+            index = slots.Find(IpPort);
+            if (index < 0)
             {
-                std::lock_guard<std::mutex> lock(Mutex);
-                for (auto& player : playersIndex)
+                bool resumed{ false };
+                index = slots.Acquire(IpPort, session, now, resumed);
+                if (index >= 0)
                 {
-                    if (player.first == IpPort)
+                    // the session may have been connected from another address
+                    auto old = std::find_if(playersIndex.begin(), playersIndex.end(), [index](auto const& p) { return p.second == index; });
+                    if (old != playersIndex.end())
                     {
-                        tmpId = player.second;
+                        RemoveClient(index, old->first);
                     }
+                    AddClient(index, IpPort, client_addr, resumed);
                 }
             }
-
-            latest_timestamp = ntohf(*(uint32_t*)(buffer + 1));
-
+            else
             {
-                std::lock_guard<std::mutex> lock(Mutex);
-                if (latest_timestamp > playersInfo[tmpId].timestamp)
-                {
-                    playersInfo[tmpId].timestamp = latest_timestamp;
-                }
-                else
-                {
-                    continue;
-                }
+                slots.Touch(index, now);
             }
 
-            AEVec2 pos{};
-            pos.x = ntohf(*(uint32_t*)(buffer + 5));
-            pos.y = ntohf(*(uint32_t*)(buffer + 9));
+            if (index >= 0)
+            {
+                slotSession = slots.Session(index);
+                playing = inMatch[index];
+            }
+        }
 
-            AEVec2 scale{};
-            scale.x = ntohf(*(uint32_t*)(buffer + 13));
-            scale.y = ntohf(*(uint32_t*)(buffer + 17));
+        std::string message{};
+        message += C_RSP_CONNECT;
 
-            float rot = ntohf(*(uint32_t*)(buffer + 21));
+        int tmp = htonl(index);
+        message.append((char*)(&tmp), (char*)(&tmp) + 4);
+        tmp = htonl(slotSession);
+        message.append((char*)(&tmp), (char*)(&tmp) + 4);
 
-            AEVec2 vel{};
-            vel.x = ntohf(*(uint32_t*)(buffer + 25));
-            vel.y = ntohf(*(uint32_t*)(buffer + 29));
+        serverSock.SendTo(message.c_str(), (int)message.length(), client_addr);
 
-            {
-                std::lock_guard<std::mutex> lock(Mutex);
-                playersInfo[tmpId].go.t.pos = pos;
-                playersInfo[tmpId].go.t.scale = scale;
-                playersInfo[tmpId].go.t.rot = rot;
-                playersInfo[tmpId].go.vel = vel;
-
-                // interpolate
-                InterpolateGameobject(playersInfo[tmpId].go, latest_timestamp);
-            }
+        if (playing && has_started)
+        {
+            // back into its running match, it missed everything since it dropped
+            CONTENTION::Lock lock{ Mutex };
+            SendMatchState(serverSock, client_addr);
         }
+        return;
+    }
 
+    // everything else has to come from a connected client
+    int tmpId{ -1 };
+    {
+        CONTENTION::Lock lock{ Mutex };
+        tmpId = slots.Find(IpPort);
+        if (tmpId >= 0)
+        {
+            slots.Touch(tmpId, now);
+        }
+    }
+    if (tmpId < 0)
+    {
+        return;
+    }
 
+    // a flood is dropped here, before it costs anything else
+    {
+        CONTENTION::Lock lock{ Mutex };
+        if (!packetBudget[tmpId].Take(now))
         {
-            //std::lock_guard<std::mutex> lock(Mutex); // RAII lock
-            //buffer[bytes_received] = '\0';
-            
-            //std::cout << "Received from " << IpPort << std::endl;
+            return;
         }
     }
-}
 
-// Sender thread function
-void SendThread(SOCKET serverSocket) 
-{
-    while (keep_running) 
+    if (buffer[0] == C_KEEPALIVE)
     {
-        if (game_start)
+        std::string message{};
+        message += C_KEEPALIVE;
+        serverSock.SendTo(message.c_str(), (int)message.length(), client_addr);
+
+        // only waiting clients send keepalives, one that is in a running match missed its start
+        CONTENTION::Lock lock{ Mutex };
+        if (inMatch[tmpId] && has_started)
         {
-            if (!has_started)
-            {
-                std::string message{};
-                message += C_GAME_START;
+            SendMatchState(serverSock, client_addr);
+        }
+        return;
+    }
 
-                for (auto client : clients)
-                {
-                    int bytes_sent = sendto(serverSocket, message.c_str(), (int)message.length(), 0, reinterpret_cast<sockaddr*>(&client.second), sizeof(client.second));
-                    if (bytes_sent == SOCKET_ERROR)
-                    {
-                        std::lock_guard<std::mutex> lock(Mutex);
-                        std::cerr << "Sendto failed: " << WSAGetLastError() << std::endl;
-                    }
-                    else {
-                        char client_ip[INET_ADDRSTRLEN];
-                        inet_ntop(AF_INET, &client.second.sin_addr, client_ip, INET_ADDRSTRLEN);
-                        std::lock_guard<std::mutex> lock(Mutex);
-                        std::cout << "Game start sent to " << client.first << " - " << message << std::endl;
-                    }
-                }
+    if (buffer[0] == C_DISCONNECT)
+    {
+        CONTENTION::Lock lock{ Mutex };
+        RemoveClient(tmpId, IpPort);
+        slots.Release(tmpId, now, false);
+        PlayerEvent(DETERMINISM::I_QUIT, tmpId);
+        return;
+    }
 
-                has_started = true;
-            }
+    // still waiting in the queue, nothing to play with
+    if (!inMatch[tmpId])
+    {
+        return;
+    }
 
-            else
-            {
-                std::this_thread::sleep_for(std::chrono::milliseconds(UPDATE_RATE));
+    // Player fire, carries the client's latest input frames so a lost one is recovered from the next packet
+    if (buffer[0] == C_REQ_FIRE)
+    {
+        ApplyInputs(serverSock, tmpId, buffer + 1, bytes_received - 1);
+        return;
+    }
 
-                std::string message{};
-                message += C_ALL_UPDATE;
+    // State update from client
+    // id - 1b, timestamp - 4b, pos - 8b, scale - 8b, rot - 4b, vel - 8b, echo - 4b, input frames
+    if (buffer[0] == C_STATE_UPDATE)
+    {
+        // inputs first, a state that is out of date can still carry frames whose own packet was lost
+        if (bytes_received > STATE_UPDATE_INPUTS)
+        {
+            ApplyInputs(serverSock, tmpId, buffer + STATE_UPDATE_INPUTS, bytes_received - STATE_UPDATE_INPUTS);
+        }
 
-                // timestamp
-                unsigned int tmp = htonf(appTime);
-                message.append((char*)(&tmp), (char*)(&tmp) + 4);
+        latest_timestamp = ntohf(*(uint32_t*)(buffer + 1));
+        if (!std::isfinite(latest_timestamp))
+        {
+            return;
+        }
 
-                // send pos, scale, rot, vel by order of player index 
-                {
-                    std::lock_guard<std::mutex> lock(Mutex);
-                    for (auto& player : playersInfo)
-                    {
-                        tmp = htonf(player.go.t.pos.x);
-                        message.append((char*)(&tmp), (char*)(&tmp) + 4);
-                        tmp = htonf(player.go.t.pos.y);
-                        message.append((char*)(&tmp), (char*)(&tmp) + 4);
-
-                        tmp = htonf(player.go.t.scale.x);
-                        message.append((char*)(&tmp), (char*)(&tmp) + 4);
-                        tmp = htonf(player.go.t.scale.y);
-                        message.append((char*)(&tmp), (char*)(&tmp) + 4);
-
-                        tmp = htonf(player.go.t.rot);
-                        message.append((char*)(&tmp), (char*)(&tmp) + 4);
-
-                        tmp = htonf(player.go.vel.x);
-                        message.append((char*)(&tmp), (char*)(&tmp) + 4);
-                        tmp = htonf(player.go.vel.y);
-                        message.append((char*)(&tmp), (char*)(&tmp) + 4);
-                    }
-                }
+        {
+            CONTENTION::Lock lock{ Mutex };
+            if (latest_timestamp > playersInfo[tmpId].timestamp)
+            {
+                playersInfo[tmpId].timestamp = latest_timestamp;
+                timestampRecvTime[tmpId] = appTime;
 
-                // sending to clients
+                // rtt from our own timestamp echoed back by the client
+                if (bytes_received >= STATE_UPDATE_INPUTS)
                 {
-                    std::lock_guard<std::mutex> lock(Mutex);
-                    for (auto client : clients)
+                    float echo = ntohf(*(uint32_t*)(buffer + 33));
+                    if (echo > 0.f)
                     {
-                        int bytes_sent = sendto(serverSocket, message.c_str(), (int)message.length(), 0, reinterpret_cast<sockaddr*>(&client.second), sizeof(client.second));
-                        if (bytes_sent == SOCKET_ERROR)
-                        {
-                            std::lock_guard<std::mutex> lock(Mutex);
-                            std::cerr << "Sendto failed: " << WSAGetLastError() << std::endl;
-                        }
-                        else {
-                            char client_ip[INET_ADDRSTRLEN];
-                            inet_ntop(AF_INET, &client.second.sin_addr, client_ip, INET_ADDRSTRLEN);
-                            //std::lock_guard<std::mutex> lock(Mutex);
-                            //std::cout << "Update All sent to " << client.first << " - " << message << std::endl;
-                        }
+                        sendRates[tmpId].OnRttSample(appTime - echo, appTime);
+                        rttHistogram.Add(appTime - echo);
                     }
                 }
+            }
+            else
+            {
+                staleStates.Add();
+                return;
+            }
+        }
 
+        Transform t{};
+        AEVec2 vel{};
+        MESSAGE::ReadBody(buffer + 5, t, vel);
 
-                // time sync every 1 min
-                if (std::fmod(appTime,TIME_SYNC) < 0.005f && game_start)
-                {
-                    std::string message{};
-                    message += C_TIME_SYNC;
+        // only what a real client could have sent, scale is locked and speed capped
+        if (!VALIDATION::SanitizeState(t, vel))
+        {
+            return;
+        }
+        AEVec2 pos = t.pos;
+        AEVec2 scale = t.scale;
+        float rot = t.rot;
 
-                    // timestamp
-                    unsigned int tmp = htonf(appTime);
-                    message.append((char*)(&tmp), (char*)(&tmp) + 4);
+        {
+            CONTENTION::Lock lock{ Mutex };
 
-                    // send pos, scale, rot, vel by order of player index 
-                    {
-                        std::lock_guard<std::mutex> lock(Mutex);
-                        for (auto& player : playersInfo)
-                        {
-                            tmp = htonf(player.go.t.pos.x);
-                            message.append((char*)(&tmp), (char*)(&tmp) + 4);
-                            tmp = htonf(player.go.t.pos.y);
-                            message.append((char*)(&tmp), (char*)(&tmp) + 4);
-
-                            tmp = htonf(player.go.t.scale.x);
-                            message.append((char*)(&tmp), (char*)(&tmp) + 4);
-                            tmp = htonf(player.go.t.scale.y);
-                            message.append((char*)(&tmp), (char*)(&tmp) + 4);
-
-                            tmp = htonf(player.go.t.rot);
-                            message.append((char*)(&tmp), (char*)(&tmp) + 4);
-
-                            tmp = htonf(player.go.vel.x);
-                            message.append((char*)(&tmp), (char*)(&tmp) + 4);
-                            tmp = htonf(player.go.vel.y);
-                            message.append((char*)(&tmp), (char*)(&tmp) + 4);
-                        }
-                    }
+            // no further than the ship could have flown since the last update
+            if (VALIDATION::LimitMove(lastMove[tmpId], pos, latest_timestamp, appTime, screen))
+            {
+                clampedMoves.Add();
+            }
 
-                    // sending to clients
-                    {
-                        std::lock_guard<std::mutex> lock(Mutex);
-                        for (auto client : clients)
-                        {
-                            int bytes_sent = sendto(serverSocket, message.c_str(), (int)message.length(), 0, reinterpret_cast<sockaddr*>(&client.second), sizeof(client.second));
-                            if (bytes_sent == SOCKET_ERROR)
-                            {
-                                std::lock_guard<std::mutex> lock(Mutex);
-                                std::cerr << "Sendto failed: " << WSAGetLastError() << std::endl;
-                            }
-                            else {
-                                char client_ip[INET_ADDRSTRLEN];
-                                inet_ntop(AF_INET, &client.second.sin_addr, client_ip, INET_ADDRSTRLEN);
-                                //std::lock_guard<std::mutex> lock(Mutex);
-                                //std::cout << "Update All sent to " << client.first << " - " << message << std::endl;
-                            }
-                        }
-                    }
-                }
+            if (deterministic)
+            {
+                // applied by the next tick along with everyone else's
+                pendingInputs.push_back(DETERMINISM::Input{ DETERMINISM::I_STATE, tmpId, latest_timestamp, 0, { pos, scale, rot }, vel });
+                return;
             }
+            playersInfo[tmpId].go.t.pos = pos;
+            playersInfo[tmpId].go.t.scale = scale;
+            playersInfo[tmpId].go.t.rot = rot;
+            playersInfo[tmpId].go.vel = vel;
+
+            // interpolate
+            InterpolateGameobject(playersInfo[tmpId].go, latest_timestamp);
         }
     }
 }
 
-void InterpolateGameobject(GameObject& go, float timestamp) {
-    float deltaTime = appTime - timestamp;
-    go.t.pos.x += go.vel.x * deltaTime;
-    go.t.pos.y += go.vel.y * deltaTime;
-}
-
-//player shooting bullet logic - returns ref to the bullet that was shot
-Bullet& Shoot(AEVec2 const& pos, float angle, int playerID)
+// Applies the input frames this player has not sent before, oldest first
+void ApplyInputs(TRANSPORT::Transport& serverSock, int tmpId, const char* block, int length)
 {
-    float rad{ AEDegToRad(angle) };
-    AEVec2 vel{ cosf(rad) * BULLET_SPEED, sinf(rad) * BULLET_SPEED };
-    //bullet - go, lifetime, isactive
-    Bullet tmp{ { { pos, { 10.f, 10.f }, angle }, vel, "bullet", playersInfo[playerID].go.col, true}, 1.f, playerID };
-    //finds non active bullet in list to replace
-    for (auto& b : bulletlist)
+    thread_local std::vector<INPUTFRAME::Frame> frames{};
+    thread_local std::vector<INPUTFRAME::Frame> fresh{};
+    if (INPUTFRAME::Read(block, length, frames) < 0)
     {
-        if (!b.go.isActive)
-        {
-            b = tmp;
-            return b;
-        }
+        return;
     }
-    bulletlist.push_back(tmp);
-
-    return bulletlist.back();
-}
-
-float RandomFloat(std::mt19937& rng, float min, float max)
+    {
+        CONTENTION::Lock lock{ Mutex };
+        if (deterministic)
+        {
+            // every fire frame, repeats too. the tick passes them through the receiver so its seq is part of the simulation
+            for (INPUTFRAME::Frame const& frame : frames)
+            {
+                if (frame.flags & INPUTFRAME::F_FIRE)
+                {
+                    pendingInputs.push_back(DETERMINISM::Input{ DETERMINISM::I_FIRE, tmpId, frame.timestamp, frame.seq, {}, {} });
+                }
+            }
+            return;
+        }
+        inputReceivers[tmpId].Accept(frames, fresh);
+    }
+    for (INPUTFRAME::Frame const& frame : fresh)
+    {
+        if (frame.flags & INPUTFRAME::F_FIRE)
+        {
+            ApplyFire(serverSock, tmpId, frame.timestamp);
+        }
+    }
+}
+
+// Deterministic mode: the inputs held since the last tick, in DETERMINISM::Order
+void ApplyPendingInputs(TRANSPORT::Transport& serverSock)
 {
-    std::uniform_real_distribution<float> uf(min, max);
-    return uf(rng);
+    {
+        CONTENTION::Lock lock{ Mutex };
+        tickInputs.swap(pendingInputs);
+        pendingInputs.clear();
+    }
+    DETERMINISM::Order(tickInputs);
+
+    // a fire frame the player sent before is dropped here and left out of the log
+    size_t applied{ 0 };
+    for (size_t i = 0; i < tickInputs.size(); ++i)
+    {
+        DETERMINISM::Input const& input = tickInputs[i];
+        if (input.kind == DETERMINISM::I_FIRE)
+        {
+            bool fresh{};
+            {
+                CONTENTION::Lock lock{ Mutex };
+                fresh = inputReceivers[input.player].Accept(input.seq);
+            }
+            if (!fresh)
+            {
+                continue;
+            }
+            ApplyFire(serverSock, input.player, input.timestamp);
+        }
+        else if (input.kind == DETERMINISM::I_STATE)
+        {
+            CONTENTION::Lock lock{ Mutex };
+            playersInfo[input.player].go.t = input.t;
+            playersInfo[input.player].go.vel = input.vel;
+            InterpolateGameobject(playersInfo[input.player].go, input.timestamp);
+        }
+        else
+        {
+            CONTENTION::Lock lock{ Mutex };
+            ApplyPlayerEvent(input);
+        }
+        tickInputs[applied++] = input;
+    }
+    tickInputs.resize(applied);
 }
-int RandomInt(std::mt19937& rng, int min, int max)
+
+// Applies the simulation's part of a player connecting, leaving or joining. Deterministic mode also
+// queues it, the next tick applies it again in its place among the inputs and logs it. Mutex must be held
+void PlayerEvent(DETERMINISM::InputKind kind, int index)
 {
-    std::uniform_int_distribution<int> ui(min, max);
-    return ui(rng);
+    unsigned int seq = kind == DETERMINISM::I_JOIN ? inputReceivers[index].LastSeq() : 0;
+    DETERMINISM::Input event{ kind, index, appTime, seq, {}, {} };
+    ApplyPlayerEvent(event);
+    if (deterministic)
+    {
+        pendingInputs.push_back(event);
+    }
 }
 
-GameObject& SpawnAsteroid() {
-    //init the random number engine
-    //static std::random_device rd;
-    static std::mt19937 rng(1);	//seed 1
-    enum SpawnLocation : int
+// Everything of a player event that is hashed. Mutex must be held
+void ApplyPlayerEvent(DETERMINISM::Input const& event)
+{
+    int index = event.player;
+    switch (event.kind)
     {
-        UP = 0,
-        DOWN = 1,
-        LEFT = 2,
-        RIGHT = 3
-    };
+    case DETERMINISM::I_CONNECT:
+        // someone new, out of any match until the queue puts them in
+        playersInfo[index].score = 0;
+        inMatch[index] = false;
+        lastFireTime[index] = -VALIDATION::FIRE_COOLDOWN;
+        inputReceivers[index].Reset();
+        break;
+    case DETERMINISM::I_RESUME:
+        // the new connection's clock and seq start over
+        lastFireTime[index] = -VALIDATION::FIRE_COOLDOWN;
+        inputReceivers[index].Reset();
+        break;
+    case DETERMINISM::I_JOIN:
+        inMatch[index] = true;
+        playersInfo[index].score = 0;
+        playersInfo[index].go.t.pos = {};
+        playersInfo[index].go.vel = {};
+        lastFireTime[index] = event.timestamp - VALIDATION::FIRE_COOLDOWN;
+        inputReceivers[index].Restore(event.seq);
+        break;
+    case DETERMINISM::I_LEAVE:
+        playersInfo[index].go.vel = {};
+        break;
+    case DETERMINISM::I_QUIT:
+        inMatch[index] = false;
+        break;
+    default:
+        break;
+    }
+}
 
-    int sl{ RandomInt(rng, UP, RIGHT) };
-    float radius{ RandomFloat(rng, ASTEROID_MIN_SIZE, ASTEROID_MAX_SIZE) };
-    GameObject asteroid{ {{0.f, 0.f},{radius, radius}, RandomFloat(rng, 0.f, 359.f)}, {}, "asteroid", {0.f, 0.f, 0.f, 1.f}, true };
-    switch (sl)
+// Deterministic mode: every bit of the simulation, taken after a tick
+unsigned long long HashState()
+{
+    CONTENTION::Lock lock{ Mutex };
+    DETERMINISM::StateHash hash{};
+    hash.Add(appTime);
+    hash.Add(timer);
+    hash.Add(spawnCountDown);
+    hash.Add(asteroidsSpawned);
+    for (int i = 0; i < MAX_PLAYERS; i++)
     {
-    case UP:
-        //spawn TOP region, moving downwards prio
+        hash.Add(inMatch[i]);
+        hash.Add(playersInfo[i].score);
+        hash.Add(playersInfo[i].go);
+        hash.Add(lastFireTime[i]);
+        // only a join sets the seq of a match, the queue keeps whatever the last one left
+        hash.Add(inMatch[i] ? inputReceivers[i].LastSeq() : 0u);
+    }
+    for (GameObject const& a : golist)
     {
-        asteroid.t.pos.x = RandomFloat(rng, -screen.x * 0.5f, screen.x * 0.5f);
-        asteroid.t.pos.y = screen.y * 0.5f + radius;
-        float hSpeed{ ASTEROID_MOVE_SPEED * 0.4f };
-        asteroid.vel.x = RandomFloat(rng, -hSpeed, hSpeed);
-        asteroid.vel.y = -1.f * (ASTEROID_MOVE_SPEED - hSpeed);
+        hash.Add(a);
     }
-    break;
-    case DOWN:
-        //spawn BTM region, moving upwards prio
+    for (Bullet const& b : bulletlist)
     {
-        asteroid.t.pos.x = RandomFloat(rng, -screen.x * 0.5f, screen.x * 0.5f);
-        asteroid.t.pos.y = -screen.y * 0.5f - radius;
-        float hSpeed{ ASTEROID_MOVE_SPEED * 0.4f };
-        asteroid.vel.x = RandomFloat(rng, -hSpeed, hSpeed);
-        asteroid.vel.y = ASTEROID_MOVE_SPEED - hSpeed;
+        hash.Add(b.go);
+        hash.Add(b.lifeTime);
+        hash.Add(b.playerNO);
     }
-    break;
-    case LEFT:
-        //spawn LEFT region, moving right prio
+    LAGCOMP::Hash(hash);
+    return hash.Value();
+}
+
+// Deterministic mode: a new match fed the inputs of log tick by tick, nothing else comes in
+int ReplayMatch(TRANSPORT::Transport& serverSock, DETERMINISM::TickLog const& log)
+{
     {
-        asteroid.t.pos.x = -screen.x * 0.5f - radius;
-        asteroid.t.pos.y = RandomFloat(rng, -screen.y * 0.5f, screen.y * 0.5f);
-        float vSpeed{ ASTEROID_MOVE_SPEED * 0.4f };
-        asteroid.vel.y = RandomFloat(rng, -vSpeed, vSpeed);
-        asteroid.vel.x = ASTEROID_MOVE_SPEED - vSpeed;
+        CONTENTION::Lock lock{ Mutex };
+        StartMatch({});
     }
-    break;
-    case RIGHT:
-        //spawn RIGHT region, moving left prio
+    for (size_t tick = 0; tick < log.Ticks(); ++tick)
     {
-        asteroid.t.pos.x = screen.x * 0.5f + radius;
-        asteroid.t.pos.y = RandomFloat(rng, -screen.y * 0.5f, screen.y * 0.5f);
-        float vSpeed{ ASTEROID_MOVE_SPEED * 0.4f };
-        asteroid.vel.y = RandomFloat(rng, -vSpeed, vSpeed);
-        asteroid.vel.x = -1.f * (ASTEROID_MOVE_SPEED - vSpeed);
+        {
+            CONTENTION::Lock lock{ Mutex };
+            log.Inputs(tick, pendingInputs);
+        }
+        ServerTick(serverSock, FIXED_DT);
+        if (matchLog.Hash(tick) != log.Hash(tick))
+        {
+            return (int)tick;
+        }
     }
-    break;
+    return -1;
+}
+
+// Player fire at the client's timestamp
+void ApplyFire(TRANSPORT::Transport& serverSock, int tmpId, float timestamp)
+{
+    if (!std::isfinite(timestamp))
+    {
+        return;
     }
 
-    //find inactive in golist to replace, if no space pushback
-    for (GameObject& go : golist)
+    // resolve the shot from where the shooter was when they fired
+    LAGCOMP::ShotResult shot{};
+    int bulletIndex{ -1 };
+    bool destroyed{ false };
     {
-        if (!go.isActive && go.texid != "player")
+        CONTENTION::Lock lock{ Mutex };
+
+        // the client's cooldown and bullet count are enforced here, a claimed fire time can only be rewound so far
+        float fireTime = std::clamp(timestamp, appTime - LAGCOMP::MAX_REWIND, appTime);
+        if (VALIDATION::ActiveBullets(bulletlist.Items(), tmpId) >= VALIDATION::MAX_BULLETS_PER_PLAYER ||
+            !VALIDATION::AllowFire(lastFireTime[tmpId], fireTime))
+        {
+            return;
+        }
+
+        bulletIndex = Shoot(playersInfo[tmpId].go.t.pos, playersInfo[tmpId].go.t.rot, tmpId);
+        if (bulletIndex < 0)
+        {
+            return;
+        }
+        Bullet& bullet = bulletlist[bulletIndex];
+        shot = LAGCOMP::ResolveShot(timestamp, appTime, tmpId, bullet.go, bullet.lifeTime);
+        if (shot.hitIndex >= 0)
         {
-            go = asteroid;
-            return go;
+            // bullet is used up in the past, only score if that same asteroid is still alive now,
+            // a slot reused by a newer asteroid since the fire time has another generation
+            bullet.go.isActive = false;
+            bulletlist.Release(bulletIndex);
+            GameObject& go = golist[shot.hitIndex];
+            if (go.isActive && go.texid == ASSET::A_ASTEROID && golist.Generation(shot.hitIndex) == shot.hitGeneration)
+            {
+                go.isActive = false;
+                playersInfo[tmpId].score += SCORE_PER_ASTEROID;
+                destroyed = true;
+            }
         }
+        else
+        {
+            bullet.go = shot.bullet;
+            bullet.lifeTime = shot.lifeTime;
+        }
+    }
+    if (destroyed)
+    {
+        Destroy_Asteroids(serverSock, shot.hitIndex);
+    }
+    // the bullet was used up in the past and its slot is free again, clients never see it
+    if (shot.hitIndex >= 0)
+    {
+        return;
+    }
+
+    std::string message{};
+    message += C_RSP_FIRE;
+
+    // clients interpolate the bullet from the rewound fire time
+    unsigned int tmp = htonf(shot.fireTime);
+    message.append((char*)(&tmp), (char*)(&tmp) + 4);
+
+    tmp = htonl(tmpId);
+    message.append((char*)(&tmp), (char*)(&tmp) + 4);
+
+    unsigned short index = htons((unsigned short)bulletIndex);
+    message.append((char*)(&index), (char*)(&index) + 2);
+    
+    // Send to all that player ID fire, goes out with the rest of this tick's events
+    {
+        CONTENTION::Lock lock{ Mutex };
+        QueueBroadcast(serverSock, message);
     }
-    golist.push_back(asteroid);
-    return golist.back();
 }
 
-//collision check
-void SimpleDynamicCollisionCheck(float dt, SOCKET serverSocket)
+// Sender thread function
+void SendThread(TRANSPORT::Transport& serverSocket) 
 {
-    //Player& player = playersInfo[];
-    //check if player hit an asteroid
-    for (int i = 0; i < golist.size(); i++)
+    TRACE::NameThread("send");
+    while (keep_running) 
     {
-        GameObject& go = golist[i];
-        if (!go.isActive || go.texid != "asteroid") {
+        // drop clients that stopped talking, in the lobby as well as in game
+        ExpireClients();
+
+        // between matches there is nothing to send
+        if (!game_start)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(SEND_TICK));
             continue;
         }
-        for(auto& player : playersInfo)
+
+        if (!has_started)
         {
-            if (COLLISION::IsWithinDistanceCheckDynamic(player.go, go, dt))
-            {
-                player.score -= NEG_SCORE_PER_HIT;
-                go.isActive = false;
-                Destroy_Asteroids(serverSocket, i);
-            }
+            SendGameStart(serverSocket);
+        }
+        else
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(SEND_TICK));
+            SendUpdates(serverSocket);
         }
     }
+}
+
+// C_GAME_START to everyone in the match that is waiting for it
+void SendGameStart(TRANSPORT::Transport& serverSocket)
+{
+    PROFILE_ZONE("send.gamestart");
+    std::string message{};
+    message += C_GAME_START;
 
-    //check if any bullet hit an asteroid
-    for (Bullet& b : bulletlist)
+    // players that joined before the start get it from here, later ones from JoinMatch
+    CONTENTION::Lock lock{ Mutex };
+    for (auto client : clients)
     {
-        if (!b.go.isActive) {
+        if (!inMatch[playersIndex[client.first]])
+        {
             continue;
         }
-        for (int i =0; i<golist.size();i++)
+        int bytes_sent = serverSocket.SendTo(message.c_str(), (int)message.length(), client.second);
+        if (bytes_sent == SOCKET_ERROR)
         {
-            GameObject& go = golist[i];
-            if (!go.isActive || go.texid != "asteroid") {
-                continue;
-            }
-            if (COLLISION::IsWithinDistanceCheckDynamic(b.go, go, dt))
+            std::lock_guard<std::mutex> usersLock{ _stdoutMutex };
+            std::cerr << "Sendto failed: " << WSAGetLastError() << std::endl;
+        }
+        else {
+            char client_ip[INET_ADDRSTRLEN];
+            inet_ntop(AF_INET, &client.second.sin_addr, client_ip, INET_ADDRSTRLEN);
+            std::lock_guard<std::mutex> usersLock{ _stdoutMutex };
+            std::cout << "Game start sent to " << client.first << " - " << message << std::endl;
+        }
+    }
+
+    has_started = true;
+}
+
+// C_ALL_UPDATE to every client that is due one, and C_TIME_SYNC to everyone in the match every TIME_SYNC seconds
+void SendUpdates(TRANSPORT::Transport& serverSocket)
+{
+    PROFILE_ZONE("send.updates");
+    {
+        CONTENTION::Lock lock{ Mutex };
+        float now = appTime;
+
+        // each client has its own rate, skip building the update until one is due
+        bool anyDue{ false };
+        for (auto& client : clients)
+        {
+            int id = playersIndex[client.first];
+            if (inMatch[id] && now >= nextSendTime[id])
             {
-                b.go.isActive = go.isActive = false;
-                playersInfo[b.playerNO].score += SCORE_PER_ASTEROID;
-                Destroy_Asteroids(serverSocket, i);
+                anyDue = true;
                 break;
             }
         }
+
+        if (anyDue)
+        {
+            std::string message{};
+            message += C_ALL_UPDATE;
+
+            // timestamp
+            unsigned int tmp = htonf(now);
+            message.append((char*)(&tmp), (char*)(&tmp) + 4);
+
+            // send pos, scale, rot, vel by order of player index 
+            for (auto& player : playersInfo)
+            {
+                MESSAGE::AppendBody(message, player.go);
+            }
+
+            // sending to clients that are due, each with the echo of its own timestamp
+            const size_t bodySize = message.size();
+            for (auto& client : clients)
+            {
+                int id = playersIndex[client.first];
+                if (!inMatch[id] || now < nextSendTime[id])
+                {
+                    continue;
+                }
+
+                float echo{};
+                if (playersInfo[id].timestamp > 0.f)
+                {
+                    echo = playersInfo[id].timestamp + (now - timestampRecvTime[id]);
+                }
+                message.resize(bodySize);
+                tmp = htonf(echo);
+                message.append((char*)(&tmp), (char*)(&tmp) + 4);
+
+                // most important asteroids and bullets for this client, packed within the budget
+                REPLICATION::Accumulate(replication[id], playersInfo[id].go.t.pos, golist.Items(), bulletlist.Items(), now - lastReplicationTime[id]);
+                lastReplicationTime[id] = now;
+                std::string entities = REPLICATION::Build(replication[id], golist.Items(), bulletlist.Items(), now);
+
+                // update, entities and any events waiting for this client share a datagram where they fit
+                int bytes_sent = QueueMessage(serverSocket, message, client.first);
+                if (bytes_sent != SOCKET_ERROR && !entities.empty())
+                {
+                    int more = QueueMessage(serverSocket, entities, client.first);
+                    bytes_sent = (more == SOCKET_ERROR) ? SOCKET_ERROR : bytes_sent + more;
+                }
+                if (bytes_sent != SOCKET_ERROR)
+                {
+                    int more = FlushMessages(serverSocket, client.first);
+                    bytes_sent = (more == SOCKET_ERROR) ? SOCKET_ERROR : bytes_sent + more;
+                }
+
+                if (bytes_sent == SOCKET_ERROR)
+                {
+                    int errorCode = WSAGetLastError();
+                    if (errorCode == WSAEWOULDBLOCK)
+                    {
+                        // socket buffer is full, back off this client
+                        sendRates[id].OnSendFailed(now);
+                    }
+                    else
+                    {
+                        std::lock_guard<std::mutex> usersLock{ _stdoutMutex };
+                        std::cerr << "Sendto failed: " << errorCode << std::endl;
+                    }
+                }
+                nextSendTime[id] = now + sendRates[id].Interval();
+            }
+        }
+    }
+
+    // time sync every 1 min, the send thread wakes several times per frame so only once per window
+    static float lastTimeSync{ -TIME_SYNC };
+    if (std::fmod(appTime,TIME_SYNC) < 0.005f && game_start && appTime - lastTimeSync > 1.f)
+    {
+        lastTimeSync = appTime;
+        std::string message{};
+        message += C_TIME_SYNC;
+
+        // timestamp
+        unsigned int tmp = htonf(appTime);
+        message.append((char*)(&tmp), (char*)(&tmp) + 4);
+
+        // send pos, scale, rot, vel by order of player index 
+        {
+            CONTENTION::Lock lock{ Mutex };
+            for (auto& player : playersInfo)
+            {
+                MESSAGE::AppendBody(message, player.go);
+            }
+        }
+
+        // sending to clients
+        {
+            CONTENTION::Lock lock{ Mutex };
+            for (auto client : clients)
+            {
+                if (!inMatch[playersIndex[client.first]])
+                {
+                    continue;
+                }
+                int bytes_sent = serverSocket.SendTo(message.c_str(), (int)message.length(), client.second);
+                if (bytes_sent == SOCKET_ERROR)
+                {
+                    std::lock_guard<std::mutex> usersLock{ _stdoutMutex };
+                    std::cerr << "Sendto failed: " << WSAGetLastError() << std::endl;
+                }
+                else {
+                    char client_ip[INET_ADDRSTRLEN];
+                    inet_ntop(AF_INET, &client.second.sin_addr, client_ip, INET_ADDRSTRLEN);
+                    //std::lock_guard<std::mutex> lock(Mutex);
+                    //std::cout << "Update All sent to " << client.first << " - " << message << std::endl;
+                }
+            }
+        }
     }
 }
 
-void Spawn_Asteroids(SOCKET serverSock)
+// Sends a message of any size, fragmenting it when it is above the mtu. returns bytes sent or SOCKET_ERROR
+int SendFragmented(TRANSPORT::Transport& serverSock, std::string const& message, sockaddr_in const& addr)
 {
-    std::lock_guard<std::mutex> lock(Mutex);
+    int total{};
+    for (std::string const& datagram : FRAGMENT::Split(message))
+    {
+        int bytes_sent = serverSock.SendTo(datagram.c_str(), (int)datagram.length(), addr);
+        if (bytes_sent == SOCKET_ERROR)
+        {
+            return SOCKET_ERROR;
+        }
+        total += bytes_sent;
+    }
+    return total;
+}
+
+// Queues a message for a client, it is sent together with the client's other messages on the next flush.
+// Mutex must be held. returns bytes that had to be sent right away to make room, or SOCKET_ERROR
+int QueueMessage(TRANSPORT::Transport& serverSock, std::string const& message, std::string const& ipPort)
+{
+    static std::vector<std::string> ready{};
+    auto client = clients.find(ipPort);
+    if (client == clients.end())
+    {
+        return 0;
+    }
+
+    ready.clear();
+    outgoing[ipPort].Add(message, ready);
+
+    int total{};
+    for (std::string const& datagram : ready)
+    {
+        int bytes_sent = SendFragmented(serverSock, datagram, client->second);
+        if (bytes_sent == SOCKET_ERROR)
+        {
+            return SOCKET_ERROR;
+        }
+        total += bytes_sent;
+    }
+    return total;
+}
+
+// Queues a message for every client in the match. Mutex must be held
+void QueueBroadcast(TRANSPORT::Transport& serverSock, std::string const& message)
+{
+    for (auto& client : clients)
+    {
+        if (inMatch[playersIndex[client.first]])
+        {
+            QueueMessage(serverSock, message, client.first);
+        }
+    }
+}
+
+// Sends everything queued for a client. Mutex must be held. returns bytes sent or SOCKET_ERROR
+int FlushMessages(TRANSPORT::Transport& serverSock, std::string const& ipPort)
+{
+    static std::vector<std::string> ready{};
+    auto client = clients.find(ipPort);
+    auto queue = outgoing.find(ipPort);
+    if (client == clients.end() || queue == outgoing.end() || queue->second.Empty())
+    {
+        return 0;
+    }
+
+    ready.clear();
+    queue->second.Flush(ready);
+
+    int total{};
+    for (std::string const& datagram : ready)
+    {
+        int bytes_sent = SendFragmented(serverSock, datagram, client->second);
+        if (bytes_sent == SOCKET_ERROR)
+        {
+            return SOCKET_ERROR;
+        }
+        total += bytes_sent;
+    }
+    return total;
+}
+
+// Sends everything queued for every client, called once per tick. Mutex must be held
+void FlushAllMessages(TRANSPORT::Transport& serverSock)
+{
+    for (auto& client : clients)
+    {
+        FlushMessages(serverSock, client.first);
+    }
+}
+
+// Gives a client its player slot. Mutex must be held
+void AddClient(int index, std::string const& ipPort, sockaddr_in const& addr, bool resumed)
+{
+    clients[ipPort] = addr;
+    playersIndex[ipPort] = index;
+
+    // new connection knows nothing yet, and its clock starts over
+    REPLICATION::Reset(replication[index]);
+    lastReplicationTime[index] = appTime;
+    sendRates[index] = RateController(MIN_UPDATE_RATE / 1000.f, MAX_UPDATE_RATE / 1000.f, UPDATE_RATE / 1000.f);
+    nextSendTime[index] = appTime;
+    timestampRecvTime[index] = appTime;
+    playersInfo[index].timestamp = 0.f;
+    packetBudget[index].Reset(CONNECTION::Now());
+    VALIDATION::ResetMovement(lastMove[index], playersInfo[index].go.t.pos, appTime);
+    PlayerEvent(resumed ? DETERMINISM::I_RESUME : DETERMINISM::I_CONNECT, index);
+    playersConnected.Set((double)clients.size());
+    // a resumed player whose match is still on goes straight back in, everyone else waits
+    if (!inMatch[index])
+    {
+        matchQueue.Enqueue(index, CONNECTION::Now());
+    }
+
+    std::lock_guard<std::mutex> usersLock{ _stdoutMutex };
+    std::cout << "Player " << index << (resumed ? " reconnected from " : " connected from ") << ipPort << std::endl;
+}
+
+// Stops sending to a client, its slot is handled by the slot table. Mutex must be held
+void RemoveClient(int index, std::string const& ipPort)
+{
+    clients.erase(ipPort);
+    playersIndex.erase(ipPort);
+    outgoing.erase(ipPort);
+    matchQueue.Remove(index);
+    PlayerEvent(DETERMINISM::I_LEAVE, index);
+    playersConnected.Set((double)clients.size());
+
+    std::lock_guard<std::mutex> usersLock{ _stdoutMutex };
+    std::cout << "Player " << index << " disconnected from " << ipPort << std::endl;
+}
+
+// Whole match for a late joiner, regular updates take over after it. Mutex must be held
+std::string BuildFullState()
+{
+    static std::vector<SNAPSHOT::PlayerState> players{};
+    players.clear();
+    for (auto& player : playersInfo)
+    {
+        players.push_back({ player.go.t, player.go.vel, player.score });
+    }
+    return SNAPSHOT::Build({ appTime, timer, asteroidsSpawned }, players, golist.Items(), bulletlist.Items());
+}
+
+// Start and end of a match for a player that was not there for C_GAME_START. Mutex must be held
+void SendMatchState(TRANSPORT::Transport& serverSock, sockaddr_in const& addr)
+{
+    // sent under the lock so no event queued after the snapshot can overtake it
+    std::string message{};
+    message += C_GAME_START;
+    serverSock.SendTo(message.c_str(), (int)message.length(), addr);
+    SendFragmented(serverSock, BuildFullState(), addr);
+}
+
+// Forms a match from the queue while no match runs, otherwise tops the running one up
+void Matchmake(TRANSPORT::Transport& serverSock)
+{
+    PROFILE_ZONE("matchmake");
+    double now = CONNECTION::Now();
+    CONTENTION::Lock lock{ Mutex };
+    if (!game_start)
+    {
+        std::vector<int> players = matchQueue.FormMatch(now, matchPolicy);
+        if (!players.empty())
+        {
+            StartMatch(players);
+        }
+        return;
+    }
+
+    // every queued player holds one of the room's seats, so all of them fit
+    for (int index : matchQueue.Backfill(now, matchPolicy, timer))
+    {
+        JoinMatch(serverSock, index);
+    }
+}
+
+// Resets the room for a new match with players. Mutex must be held
+void StartMatch(std::vector<int> const& players)
+{
+    golist.Clear();
+    bulletlist.Clear();
+    timer = TOTAL_TIME;
+    appTime = 0;
+    asteroidsSpawned = 0;
+    asteroidRng.seed(ASTEROID_SEED);
+    spawnCountDown = 0.f;
+    LAGCOMP::Clear();
+    pendingInputs.clear();
+    tickInputs.clear();
+    matchLog.Clear();
+
+    for (int i = 0; i < MAX_PLAYERS; i++)
+    {
+        playersInfo[i].score = 0;
+        playersInfo[i].timestamp = 0.f;
+        playersInfo[i].go = SHIP_START;
+        REPLICATION::Reset(replication[i]);
+        sendRates[i] = RateController(MIN_UPDATE_RATE / 1000.f, MAX_UPDATE_RATE / 1000.f, UPDATE_RATE / 1000.f);
+        nextSendTime[i] = 0.f;
+        timestampRecvTime[i] = 0.f;
+        lastReplicationTime[i] = 0.f;
+        lastFireTime[i] = -VALIDATION::FIRE_COOLDOWN;
+        VALIDATION::ResetMovement(lastMove[i], playersInfo[i].go.t.pos, appTime);
+        inMatch[i] = false;
+    }
+    for (int index : players)
+    {
+        PlayerEvent(DETERMINISM::I_JOIN, index);
+    }
+
+    // C_GAME_START goes out from the send thread
+    has_started = false;
+    game_start = true;
+
+    MATCHMAKING::WaitStats const& stats = matchQueue.Stats();
+    std::lock_guard<std::mutex> usersLock{ _stdoutMutex };
+    std::cout << "Match started with " << players.size() << " players, " << matchQueue.Size() << " still queued. wait last "
+        << stats.last << "s avg " << (stats.count ? stats.total / stats.count : 0.0) << "s max " << stats.longest << "s" << std::endl;
+}
+
+// Adds a queued player to the running match. Mutex must be held
+void JoinMatch(TRANSPORT::Transport& serverSock, int index)
+{
+    PlayerEvent(DETERMINISM::I_JOIN, index);
+    REPLICATION::Reset(replication[index]);
+    lastReplicationTime[index] = appTime;
+    nextSendTime[index] = appTime;
+    VALIDATION::ResetMovement(lastMove[index], playersInfo[index].go.t.pos, appTime);
+
+    // before the start it gets C_GAME_START with everyone else
+    auto client = std::find_if(playersIndex.begin(), playersIndex.end(), [index](auto const& p) { return p.second == index; });
+    if (has_started && client != playersIndex.end())
+    {
+        SendMatchState(serverSock, clients[client->first]);
+    }
+
+    std::lock_guard<std::mutex> usersLock{ _stdoutMutex };
+    std::cout << "Player " << index << " joined the match, waited " << matchQueue.Stats().last << "s" << std::endl;
+}
+
+// Sends the results of the match and puts its players back in the queue
+void EndMatch(TRANSPORT::Transport& serverSock)
+{
+    CONTENTION::Lock lock{ Mutex };
+    game_start = false;
+    playersPlaying.Set(0.0);
+    asteroidsActive.Set(0.0);
+    bulletsActive.Set(0.0);
+    std::cout << " finish" << std::endl;
+    {
+        // how close the match came to the pool caps, overflows mean objects were recycled early
+        PoolStats const& a = golist.Stats();
+        PoolStats const& b = bulletlist.Stats();
+        std::lock_guard<std::mutex> usersLock{ _stdoutMutex };
+        std::cout << "asteroids peak " << a.peak << "/" << a.capacity << " overflows " << a.overflows
+            << ", bullets peak " << b.peak << "/" << b.capacity << " overflows " << b.overflows << std::endl;
+        // server observed rtt of everyone in the match, from the timestamps clients echo back
+        std::cout << "rtt " << rttHistogram.Summary() << std::endl;
+        rttHistogram.Clear();
+    }
+
+    std::string message{};
+    message += C_GAME_END;
+
+    HIGHSCORE::ReadFromHighscoreFile();
+
+    // add player to highscore
+    for (int i = 0; i < MAX_PLAYERS; i++)
+    {
+        if (!inMatch[i])
+        {
+            continue;
+        }
+        std::string name{ "player " };
+        name += (i+1);
+        HIGHSCORE::AddHighscore(playersInfo[i].score,name);
+    }
+    // send highscores
+    for (auto& score : HIGHSCORE::highScores)
+    {
+        unsigned int tmp = htonl(score.score);
+        message.append((char*)(&tmp), (char*)(&tmp) + 4);
+
+        long long tmpll = htonll(score.playDate);
+        message.append((char*)(&tmpll), (char*)(&tmpll) + 8);
+
+    }
+
+    // send player scores
+    for (auto& player : playersInfo)
+    {
+        unsigned int tmp = htonl(player.score);
+        message.append((char*)(&tmp), (char*)(&tmp) + 4);
+    }
+    // send the match's clients, split up if it no longer fits in one datagram
+    for (auto& client : clients)
+    {
+        int index = playersIndex[client.first];
+        if (inMatch[index])
+        {
+            SendFragmented(serverSock, message, client.second);
+        }
+    }
+
+    HIGHSCORE::WriteToHighscoreFile();
+
+    // everyone still connected waits for the next match
+    double now = CONNECTION::Now();
+    for (int i = 0; i < MAX_PLAYERS; i++)
+    {
+        inMatch[i] = false;
+    }
+    for (auto& client : clients)
+    {
+        matchQueue.Enqueue(playersIndex[client.first], now);
+    }
+    outgoing.clear();
+}
+
+// Drops clients that timed out so they stop taking bandwidth, a few times per second
+void ExpireClients()
+{
+    static double lastSweep{};
+    static std::vector<int> expired{};
+    double now = CONNECTION::Now();
+    if (now - lastSweep < CONNECTION::SWEEP_INTERVAL)
+    {
+        return;
+    }
+    lastSweep = now;
+
+    CONTENTION::Lock lock{ Mutex };
+    slots.Expire(now, expired);
+    for (int index : expired)
+    {
+        auto player = std::find_if(playersIndex.begin(), playersIndex.end(), [index](auto const& p) { return p.second == index; });
+        if (player != playersIndex.end())
+        {
+            RemoveClient(index, player->first);
+        }
+    }
+    expired.clear();
+}
+
+void InterpolateGameobject(GameObject& go, float timestamp) {
+    float deltaTime = appTime - timestamp;
+    go.t.pos.x += go.vel.x * deltaTime;
+    go.t.pos.y += go.vel.y * deltaTime;
+}
+
+//player shooting bullet logic - returns index of the bullet that was shot, -1 if the pool refused
+int Shoot(AEVec2 const& pos, float angle, int playerID)
+{
+    int index = bulletlist.Acquire();
+    if (index < 0)
+    {
+        return -1;
+    }
+    float rad{ AEDegToRad(angle) };
+    AEVec2 vel{ cosf(rad) * BULLET_SPEED, sinf(rad) * BULLET_SPEED };
+    //bullet - go, lifetime, isactive
+    bulletlist[index] = { { { pos, { 10.f, 10.f }, angle }, vel, ASSET::A_BULLET, playersInfo[playerID].go.col, true}, 1.f, playerID };
+    return index;
+}
+
+//collision check
+void SimpleDynamicCollisionCheck(float dt, TRANSPORT::Transport& serverSocket)
+{
+    PROFILE_ZONE("collision");
+    COLLISION::CheckAsteroidHits(playersInfo.data(), playersInfo.size(), golist, bulletlist, dt,
+        [&](Player& player, int astId)
+        {
+            player.score -= NEG_SCORE_PER_HIT;
+            Destroy_Asteroids(serverSocket, astId);
+        },
+        [&](Bullet const& b, int astId)
+        {
+            playersInfo[b.playerNO].score += SCORE_PER_ASTEROID;
+            Destroy_Asteroids(serverSocket, astId);
+        });
+}
+
+void Spawn_Asteroids(TRANSPORT::Transport& serverSock)
+{
+    CONTENTION::Lock lock{ Mutex };
+
+    int index = SPAWN::SpawnAsteroid(asteroidRng, golist, screen);
+    ++asteroidsSpawned;
 
     std::string msg{};
     msg += C_ASTEROID_SPAWN;
@@ -817,18 +1699,18 @@ void Spawn_Asteroids(SOCKET serverSock)
     unsigned int tmp = htonf(appTime);
     msg.append((char*)(&tmp), (char*)(&tmp) + 4);
 
-    // Send to all to start spawning asteroid
-    for (auto& ips : clients)
-    {
-        sendto(serverSock, msg.c_str(), (int)msg.length(), 0, reinterpret_cast<sockaddr*>(&ips.second), sizeof(ips.second));
-    }
+    unsigned short slot = htons((unsigned short)index);
+    msg.append((char*)(&slot), (char*)(&slot) + 2);
 
-    SpawnAsteroid();
+    // Send to all to start spawning asteroid
+    QueueBroadcast(serverSock, msg);
 }
 
-void Destroy_Asteroids(SOCKET serverSock, int astId)
+void Destroy_Asteroids(TRANSPORT::Transport& serverSock, int astId)
 {
-    std::lock_guard<std::mutex> lock(Mutex);
+    CONTENTION::Lock lock{ Mutex };
+
+    golist.Release(astId);
 
     std::string msg{};
     msg += C_ASTEROID_DESTROY;
@@ -837,8 +1719,5 @@ void Destroy_Asteroids(SOCKET serverSock, int astId)
     msg.append((char*)(&tmp), (char*)(&tmp) + 4);
 
     // Send to all to start spawning asteroid
-    for (auto& ips : clients)
-    {
-        sendto(serverSock, msg.c_str(), (int)msg.length(), 0, reinterpret_cast<sockaddr*>(&ips.second), sizeof(ips.second));
-    }
+    QueueBroadcast(serverSock, msg);
 }
\ No newline at end of file
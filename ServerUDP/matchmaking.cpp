@@ -0,0 +1,82 @@
+/*!
+\file		matchmaking.cpp
+\author		darius (d.chan@digipen.edu)
+\co-author
+\par		Assignment 4
+\date		19/10/2026
+\brief
+queue of connected players waiting for a match.
+
+Copyright (C) 2025 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the
+prior written consent of DigiPen Institute of Technology is prohibited.
+*/
+#include "matchmaking.h"
+#include <algorithm>
+
+namespace MATCHMAKING
+{
+	Queue::Queue() : _waiting{}, _stats{ 0, 0.0, 0.0, 0.0 }
+	{
+	}
+
+	void Queue::Enqueue(int player, double now)
+	{
+		if (Contains(player)) return;
+		_waiting.push_back({ player, now });
+	}
+
+	void Queue::Remove(int player)
+	{
+		_waiting.erase(std::remove_if(_waiting.begin(), _waiting.end(), [player](Entry const& e) { return e.player == player; }), _waiting.end());
+	}
+
+	bool Queue::Contains(int player) const
+	{
+		return std::any_of(_waiting.begin(), _waiting.end(), [player](Entry const& e) { return e.player == player; });
+	}
+
+	int Queue::Size() const
+	{
+		return (int)_waiting.size();
+	}
+
+	std::vector<int> Queue::FormMatch(double now, Policy const& policy)
+	{
+		int waiting = (int)_waiting.size();
+		if (waiting < policy.minPlayers || waiting == 0) return {};
+
+		//a full room starts at once, a smaller one only after the oldest has waited long enough
+		if (waiting < policy.maxPlayers && now - _waiting.front().enqueued < policy.maxWait) return {};
+
+		return TakeAll(now);
+	}
+
+	std::vector<int> Queue::Backfill(double now, Policy const& policy, float timeLeft)
+	{
+		if (timeLeft < policy.backfillCutoff) return {};
+		return TakeAll(now);
+	}
+
+	WaitStats const& Queue::Stats() const
+	{
+		return _stats;
+	}
+
+	std::vector<int> Queue::TakeAll(double now)
+	{
+		std::vector<int> players{};
+		players.reserve(_waiting.size());
+		for (Entry const& e : _waiting)
+		{
+			double wait = now - e.enqueued;
+			_stats.count += 1;
+			_stats.total += wait;
+			_stats.longest = std::max(_stats.longest, wait);
+			_stats.last = wait;
+			players.push_back(e.player);
+		}
+		_waiting.clear();
+		return players;
+	}
+}
@@ -0,0 +1,72 @@
+/*!
+\file		matchmaking.h
+\author		darius (d.chan@digipen.edu)
+\co-author
+\par		Assignment 4
+\date		19/10/2026
+\brief
+queue of connected players waiting for a match. matches are formed from
+the queue by size and wait time, the running match is topped up from it,
+and players go back into it when their match ends. time spent waiting
+is measured.
+
+a server runs one room, and it never holds more connections than the room
+has seats, so whoever is waiting always fits into the room.
+
+Copyright (C) 2025 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the
+prior written consent of DigiPen Institute of Technology is prohibited.
+*/
+#pragma once
+#include <vector>
+
+namespace MATCHMAKING
+{
+	struct Policy
+	{
+		int minPlayers;			//never start with fewer
+		int maxPlayers;			//start right away once this many wait
+		double maxWait;			//seconds the longest waiting player waits before starting with minPlayers
+		float backfillCutoff;	//seconds left in a match below which nobody is added
+	};
+
+	struct WaitStats
+	{
+		int count;			//players that left the queue for a match
+		double total;		//seconds, total / count is the average
+		double longest;
+		double last;		//wait of the most recent player
+	};
+
+	class Queue
+	{
+	public:
+		Queue();
+
+		//player is the slot index, joining twice keeps the first place
+		void Enqueue(int player, double now);
+		void Remove(int player);
+		bool Contains(int player) const;
+		int Size() const;
+
+		//everyone waiting once the policy says a new match can start, empty until then
+		std::vector<int> FormMatch(double now, Policy const& policy);
+
+		//everyone waiting, to add to the running match with timeLeft seconds to go
+		std::vector<int> Backfill(double now, Policy const& policy, float timeLeft);
+
+		WaitStats const& Stats() const;
+
+	private:
+		struct Entry
+		{
+			int player;
+			double enqueued;
+		};
+
+		std::vector<int> TakeAll(double now);
+
+		std::vector<Entry> _waiting;	//oldest first
+		WaitStats _stats;
+	};
+}
@@ -0,0 +1,41 @@
+/*!
+\file		message.h
+\author		darius (d.chan@digipen.edu)
+\co-author
+\par		Assignment 4
+\date		19/10/2026
+\brief
+the object layout shared by C_STATE_UPDATE, C_ALL_UPDATE and C_TIME_SYNC.
+pos, scale, rot and vel go out as network order floats, the same 28 bytes
+for a client's own ship and for every ship the server sends back. the
+client's requests are built here too, the game and the load bots send
+the same bytes.
+
+Copyright (C) 2025 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the
+prior written consent of DigiPen Institute of Technology is prohibited.
+*/
+#pragma once
+#include "gameobject.h"
+#include "input.h"
+#include <string>
+
+namespace MESSAGE
+{
+	const int BODY_SIZE = 8 + 8 + 4 + 8;	//pos, scale, rot, vel
+
+	void AppendFloat(std::string& message, float value);
+	float ReadFloat(const char* buffer);
+
+	//pos - 8b, scale - 8b, rot - 4b, vel - 8b
+	void AppendBody(std::string& message, GameObject const& go);
+
+	//reads BODY_SIZE bytes written by AppendBody
+	void ReadBody(const char* buffer, Transform& t, AEVec2& vel);
+
+	//C_STATE_UPDATE - id, timestamp, body, echo, input frames. echo is 0 before any C_ALL_UPDATE
+	std::string StateUpdate(float timestamp, GameObject const& go, float echo, INPUTFRAME::History const& inputs);
+
+	//C_REQ_FIRE - id, input frames
+	std::string ReqFire(float timestamp, INPUTFRAME::History const& inputs);
+}
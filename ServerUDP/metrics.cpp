@@ -0,0 +1,275 @@
+/*!
+\file		metrics.cpp
+\author		darius (d.chan@digipen.edu)
+\co-author
+\par		Assignment 4
+\date		19/10/2026
+\brief
+the metric types, writing them out in the prometheus text format, the
+counting transport and the http endpoint.
+
+Copyright (C) 2025 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the
+prior written consent of DigiPen Institute of Technology is prohibited.
+*/
+#include "metrics.h"
+#include "protocol.h"
+#include <sstream>
+#include <thread>
+
+namespace METRICS
+{
+	namespace
+	{
+		const int MAX_REQUEST = 2048;	//bytes of a request read before answering, the rest is ignored
+		const DWORD CLIENT_TIMEOUT = 1000;	//ms a scraper may stall a read or a write before it is dropped
+
+		//name{labels} or just name
+		std::string Series(std::string const& name, std::string const& labels)
+		{
+			return labels.empty() ? name : name + "{" + labels + "}";
+		}
+
+		bool SendAll(SOCKET sock, std::string const& data)
+		{
+			size_t sent = 0;
+			while (sent < data.size())
+			{
+				int bytes = send(sock, data.data() + sent, (int)(data.size() - sent), 0);
+				if (bytes == SOCKET_ERROR)
+				{
+					return false;
+				}
+				sent += (size_t)bytes;
+			}
+			return true;
+		}
+
+		void Answer(Registry& registry, SOCKET client)
+		{
+			//the request line is all that matters, read until the end of the headers
+			std::string request{};
+			char buffer[512];
+			while (request.size() < MAX_REQUEST && request.find("\r\n\r\n") == std::string::npos)
+			{
+				int bytes = recv(client, buffer, sizeof(buffer), 0);
+				if (bytes <= 0)
+				{
+					break;
+				}
+				request.append(buffer, (size_t)bytes);
+			}
+
+			std::string body{};
+			std::string status{};
+			if (request.rfind("GET /metrics ", 0) == 0 || request.rfind("GET / ", 0) == 0)
+			{
+				status = "200 OK";
+				body = registry.Render();
+			}
+			else
+			{
+				status = "404 Not Found";
+				body = "GET /metrics\n";
+			}
+			std::ostringstream response{};
+			response << "HTTP/1.0 " << status << "\r\n"
+				<< "Content-Type: text/plain; version=0.0.4\r\n"
+				<< "Content-Length: " << body.size() << "\r\n"
+				<< "Connection: close\r\n\r\n"
+				<< body;
+			SendAll(client, response.str());
+		}
+
+		void ServeThread(Registry& registry, SOCKET listener)
+		{
+			while (true)
+			{
+				SOCKET client = accept(listener, nullptr, nullptr);
+				if (client == INVALID_SOCKET)
+				{
+					continue;
+				}
+				//one connection at a time, so one that never sends or never reads must not hold the rest up
+				DWORD timeout = CLIENT_TIMEOUT;
+				setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, (const char*)&timeout, sizeof(timeout));
+				setsockopt(client, SOL_SOCKET, SO_SNDTIMEO, (const char*)&timeout, sizeof(timeout));
+				Answer(registry, client);
+				closesocket(client);
+			}
+		}
+	}
+
+	Histogram::Histogram(std::vector<double> const& bounds) : _bounds{ bounds }
+	{
+		if (_bounds.size() > MAX_BOUNDS)
+		{
+			_bounds.resize(MAX_BOUNDS);
+		}
+		for (std::atomic<long long>& bucket : _buckets)
+		{
+			bucket.store(0, std::memory_order_relaxed);
+		}
+	}
+
+	void Histogram::Observe(double value)
+	{
+		size_t i = 0;
+		while (i < _bounds.size() && value > _bounds[i])
+		{
+			++i;
+		}
+		_buckets[i].fetch_add(1, std::memory_order_relaxed);
+		_sum.fetch_add(value, std::memory_order_relaxed);
+	}
+
+	Registry::Entry& Registry::Add(std::string const& name, std::string const& help, std::string const& labels, Type type)
+	{
+		std::lock_guard<std::mutex> lock{ _mutex };
+		_entries.push_back(Entry{ name, help, labels, type, nullptr, nullptr, nullptr });
+		return _entries.back();
+	}
+
+	Counter& Registry::AddCounter(std::string const& name, std::string const& help, std::string const& labels)
+	{
+		Entry& entry = Add(name, help, labels, T_COUNTER);
+		entry.counter = std::make_unique<Counter>();
+		return *entry.counter;
+	}
+
+	Gauge& Registry::AddGauge(std::string const& name, std::string const& help, std::string const& labels)
+	{
+		Entry& entry = Add(name, help, labels, T_GAUGE);
+		entry.gauge = std::make_unique<Gauge>();
+		return *entry.gauge;
+	}
+
+	Histogram& Registry::AddHistogram(std::string const& name, std::string const& help, std::vector<double> const& bounds)
+	{
+		Entry& entry = Add(name, help, "", T_HISTOGRAM);
+		entry.histogram = std::make_unique<Histogram>(bounds);
+		return *entry.histogram;
+	}
+
+	std::string Registry::Render() const
+	{
+		static const char* const typeNames[] = { "counter", "gauge", "histogram" };
+
+		std::lock_guard<std::mutex> lock{ _mutex };
+		std::ostringstream out{};
+		out.precision(9);
+		for (size_t i = 0; i < _entries.size(); ++i)
+		{
+			Entry const& entry = _entries[i];
+			//help and type once, before the first series of a name
+			bool first = true;
+			for (size_t j = 0; j < i && first; ++j)
+			{
+				first = _entries[j].name != entry.name;
+			}
+			if (first)
+			{
+				out << "# HELP " << entry.name << " " << entry.help << "\n"
+					<< "# TYPE " << entry.name << " " << typeNames[entry.type] << "\n";
+			}
+
+			if (entry.type == T_COUNTER)
+			{
+				out << Series(entry.name, entry.labels) << " " << entry.counter->Value() << "\n";
+			}
+			else if (entry.type == T_GAUGE)
+			{
+				out << Series(entry.name, entry.labels) << " " << entry.gauge->Value() << "\n";
+			}
+			else
+			{
+				//buckets are cumulative in the exposition format
+				Histogram const& h = *entry.histogram;
+				long long count = 0;
+				for (size_t b = 0; b < h.Bounds().size(); ++b)
+				{
+					count += h.Bucket(b);
+					out << entry.name << "_bucket{le=\"" << h.Bounds()[b] << "\"} " << count << "\n";
+				}
+				count += h.Bucket(h.Bounds().size());
+				out << entry.name << "_bucket{le=\"+Inf\"} " << count << "\n"
+					<< entry.name << "_sum " << h.Sum() << "\n"
+					<< entry.name << "_count " << count << "\n";
+			}
+		}
+		return out.str();
+	}
+
+	Registry& Default()
+	{
+		static Registry registry{};
+		return registry;
+	}
+
+	CountingTransport::CountingTransport(std::unique_ptr<TRANSPORT::Transport> inner, Registry& registry)
+		: _inner{ std::move(inner) }, _out{}, _in{},
+		_sendFailures{ registry.AddCounter("server_send_failures_total", "Datagrams the transport failed to send") }
+	{
+		static_assert(IDS == C_FULL_STATE + 1, "IDS has to cover every CommandID");
+		for (int i = 0; i <= IDS; ++i)
+		{
+			std::string labels = std::string{ "command=\"" } + CommandName((unsigned char)i) + "\"";
+			_out.packets[i] = &registry.AddCounter("server_packets_sent_total", "Datagrams sent, by the id they start with", labels);
+		}
+		for (int i = 0; i <= IDS; ++i)
+		{
+			std::string labels = std::string{ "command=\"" } + CommandName((unsigned char)i) + "\"";
+			_in.packets[i] = &registry.AddCounter("server_packets_received_total", "Datagrams received, by the id they start with", labels);
+		}
+		_out.bytes = &registry.AddCounter("server_bytes_sent_total", "Bytes of every datagram sent");
+		_in.bytes = &registry.AddCounter("server_bytes_received_total", "Bytes of every datagram received");
+	}
+
+	int CountingTransport::SendTo(const char* data, int length, sockaddr_in const& to)
+	{
+		int sent = _inner->SendTo(data, length, to);
+		if (sent == SOCKET_ERROR)
+		{
+			_sendFailures.Add();
+			return sent;
+		}
+		unsigned char id = length > 0 ? (unsigned char)data[0] : (unsigned char)C_ERROR;
+		_out.packets[id < IDS ? id : IDS]->Add();
+		_out.bytes->Add(sent);
+		return sent;
+	}
+
+	int CountingTransport::RecvFrom(char* buffer, int length, sockaddr_in& from)
+	{
+		int received = _inner->RecvFrom(buffer, length, from);
+		if (received == SOCKET_ERROR)
+		{
+			return received;
+		}
+		unsigned char id = received > 0 ? (unsigned char)buffer[0] : (unsigned char)C_ERROR;
+		_in.packets[id < IDS ? id : IDS]->Add();
+		_in.bytes->Add(received);
+		return received;
+	}
+
+	bool Serve(Registry& registry, unsigned short port)
+	{
+		SOCKET listener = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+		if (listener == INVALID_SOCKET)
+		{
+			return false;
+		}
+		//only this machine can ask, there is nothing to secure it with
+		sockaddr_in addr{};
+		addr.sin_family = AF_INET;
+		addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+		addr.sin_port = htons(port);
+		if (bind(listener, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != NO_ERROR || listen(listener, SOMAXCONN) != NO_ERROR)
+		{
+			closesocket(listener);
+			return false;
+		}
+		std::thread{ ServeThread, std::ref(registry), listener }.detach();
+		return true;
+	}
+}
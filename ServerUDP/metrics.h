@@ -0,0 +1,135 @@
+/*!
+\file		metrics.h
+\author		darius (d.chan@digipen.edu)
+\co-author
+\par		Assignment 4
+\date		19/10/2026
+\brief
+counters, gauges and histograms the server keeps while it runs, and a small
+http endpoint that serves them in the prometheus text format. every metric
+sits on cache lines of its own and is only ever changed with relaxed atomic
+adds and stores, so the threads writing them never wait and never share a
+line with the game state. the endpoint thread only reads them.
+
+Copyright (C) 2025 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the
+prior written consent of DigiPen Institute of Technology is prohibited.
+*/
+#pragma once
+#include "transport.h"
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace METRICS
+{
+	//only goes up
+	class alignas(64) Counter
+	{
+	public:
+		void Add(long long n = 1) { _value.fetch_add(n, std::memory_order_relaxed); }
+		long long Value() const { return _value.load(std::memory_order_relaxed); }
+
+	private:
+		std::atomic<long long> _value{ 0 };
+	};
+
+	//a level that can go both ways
+	class alignas(64) Gauge
+	{
+	public:
+		void Set(double value) { _value.store(value, std::memory_order_relaxed); }
+		void Add(double n) { _value.fetch_add(n, std::memory_order_relaxed); }
+		double Value() const { return _value.load(std::memory_order_relaxed); }
+
+	private:
+		std::atomic<double> _value{ 0.0 };
+	};
+
+	//counts of observations at or below each bound, with their sum
+	class alignas(64) Histogram
+	{
+	public:
+		static const int MAX_BOUNDS = 15;
+
+		explicit Histogram(std::vector<double> const& bounds);	//ascending, MAX_BOUNDS at most
+
+		void Observe(double value);
+
+		std::vector<double> const& Bounds() const { return _bounds; }
+		//observations in bucket i alone, the last bucket holds everything above the last bound
+		long long Bucket(size_t i) const { return _buckets[i].load(std::memory_order_relaxed); }
+		double Sum() const { return _sum.load(std::memory_order_relaxed); }
+
+	private:
+		std::vector<double> _bounds;
+		std::atomic<long long> _buckets[MAX_BOUNDS + 1];	//in the object so its lines are its own
+		std::atomic<double> _sum{ 0.0 };
+	};
+
+	//owns every metric and writes them out. add metrics before the threads using them start,
+	//the references handed out stay valid for as long as the registry lives
+	class Registry
+	{
+	public:
+		//labels like `command="C_ALL_UPDATE"`. metrics sharing a name share its help and type
+		Counter& AddCounter(std::string const& name, std::string const& help, std::string const& labels = "");
+		Gauge& AddGauge(std::string const& name, std::string const& help, std::string const& labels = "");
+		Histogram& AddHistogram(std::string const& name, std::string const& help, std::vector<double> const& bounds);
+
+		//prometheus text exposition format
+		std::string Render() const;
+
+	private:
+		enum Type { T_COUNTER, T_GAUGE, T_HISTOGRAM };
+		struct Entry
+		{
+			std::string name;
+			std::string help;
+			std::string labels;
+			Type type;
+			std::unique_ptr<Counter> counter;
+			std::unique_ptr<Gauge> gauge;
+			std::unique_ptr<Histogram> histogram;
+		};
+
+		Entry& Add(std::string const& name, std::string const& help, std::string const& labels, Type type);
+
+		mutable std::mutex _mutex;
+		std::vector<Entry> _entries;
+	};
+
+	//the server's registry
+	Registry& Default();
+
+	//wraps another transport and counts datagrams and bytes each way by the id they start with,
+	//and sends that failed
+	class CountingTransport : public TRANSPORT::Transport
+	{
+	public:
+		CountingTransport(std::unique_ptr<TRANSPORT::Transport> inner, Registry& registry);
+
+		int SendTo(const char* data, int length, sockaddr_in const& to) override;
+		int RecvFrom(char* buffer, int length, sockaddr_in& from) override;
+
+	private:
+		static const int IDS = 19;	//C_ERROR to C_FULL_STATE, the last slot is for any other id
+
+		struct Direction
+		{
+			Counter* packets[IDS + 1];
+			Counter* bytes;
+		};
+
+		std::unique_ptr<TRANSPORT::Transport> _inner;
+		Direction _out;
+		Direction _in;
+		Counter& _sendFailures;
+	};
+
+	//answers GET /metrics on 127.0.0.1:port with the registry, one request at a time on a thread of its own.
+	//false if the port could not be listened on
+	bool Serve(Registry& registry, unsigned short port);
+}
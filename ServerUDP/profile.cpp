@@ -0,0 +1,225 @@
+/*!
+\file		profile.cpp
+\author		darius (d.chan@digipen.edu)
+\co-author
+\par		Assignment 4
+\date		19/10/2026
+\brief
+per thread sample rings, zone names and the histograms they are collected
+into.
+
+Copyright (C) 2025 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the
+prior written consent of DigiPen Institute of Technology is prohibited.
+*/
+#include "profile.h"
+#include <bit>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <vector>
+
+namespace PROFILE
+{
+	std::atomic<bool> enabled{ false };
+
+	namespace
+	{
+		struct Sample
+		{
+			int zone;
+			unsigned long long ticks;
+		};
+
+		//single producer single consumer, the owning thread pushes and Collect pops.
+		//head and tail sit on their own cache lines so the two sides do not fight over one
+		struct Ring
+		{
+			alignas(64) std::atomic<unsigned> head{ 0 };	//next slot the owner writes
+			alignas(64) std::atomic<unsigned> tail{ 0 };	//next slot Collect reads
+			std::atomic<long long> dropped{ 0 };
+			Sample samples[RING_SIZE];
+		};
+
+		//rings outlive their threads so nothing pushed before a thread exits is lost
+		std::mutex ringsMutex{};
+		std::vector<std::unique_ptr<Ring>> rings{};
+
+		//names, histograms and everything collected so far
+		std::mutex zonesMutex{};
+		std::vector<std::string> names{};
+		std::vector<Histogram> histograms{};
+		long long dropped{ 0 };
+
+		//one pair of clock readings from start up, later readings against it give the tick rate
+		const unsigned long long startTicks{ Ticks() };
+		const std::chrono::steady_clock::time_point startTime{ std::chrono::steady_clock::now() };
+
+		Ring& ThreadRing()
+		{
+			thread_local Ring* ring{ nullptr };
+			if (!ring)
+			{
+				std::unique_ptr<Ring> fresh{ std::make_unique<Ring>() };
+				ring = fresh.get();
+				std::lock_guard<std::mutex> lock{ ringsMutex };
+				rings.push_back(std::move(fresh));
+			}
+			return *ring;
+		}
+
+		double NanosecondsPerTick()
+		{
+#ifdef PROFILE_RDTSC
+			double elapsed{ (double)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - startTime).count() };
+			unsigned long long ticks{ Ticks() - startTicks };
+			return ticks ? elapsed / (double)ticks : 1.0;
+#else
+			return 1.0;
+#endif
+		}
+	}
+
+	void SetEnabled(bool on)
+	{
+		enabled.store(on, std::memory_order_relaxed);
+	}
+
+	int Register(const char* name)
+	{
+		std::lock_guard<std::mutex> lock{ zonesMutex };
+		for (size_t i = 0; i < names.size(); ++i)
+		{
+			if (names[i] == name) return (int)i;
+		}
+		names.emplace_back(name);
+		histograms.emplace_back();
+		return (int)names.size() - 1;
+	}
+
+	void Record(int zone, unsigned long long ticks)
+	{
+		Ring& ring{ ThreadRing() };
+		unsigned head{ ring.head.load(std::memory_order_relaxed) };
+		if (head - ring.tail.load(std::memory_order_acquire) >= (unsigned)RING_SIZE)
+		{
+			ring.dropped.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+		ring.samples[head & (RING_SIZE - 1)] = Sample{ zone, ticks };
+		ring.head.store(head + 1, std::memory_order_release);
+	}
+
+	Histogram::Histogram() : _counts{}, _count{ 0 }, _total{ 0.0 }, _max{ 0 }
+	{
+	}
+
+	//values under 2^SUB_BITS get a bucket each, after that every doubling is split into 2^(SUB_BITS-1) buckets
+	int Histogram::Bucket(unsigned long long value)
+	{
+		if (value < (1ull << SUB_BITS)) return (int)value;
+		int shift{ static_cast<int>(std::bit_width(value)) - SUB_BITS };
+		return (shift << (SUB_BITS - 1)) + (int)(value >> shift);
+	}
+
+	unsigned long long Histogram::Lowest(int bucket)
+	{
+		if (bucket < (1 << SUB_BITS)) return (unsigned long long)bucket;
+		int shift{ (bucket >> (SUB_BITS - 1)) - 1 };
+		unsigned long long sub{ (unsigned long long)(bucket & ((1 << (SUB_BITS - 1)) - 1)) | (1ull << (SUB_BITS - 1)) };
+		return sub << shift;
+	}
+
+	void Histogram::Add(unsigned long long nanoseconds)
+	{
+		++_counts[Bucket(nanoseconds)];
+		++_count;
+		_total += (double)nanoseconds;
+		if (nanoseconds > _max) _max = nanoseconds;
+	}
+
+	void Histogram::Clear()
+	{
+		_counts.fill(0);
+		_count = 0;
+		_total = 0.0;
+		_max = 0;
+	}
+
+	double Histogram::Mean() const
+	{
+		return _count ? _total / (double)_count : 0.0;
+	}
+
+	unsigned long long Histogram::Percentile(double p) const
+	{
+		if (_count == 0) return 0;
+		long long rank{ (long long)(p * (double)(_count - 1)) + 1 };
+		long long seen{ 0 };
+		for (int i = 0; i < BUCKETS; ++i)
+		{
+			seen += _counts[i];
+			if (seen >= rank)
+			{
+				//the top of the bucket, never past the largest sample
+				unsigned long long top{ i + 1 < BUCKETS ? Lowest(i + 1) - 1 : _max };
+				return top < _max ? top : _max;
+			}
+		}
+		return _max;
+	}
+
+	void Collect()
+	{
+		double scale{ NanosecondsPerTick() };
+		std::lock_guard<std::mutex> lock{ zonesMutex };
+		std::lock_guard<std::mutex> ringsLock{ ringsMutex };
+		for (std::unique_ptr<Ring>& ring : rings)
+		{
+			unsigned tail{ ring->tail.load(std::memory_order_relaxed) };
+			unsigned head{ ring->head.load(std::memory_order_acquire) };
+			for (; tail != head; ++tail)
+			{
+				Sample const& sample{ ring->samples[tail & (RING_SIZE - 1)] };
+				histograms[sample.zone].Add((unsigned long long)((double)sample.ticks * scale));
+			}
+			ring->tail.store(tail, std::memory_order_release);
+			dropped += ring->dropped.exchange(0, std::memory_order_relaxed);
+		}
+	}
+
+	std::string Report()
+	{
+		Collect();
+		std::lock_guard<std::mutex> lock{ zonesMutex };
+		std::ostringstream out{};
+		out << std::fixed << std::setprecision(1);
+		for (size_t i = 0; i < names.size(); ++i)
+		{
+			Histogram const& h{ histograms[i] };
+			if (h.Count() == 0) continue;
+			out << std::left << std::setw(16) << names[i] << std::right
+				<< " n=" << h.Count()
+				<< " mean=" << h.Mean() / 1000.0
+				<< " p50=" << (double)h.Percentile(0.5) / 1000.0
+				<< " p90=" << (double)h.Percentile(0.9) / 1000.0
+				<< " p99=" << (double)h.Percentile(0.99) / 1000.0
+				<< " p99.9=" << (double)h.Percentile(0.999) / 1000.0
+				<< " max=" << (double)h.Max() / 1000.0 << "us\n";
+		}
+		if (dropped) out << dropped << " samples dropped, Collect more often\n";
+		return out.str();
+	}
+
+	void Clear()
+	{
+		Collect();
+		std::lock_guard<std::mutex> lock{ zonesMutex };
+		for (Histogram& h : histograms)
+		{
+			h.Clear();
+		}
+		dropped = 0;
+	}
+}
@@ -0,0 +1,127 @@
+/*!
+\file		profile.h
+\author		darius (d.chan@digipen.edu)
+\co-author
+\par		Assignment 4
+\date		19/10/2026
+\brief
+scoped timing zones for the server's hot paths. PROFILE_ZONE("name") times
+the rest of the enclosing scope and pushes one sample into a ring owned by
+the calling thread, without locking. Collect moves every thread's samples
+into a log-linear histogram per zone, Report prints their percentiles.
+while profiling is off a zone costs one relaxed atomic load, so the zones
+stay compiled into release builds. define PROFILE_OFF to remove them.
+every zone is a trace scope as well, see trace.h.
+
+Copyright (C) 2025 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the
+prior written consent of DigiPen Institute of Technology is prohibited.
+*/
+#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include "trace.h"
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define PROFILE_RDTSC
+#endif
+
+namespace PROFILE
+{
+	const int RING_SIZE = 1 << 13;		//samples a thread can hold between two Collects, more are counted and dropped
+	const int SUB_BITS = 7;				//2^(SUB_BITS-1) = 64 steps per doubling, no bucket is wider than 1/64 (1.6%) of its values
+	const int BUCKETS = (64 - SUB_BITS + 2) << (SUB_BITS - 1);
+
+	extern std::atomic<bool> enabled;
+
+	inline bool Enabled()
+	{
+		return enabled.load(std::memory_order_relaxed);
+	}
+
+	void SetEnabled(bool on);
+
+	//time stamp counter where there is one, steady clock nanoseconds everywhere else
+	inline unsigned long long Ticks()
+	{
+#ifdef PROFILE_RDTSC
+		return __rdtsc();
+#else
+		return (unsigned long long)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+	}
+
+	//id of the zone called name, the same name always gets the same id
+	int Register(const char* name);
+
+	//adds one sample to the calling thread's ring
+	void Record(int zone, unsigned long long ticks);
+
+	//times its scope, nothing at all while profiling is off
+	class Zone
+	{
+	public:
+		explicit Zone(int zone) : _zone{ Enabled() ? zone : -1 }, _start{ _zone >= 0 ? Ticks() : 0 }
+		{
+		}
+
+		~Zone()
+		{
+			if (_zone >= 0) Record(_zone, Ticks() - _start);
+		}
+
+		Zone(Zone const&) = delete;
+		Zone& operator=(Zone const&) = delete;
+
+	private:
+		int _zone;
+		unsigned long long _start;
+	};
+
+	//log-linear buckets over the whole 64 bit range, like an hdr histogram with 2 significant digits
+	class Histogram
+	{
+	public:
+		Histogram();
+
+		void Add(unsigned long long nanoseconds);
+		void Clear();
+
+		long long Count() const { return _count; }
+		double Mean() const;
+		//nanoseconds below which p of the samples fall, p in [0, 1]. 0 when empty
+		unsigned long long Percentile(double p) const;
+		unsigned long long Max() const { return _max; }
+
+	private:
+		static int Bucket(unsigned long long value);
+		static unsigned long long Lowest(int bucket);
+
+		std::array<unsigned int, BUCKETS> _counts;
+		long long _count;
+		double _total;
+		unsigned long long _max;
+	};
+
+	//moves every thread's samples into the zone histograms. cheap enough to call once per frame
+	void Collect();
+
+	//collects, then one line per zone: samples, mean, p50, p90, p99, p99.9 and max in microseconds
+	std::string Report();
+
+	//empties the histograms, for example at the start of a match
+	void Clear();
+}
+
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+#ifdef PROFILE_OFF
+#define PROFILE_ZONE(name) TRACE_SCOPE(name)
+#else
+#define PROFILE_ZONE(name) \
+	static const int PROFILE_CONCAT(profileSite, __LINE__) = PROFILE::Register(name); \
+	PROFILE::Zone PROFILE_CONCAT(profileZone, __LINE__){ PROFILE_CONCAT(profileSite, __LINE__) }; \
+	TRACE_SCOPE(name)
+#endif
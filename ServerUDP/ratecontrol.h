@@ -0,0 +1,46 @@
+/*!
+\file		ratecontrol.h
+\author		darius (d.chan@digipen.edu)
+\co-author
+\par		Assignment 4
+\date		19/10/2026
+\brief
+per-peer send rate controller. adapts how often snapshots are sent
+with a delay-based AIMD:
+the rate grows additively while the round trip stays near its minimum and
+is cut multiplicatively once queueing delay builds up or a send fails.
+
+Copyright (C) 2025 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the
+prior written consent of DigiPen Institute of Technology is prohibited.
+*/
+#pragma once
+
+class RateController
+{
+public:
+	//all intervals are in seconds between two sends
+	RateController(float minInterval = 0.033f, float maxInterval = 0.2f, float startInterval = 0.05f);
+
+	//a round trip time measured from an echoed timestamp
+	void OnRttSample(float rtt, float now);
+	//the socket refused the packet (buffer full), treated as congestion
+	void OnSendFailed(float now);
+
+	//seconds to wait before the next send
+	float Interval() const;
+	float Rtt() const;
+	float MinRtt() const;
+
+private:
+	void Decrease(float now);
+
+	float _minRate;			//sends per second
+	float _maxRate;
+	float _rate;
+
+	float _srtt;			//smoothed round trip
+	float _minRtt;			//baseline round trip without queueing
+	float _minRttStart;		//when the current baseline window started
+	float _lastDecrease;
+};
@@ -0,0 +1,156 @@
+/*!
+\file		replication.cpp
+\author		darius (d.chan@digipen.edu)
+\co-author
+\par		Assignment 4
+\date		19/10/2026
+\brief
+chooses which asteroids and bullets are replicated to a client, using a
+per client priority accumulator and a fixed byte budget per packet.
+
+Copyright (C) 2025 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the
+prior written consent of DigiPen Institute of Technology is prohibited.
+*/
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+
+#include "Windows.h"
+#include "winsock2.h"	// htonf, htons
+
+#include "replication.h"
+#include "protocol.h"
+#include <algorithm>
+
+namespace REPLICATION
+{
+	namespace
+	{
+		const float DISTANCE_SCALE = 400.f;	//distance where priority growth halves
+		const float SPEED_SCALE = 200.f;	//speed where priority growth doubles
+		const float INACTIVE_WEIGHT = 2.f;	//a deactivation is sent soon so the client stops drawing it
+
+		struct Candidate
+		{
+			float priority;
+			EntityType type;
+			int index;
+		};
+
+		float Weight(AEVec2 const& viewer, GameObject const& go)
+		{
+			if (!go.isActive) return INACTIVE_WEIGHT;
+			AEVec2 d{ go.t.pos.x - viewer.x, go.t.pos.y - viewer.y };
+			float distance{ AEVec2Length(&d) };
+			float speed{ AEVec2Length(&go.vel) };
+			return (1.f + speed / SPEED_SCALE) / (1.f + distance / DISTANCE_SCALE);
+		}
+
+		void Grow(EntityPriority& p, AEVec2 const& viewer, GameObject const& go, float dt)
+		{
+			//client already knows this one is gone
+			if (!go.isActive && !p.sentActive)
+			{
+				p.priority = 0.f;
+				return;
+			}
+			p.priority += Weight(viewer, go) * dt;
+		}
+
+		void Append(std::string& packet, unsigned int value)
+		{
+			packet.append((char*)(&value), (char*)(&value) + 4);
+		}
+		void Append(std::string& packet, unsigned short value)
+		{
+			packet.append((char*)(&value), (char*)(&value) + 2);
+		}
+
+		//type - 1b, index - 2b, active - 1b, pos - 8b, rot - 4b, vel - 8b, extra - 4b
+		void AppendEntity(std::string& packet, EntityType type, int index, GameObject const& go, float extra)
+		{
+			packet += (char)type;
+			Append(packet, htons((unsigned short)index));
+			packet += (char)(go.isActive ? 1 : 0);
+			Append(packet, htonf(go.t.pos.x));
+			Append(packet, htonf(go.t.pos.y));
+			Append(packet, htonf(go.t.rot));
+			Append(packet, htonf(go.vel.x));
+			Append(packet, htonf(go.vel.y));
+			Append(packet, htonf(extra));
+		}
+	}
+
+	void Accumulate(Accumulator& acc, AEVec2 const& viewer, std::vector<GameObject> const& golist, std::vector<Bullet> const& bulletlist, float dt)
+	{
+		//new entities start with no priority and are treated as already inactive on the client
+		acc.asteroids.resize(golist.size(), { 0.f, false });
+		acc.bullets.resize(bulletlist.size(), { 0.f, false });
+
+		for (size_t i = 0; i < golist.size(); ++i)
+		{
+			Grow(acc.asteroids[i], viewer, golist[i], dt);
+		}
+		for (size_t i = 0; i < bulletlist.size(); ++i)
+		{
+			Grow(acc.bullets[i], viewer, bulletlist[i].go, dt);
+		}
+	}
+
+	std::string Build(Accumulator& acc, std::vector<GameObject> const& golist, std::vector<Bullet> const& bulletlist, float timestamp, int budget)
+	{
+		//everything worth sending this time
+		static std::vector<Candidate> candidates{};
+		candidates.clear();
+		for (size_t i = 0; i < acc.asteroids.size() && i < golist.size(); ++i)
+		{
+			if (acc.asteroids[i].priority > 0.f && golist[i].texid == ASSET::A_ASTEROID)
+				candidates.push_back({ acc.asteroids[i].priority, E_ASTEROID, (int)i });
+		}
+		for (size_t i = 0; i < acc.bullets.size() && i < bulletlist.size(); ++i)
+		{
+			if (acc.bullets[i].priority > 0.f)
+				candidates.push_back({ acc.bullets[i].priority, E_BULLET, (int)i });
+		}
+		if (candidates.empty()) return {};
+
+		//only the ones that fit need to be in order
+		size_t fit = (size_t)std::max(0, (budget - HEADER_SIZE) / ENTITY_SIZE);
+		fit = std::min(fit, candidates.size());
+		std::partial_sort(candidates.begin(), candidates.begin() + fit, candidates.end(),
+			[](Candidate const& a, Candidate const& b) {
+				return a.priority > b.priority;
+			});
+
+		std::string packet{};
+		packet.reserve(HEADER_SIZE + fit * ENTITY_SIZE);
+		packet += C_ENTITY_UPDATE;
+		Append(packet, htonf(timestamp));
+		Append(packet, htons((unsigned short)fit));
+
+		for (size_t i = 0; i < fit; ++i)
+		{
+			Candidate const& c = candidates[i];
+			if (c.type == E_ASTEROID)
+			{
+				GameObject const& go = golist[c.index];
+				AppendEntity(packet, c.type, c.index, go, go.t.scale.x);
+				acc.asteroids[c.index] = { 0.f, go.isActive };
+			}
+			else
+			{
+				Bullet const& b = bulletlist[c.index];
+				AppendEntity(packet, c.type, c.index, b.go, b.lifeTime);
+				acc.bullets[c.index] = { 0.f, b.go.isActive };
+			}
+		}
+		return packet;
+	}
+
+	void Reset(Accumulator& acc)
+	{
+		acc.asteroids.clear();
+		acc.bullets.clear();
+	}
+}
@@ -0,0 +1,57 @@
+/*!
+\file		replication.h
+\author		darius (d.chan@digipen.edu)
+\co-author
+\par		Assignment 4
+\date		19/10/2026
+\brief
+chooses which asteroids and bullets are replicated to a client. every
+entity builds up priority per client over time, scaled by how close it is
+to that client's ship and how fast it moves. each send, the entities with
+the highest priority are packed into a fixed byte budget and reset.
+
+Copyright (C) 2025 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the
+prior written consent of DigiPen Institute of Technology is prohibited.
+*/
+#pragma once
+#include "gameobject.h"
+#include <string>
+#include <vector>
+
+namespace REPLICATION
+{
+	const int PACKET_BUDGET = 1200;		//max bytes of one C_ENTITY_UPDATE, kept under the MTU
+	const int HEADER_SIZE = 1 + 4 + 2;	//id, timestamp, count
+	const int ENTITY_SIZE = 1 + 2 + 1 + 8 + 4 + 8 + 4;	//type, index, active, pos, rot, vel, extra
+
+	enum EntityType : unsigned char
+	{
+		E_ASTEROID = 0,
+		E_BULLET = 1
+	};
+
+	//priority of one entity towards one client
+	struct EntityPriority
+	{
+		float priority;
+		bool sentActive;	//what the client was last told, inactive entities are only sent once
+	};
+
+	//one per client, indices match golist and bulletlist
+	struct Accumulator
+	{
+		std::vector<EntityPriority> asteroids;
+		std::vector<EntityPriority> bullets;
+	};
+
+	//adds the priority built up over dt towards a client whose ship is at viewer
+	void Accumulate(Accumulator& acc, AEVec2 const& viewer, std::vector<GameObject> const& golist, std::vector<Bullet> const& bulletlist, float dt);
+
+	//packs the highest priority entities into a C_ENTITY_UPDATE of at most budget bytes,
+	//the priority of everything packed is reset. returns an empty string if nothing is worth sending
+	std::string Build(Accumulator& acc, std::vector<GameObject> const& golist, std::vector<Bullet> const& bulletlist, float timestamp, int budget = PACKET_BUDGET);
+
+	//forget what was sent, called when a client takes over a slot
+	void Reset(Accumulator& acc);
+}
@@ -0,0 +1,61 @@
+/*!
+\file		server.h
+\author		darius (d.chan@digipen.edu)
+\co-author
+\par		Assignment 4
+\date		19/10/2026
+\brief
+the steps of the server's loops, split out of the threads that run them so
+the entry point and the tick benchmark drive the same code. everything
+here works on the server state in main_server.cpp.
+
+Copyright (C) 2025 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the
+prior written consent of DigiPen Institute of Technology is prohibited.
+*/
+#pragma once
+#include "transport.h"
+#include "fragment.h"
+#include "determinism.h"
+#include <string>
+
+//seconds spent in each part of one ServerTick
+struct TickTimes
+{
+    double simulate;    //spawning and moving everything
+    double collide;     //collision pass and the lag compensation record
+    double flush;       //events queued this tick going out together
+};
+
+extern bool game_start;     // a match is running
+extern bool has_started;    // its C_GAME_START has gone out
+extern float appTime;       // seconds into the match
+
+// deterministic mode, off unless asked for. every tick is FIXED_DT long, client inputs wait for the
+// start of the next tick and are applied in DETERMINISM::Order, and the state after every tick is
+// hashed into matchLog, cleared when a match starts
+const float FIXED_DT = 1.f / 60.f;
+extern bool deterministic;
+extern DETERMINISM::TickLog matchLog;
+
+// players and their send rates to their defaults, once before anything else
+void InitServer();
+
+// one datagram off the transport: pieces of a larger message, a batch or a single message
+void HandleDatagram(TRANSPORT::Transport& serverSock, FRAGMENT::Reassembler& reassembler, std::string& message,
+    const char* buffer, int bytes_received, sockaddr_in const& client_addr);
+
+// start a match from the queue, or top up the running one
+void Matchmake(TRANSPORT::Transport& serverSock);
+void ExpireClients();
+
+// one frame of a running match, ends the match when its time is up. times is filled in when given
+void ServerTick(TRANSPORT::Transport& serverSock, float dt, TickTimes* times = nullptr);
+
+// deterministic mode, plays the match of a matchLog written before from its inputs alone and hashes
+// every tick again. returns the first tick whose hash differs from the log's, -1 if every one matched
+int ReplayMatch(TRANSPORT::Transport& serverSock, DETERMINISM::TickLog const& log);
+
+// send thread steps: C_GAME_START once per match, then the updates of every client that is due
+void SendGameStart(TRANSPORT::Transport& serverSocket);
+void SendUpdates(TRANSPORT::Transport& serverSocket);
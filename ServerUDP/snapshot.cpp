@@ -0,0 +1,216 @@
+/*!
+\file		snapshot.cpp
+\author		darius (d.chan@digipen.edu)
+\co-author
+\par		Assignment 4
+\date		19/10/2026
+\brief
+packs and unpacks the full state of a running match for late joiners.
+
+Copyright (C) 2025 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the
+prior written consent of DigiPen Institute of Technology is prohibited.
+*/
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+
+#include "Windows.h"
+#include "winsock2.h"	// htonf, htonl, htons
+
+#include "snapshot.h"
+#include "protocol.h"
+#include <cmath>
+#include <algorithm>
+
+namespace SNAPSHOT
+{
+	namespace
+	{
+		//reads from a buffer, fails once instead of checking the length before every field
+		struct Reader
+		{
+			const char* buffer;
+			int length;
+			int offset;
+
+			bool Has(int bytes) const { return offset + bytes <= length; }
+
+			unsigned int U32()
+			{
+				unsigned int v = ntohl(*(uint32_t*)(buffer + offset));
+				offset += 4;
+				return v;
+			}
+			unsigned short U16()
+			{
+				unsigned short v = ntohs(*(uint16_t*)(buffer + offset));
+				offset += 2;
+				return v;
+			}
+			unsigned char U8()
+			{
+				return (unsigned char)buffer[offset++];
+			}
+			float F32()
+			{
+				float v = ntohf(*(uint32_t*)(buffer + offset));
+				offset += 4;
+				return v;
+			}
+			float Fixed(float scale)
+			{
+				return (short)U16() / scale;
+			}
+			AEVec2 Vec(float scale)
+			{
+				AEVec2 v{};
+				v.x = Fixed(scale);
+				v.y = Fixed(scale);
+				return v;
+			}
+			float Angle()
+			{
+				return U16() * (360.f / 65536.f);
+			}
+		};
+
+		void Append(std::string& message, unsigned int value)
+		{
+			message.append((char*)(&value), (char*)(&value) + 4);
+		}
+		void Append(std::string& message, unsigned short value)
+		{
+			message.append((char*)(&value), (char*)(&value) + 2);
+		}
+
+		void AppendFixed(std::string& message, float value, float scale)
+		{
+			float q = std::round(value * scale);
+			q = std::clamp(q, -32768.f, 32767.f);
+			Append(message, htons((unsigned short)(short)q));
+		}
+		void AppendVec(std::string& message, AEVec2 const& v, float scale)
+		{
+			AppendFixed(message, v.x, scale);
+			AppendFixed(message, v.y, scale);
+		}
+		//degrees, any turn count, in 1/65536 of a turn
+		void AppendAngle(std::string& message, float degrees)
+		{
+			float turn = std::fmod(degrees, 360.f);
+			if (turn < 0.f) turn += 360.f;
+			Append(message, htons((unsigned short)((unsigned int)(turn * (65536.f / 360.f)) & 0xFFFF)));
+		}
+	}
+
+	std::string Build(Header const& header, std::vector<PlayerState> const& players, std::vector<GameObject> const& golist, std::vector<Bullet> const& bulletlist)
+	{
+		int asteroids{}, bullets{};
+		for (GameObject const& go : golist) asteroids += go.isActive ? 1 : 0;
+		for (Bullet const& b : bulletlist) bullets += b.go.isActive ? 1 : 0;
+
+		std::string message{};
+		message.reserve(1 + 12 + 1 + PLAYER_SIZE * players.size() + 4 + ASTEROID_SIZE * asteroids + 4 + BULLET_SIZE * bullets);
+		message += C_FULL_STATE;
+		Append(message, htonf(header.timestamp));
+		Append(message, htonf(header.timeLeft));
+		Append(message, htonl((unsigned int)header.asteroidsSpawned));
+
+		message += (char)players.size();
+		for (PlayerState const& p : players)
+		{
+			AppendVec(message, p.t.pos, POSITION_SCALE);
+			AppendVec(message, p.t.scale, SIZE_SCALE);
+			AppendAngle(message, p.t.rot);
+			AppendVec(message, p.vel, VELOCITY_SCALE);
+			Append(message, htonl((unsigned int)p.score));
+		}
+
+		Append(message, htons((unsigned short)golist.size()));
+		Append(message, htons((unsigned short)asteroids));
+		for (size_t i = 0; i < golist.size(); ++i)
+		{
+			GameObject const& go = golist[i];
+			if (!go.isActive) continue;
+			Append(message, htons((unsigned short)i));
+			AppendVec(message, go.t.pos, POSITION_SCALE);
+			AppendFixed(message, go.t.scale.x, SIZE_SCALE);
+			AppendAngle(message, go.t.rot);
+			AppendVec(message, go.vel, VELOCITY_SCALE);
+		}
+
+		Append(message, htons((unsigned short)bulletlist.size()));
+		Append(message, htons((unsigned short)bullets));
+		for (size_t i = 0; i < bulletlist.size(); ++i)
+		{
+			Bullet const& b = bulletlist[i];
+			if (!b.go.isActive) continue;
+			Append(message, htons((unsigned short)i));
+			message += (char)b.playerNO;
+			AppendVec(message, b.go.t.pos, POSITION_SCALE);
+			AppendAngle(message, b.go.t.rot);
+			AppendVec(message, b.go.vel, VELOCITY_SCALE);
+			AppendFixed(message, b.lifeTime, LIFETIME_SCALE);
+		}
+		return message;
+	}
+
+	bool Read(const char* buffer, int length, State& state)
+	{
+		Reader r{ buffer, length, 1 };
+		if (!r.Has(12 + 1)) return false;
+		state.header.timestamp = r.F32();
+		state.header.timeLeft = r.F32();
+		state.header.asteroidsSpawned = (int)r.U32();
+
+		int players = r.U8();
+		if (!r.Has(players * PLAYER_SIZE)) return false;
+		state.players.resize(players);
+		for (PlayerState& p : state.players)
+		{
+			p.t.pos = r.Vec(POSITION_SCALE);
+			p.t.scale = r.Vec(SIZE_SCALE);
+			p.t.rot = r.Angle();
+			p.vel = r.Vec(VELOCITY_SCALE);
+			p.score = (int)r.U32();
+		}
+
+		if (!r.Has(4)) return false;
+		int golistSize = r.U16();
+		int asteroids = r.U16();
+		if (asteroids > golistSize || !r.Has(asteroids * ASTEROID_SIZE)) return false;
+		state.golist.assign(golistSize, GameObject{ {{0.f, 0.f},{0.f, 0.f}, 0.f}, {}, ASSET::A_ASTEROID, {0.f, 0.f, 0.f, 1.f}, false });
+		for (int i = 0; i < asteroids; ++i)
+		{
+			int index = r.U16();
+			if (index >= golistSize) return false;
+			GameObject& go = state.golist[index];
+			go.isActive = true;
+			go.t.pos = r.Vec(POSITION_SCALE);
+			float radius = r.Fixed(SIZE_SCALE);
+			go.t.scale = { radius, radius };
+			go.t.rot = r.Angle();
+			go.vel = r.Vec(VELOCITY_SCALE);
+		}
+
+		if (!r.Has(4)) return false;
+		int bulletlistSize = r.U16();
+		int bullets = r.U16();
+		if (bullets > bulletlistSize || !r.Has(bullets * BULLET_SIZE)) return false;
+		state.bulletlist.assign(bulletlistSize, Bullet{ { {{0.f, 0.f},{10.f, 10.f}, 0.f}, {}, ASSET::A_BULLET, {1.f, 1.f, 1.f, 1.f}, false }, 0.f, 0 });
+		for (int i = 0; i < bullets; ++i)
+		{
+			int index = r.U16();
+			if (index >= bulletlistSize) return false;
+			Bullet& b = state.bulletlist[index];
+			b.go.isActive = true;
+			b.playerNO = r.U8();
+			b.go.t.pos = r.Vec(POSITION_SCALE);
+			b.go.t.rot = r.Angle();
+			b.go.vel = r.Vec(VELOCITY_SCALE);
+			b.lifeTime = r.Fixed(LIFETIME_SCALE);
+		}
+		return true;
+	}
+}
@@ -0,0 +1,99 @@
+/*!
+\file		spawn.cpp
+\author		darius (d.chan@digipen.edu)
+\co-author
+\par		Assignment 4
+\date		19/10/2026
+\brief
+where a new asteroid starts, its size and how it moves.
+
+Copyright (C) 2025 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the
+prior written consent of DigiPen Institute of Technology is prohibited.
+*/
+#include "spawn.h"
+
+namespace SPAWN
+{
+	float RandomFloat(std::mt19937& rng, float min, float max)
+	{
+		std::uniform_real_distribution<float> uf(min, max);
+		return uf(rng);
+	}
+
+	int RandomInt(std::mt19937& rng, int min, int max)
+	{
+		std::uniform_int_distribution<int> ui(min, max);
+		return ui(rng);
+	}
+
+	GameObject MakeAsteroid(std::mt19937& rng, AEVec2 const& screen)
+	{
+		enum SpawnLocation : int
+		{
+			UP = 0,
+			DOWN = 1,
+			LEFT = 2,
+			RIGHT = 3
+		};
+
+		int sl{ RandomInt(rng, UP, RIGHT) };
+		float radius{ RandomFloat(rng, ASTEROID_MIN_SIZE, ASTEROID_MAX_SIZE) };
+		GameObject asteroid{ {{0.f, 0.f},{radius, radius}, RandomFloat(rng, 0.f, 359.f)}, {}, ASSET::A_ASTEROID, {0.f, 0.f, 0.f, 1.f}, true };
+		switch (sl)
+		{
+		case UP:
+			//spawn TOP region, moving downwards prio
+		{
+			asteroid.t.pos.x = RandomFloat(rng, -screen.x * 0.5f, screen.x * 0.5f);
+			asteroid.t.pos.y = screen.y * 0.5f + radius;
+			float hSpeed{ ASTEROID_MOVE_SPEED * 0.4f };
+			asteroid.vel.x = RandomFloat(rng, -hSpeed, hSpeed);
+			asteroid.vel.y = -1.f * (ASTEROID_MOVE_SPEED - hSpeed);
+		}
+		break;
+		case DOWN:
+			//spawn BTM region, moving upwards prio
+		{
+			asteroid.t.pos.x = RandomFloat(rng, -screen.x * 0.5f, screen.x * 0.5f);
+			asteroid.t.pos.y = -screen.y * 0.5f - radius;
+			float hSpeed{ ASTEROID_MOVE_SPEED * 0.4f };
+			asteroid.vel.x = RandomFloat(rng, -hSpeed, hSpeed);
+			asteroid.vel.y = ASTEROID_MOVE_SPEED - hSpeed;
+		}
+		break;
+		case LEFT:
+			//spawn LEFT region, moving right prio
+		{
+			asteroid.t.pos.x = -screen.x * 0.5f - radius;
+			asteroid.t.pos.y = RandomFloat(rng, -screen.y * 0.5f, screen.y * 0.5f);
+			float vSpeed{ ASTEROID_MOVE_SPEED * 0.4f };
+			asteroid.vel.y = RandomFloat(rng, -vSpeed, vSpeed);
+			asteroid.vel.x = ASTEROID_MOVE_SPEED - vSpeed;
+		}
+		break;
+		case RIGHT:
+			//spawn RIGHT region, moving left prio
+		{
+			asteroid.t.pos.x = screen.x * 0.5f + radius;
+			asteroid.t.pos.y = RandomFloat(rng, -screen.y * 0.5f, screen.y * 0.5f);
+			float vSpeed{ ASTEROID_MOVE_SPEED * 0.4f };
+			asteroid.vel.y = RandomFloat(rng, -vSpeed, vSpeed);
+			asteroid.vel.x = -1.f * (ASTEROID_MOVE_SPEED - vSpeed);
+		}
+		break;
+		}
+		return asteroid;
+	}
+
+	int SpawnAsteroid(std::mt19937& rng, Pool<GameObject>& golist, AEVec2 const& screen)
+	{
+		GameObject asteroid = MakeAsteroid(rng, screen);
+		int index = golist.Acquire();
+		if (index >= 0)
+		{
+			golist[index] = asteroid;
+		}
+		return index;
+	}
+}
@@ -0,0 +1,37 @@
+/*!
+\file		spawn.h
+\author		darius (d.chan@digipen.edu)
+\co-author
+\par		Assignment 4
+\date		19/10/2026
+\brief
+asteroid spawning of the server. an asteroid starts just outside a random
+edge of the screen and drifts into it. every value comes from the match's
+rng in a fixed order, the clients draw the same values from their own rng
+seeded the same, so they follow C_ASTEROID_SPAWN without being sent them.
+
+Copyright (C) 2025 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the
+prior written consent of DigiPen Institute of Technology is prohibited.
+*/
+#pragma once
+#include "gameobject.h"
+#include "pool.h"
+#include <random>
+
+namespace SPAWN
+{
+	const float ASTEROID_MIN_SIZE = 50.f;	//min radius
+	const float ASTEROID_MAX_SIZE = 100.f;	//max radius
+	const float ASTEROID_MOVE_SPEED = 100.f;
+
+	float RandomFloat(std::mt19937& rng, float min, float max);
+	int RandomInt(std::mt19937& rng, int min, int max);
+
+	//a new active asteroid for a screen of this size
+	GameObject MakeAsteroid(std::mt19937& rng, AEVec2 const& screen);
+
+	//puts a new asteroid into golist, returns its index or -1 if the pool refused.
+	//the rng moves on either way, so clients stay in step
+	int SpawnAsteroid(std::mt19937& rng, Pool<GameObject>& golist, AEVec2 const& screen);
+}
@@ -0,0 +1,83 @@
+/*!
+\file		trace.h
+\author		darius (d.chan@digipen.edu)
+\co-author
+\par		Assignment 4
+\date		19/10/2026
+\brief
+timeline of what every thread was doing, written as chrome trace json for
+chrome://tracing or ui.perfetto.dev. TRACE_SCOPE("name") records when the
+rest of its scope began and ended, a CONTENTION::ProfiledMutex records how
+long it was waited on. events go into a buffer owned by the calling thread,
+and only while tracing has been started. otherwise a scope is one relaxed
+atomic load. define TRACE_OFF to compile them out.
+
+Copyright (C) 2025 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the
+prior written consent of DigiPen Institute of Technology is prohibited.
+*/
+#pragma once
+#include <atomic>
+#include <string>
+
+namespace TRACE
+{
+	const int MAX_EVENTS = 1 << 18;		//events a thread keeps between two Writes, later ones are counted and dropped
+	const int NO_ARG = -1;
+
+	extern std::atomic<bool> enabled;
+
+	inline bool Enabled()
+	{
+		return enabled.load(std::memory_order_relaxed);
+	}
+
+	//starts recording, process names the timeline in the viewer
+	void Start(const char* process);
+	void Stop();
+
+	//names the calling thread in the viewer
+	void NameThread(const char* name);
+
+	//nanoseconds on the steady clock
+	long long Now();
+
+	//one finished event of the calling thread. name has to outlive the trace, a literal.
+	//arg is shown with the event unless it is NO_ARG
+	void Complete(const char* name, long long begin, long long end, int arg = NO_ARG);
+
+	//moves everything recorded so far into a chrome trace json file, recording goes on.
+	//false if the file could not be written
+	bool Write(std::string const& path);
+
+	class Scope
+	{
+	public:
+		explicit Scope(const char* name, int arg = NO_ARG) : _name{ Enabled() ? name : nullptr }, _arg{ arg }, _begin{ _name ? Now() : 0 }
+		{
+		}
+
+		~Scope()
+		{
+			if (_name) Complete(_name, _begin, Now(), _arg);
+		}
+
+		Scope(Scope const&) = delete;
+		Scope& operator=(Scope const&) = delete;
+
+	private:
+		const char* _name;
+		int _arg;
+		long long _begin;
+	};
+}
+
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+#ifdef TRACE_OFF
+#define TRACE_SCOPE(name)
+#define TRACE_SCOPE_ARG(name, arg)
+#else
+#define TRACE_SCOPE(name) TRACE::Scope TRACE_CONCAT(traceScope, __LINE__){ name }
+#define TRACE_SCOPE_ARG(name, arg) TRACE::Scope TRACE_CONCAT(traceScope, __LINE__){ name, arg }
+#endif
@@ -0,0 +1,125 @@
+/*!
+\file		validation.cpp
+\author		darius (d.chan@digipen.edu)
+\co-author
+\par		Assignment 4
+\date		19/10/2026
+\brief
+server side checks on what clients send.
+
+Copyright (C) 2025 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the
+prior written consent of DigiPen Institute of Technology is prohibited.
+*/
+#include "validation.h"
+#include <cmath>
+#include <algorithm>
+
+namespace VALIDATION
+{
+	TokenBucket::TokenBucket(double rate, double burst) : _rate{ rate }, _burst{ burst }, _tokens{ burst }, _last{ 0.0 }
+	{
+	}
+
+	bool TokenBucket::Take(double now, double cost)
+	{
+		if (now > _last)
+		{
+			_tokens = std::min(_burst, _tokens + (now - _last) * _rate);
+			_last = now;
+		}
+		if (_tokens < cost) return false;
+		_tokens -= cost;
+		return true;
+	}
+
+	void TokenBucket::Reset(double now)
+	{
+		_tokens = _burst;
+		_last = now;
+	}
+
+	bool AllowFire(float& lastFire, float fireTime)
+	{
+		if (fireTime - lastFire < FIRE_COOLDOWN * COOLDOWN_TOLERANCE) return false;
+		lastFire = fireTime;
+		return true;
+	}
+
+	int ActiveBullets(std::vector<Bullet> const& bulletlist, int playerID)
+	{
+		int count{};
+		for (Bullet const& b : bulletlist)
+		{
+			if (b.go.isActive && b.playerNO == playerID) ++count;
+		}
+		return count;
+	}
+
+	bool SanitizeState(Transform& t, AEVec2& vel)
+	{
+		if (!std::isfinite(t.pos.x) || !std::isfinite(t.pos.y) || !std::isfinite(t.rot) ||
+			!std::isfinite(vel.x) || !std::isfinite(vel.y))
+		{
+			return false;
+		}
+
+		t.scale = { PLAYER_SCALE, PLAYER_SCALE };
+
+		t.rot = std::fmod(t.rot, 360.f);
+		if (t.rot < 0.f) t.rot += 360.f;
+
+		float speed = std::sqrt(vel.x * vel.x + vel.y * vel.y);
+		const float limit = MAX_SPEED * SPEED_TOLERANCE;
+		if (speed > limit)
+		{
+			vel.x *= limit / speed;
+			vel.y *= limit / speed;
+		}
+		return true;
+	}
+
+	void ResetMovement(Movement& last, AEVec2 const& pos, float serverTime)
+	{
+		last = { pos, -1.f, serverTime, 0.f };
+	}
+
+	bool LimitMove(Movement& last, AEVec2& pos, float clientTime, float serverTime, AEVec2 const& screen)
+	{
+		//a ship leaving one edge comes back in at the other, the same as GameObject::Update
+		const float width = screen.x + PLAYER_SCALE;
+		const float height = screen.y + PLAYER_SCALE;
+		float dx = pos.x - last.pos.x;
+		float dy = pos.y - last.pos.y;
+		if (dx > width * 0.5f) dx -= width;
+		else if (dx < -width * 0.5f) dx += width;
+		if (dy > height * 0.5f) dy -= height;
+		else if (dy < -height * 0.5f) dy += height;
+
+		//the first update after a reset has no client time to measure from, it gets the whole allowance
+		const float serverElapsed = std::max(serverTime - last.serverTime, 0.f);
+		float elapsed = serverElapsed + MOVE_JITTER - last.lead;
+		float lead = last.lead;
+		if (last.clientTime >= 0.f)
+		{
+			elapsed = std::max(std::min(elapsed, clientTime - last.clientTime), 0.f);
+			lead = std::clamp(lead + elapsed - serverElapsed, 0.f, MOVE_JITTER);
+		}
+		const float reach = MAX_SPEED * SPEED_TOLERANCE * elapsed;
+
+		bool clamped{ false };
+		float distance = std::sqrt(dx * dx + dy * dy);
+		if (distance > reach)
+		{
+			pos.x = last.pos.x + dx * reach / distance;
+			pos.y = last.pos.y + dy * reach / distance;
+			if (pos.x > width * 0.5f) pos.x -= width;
+			else if (pos.x < -width * 0.5f) pos.x += width;
+			if (pos.y > height * 0.5f) pos.y -= height;
+			else if (pos.y < -height * 0.5f) pos.y += height;
+			clamped = true;
+		}
+		last = { pos, clientTime, serverTime, lead };
+		return clamped;
+	}
+}
@@ -0,0 +1,78 @@
+/*!
+\file		validation.h
+\author		darius (d.chan@digipen.edu)
+\co-author
+\par		Assignment 4
+\date		19/10/2026
+\brief
+server side checks on what clients send. fire requests are held to the
+client's cooldown and a bullet limit per player, player states are kept
+within the speed and scale a real client can produce, and every peer
+gets a packet budget so a flood cannot eat the tick.
+
+Copyright (C) 2025 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the
+prior written consent of DigiPen Institute of Technology is prohibited.
+*/
+#pragma once
+#include "gameobject.h"
+#include <vector>
+
+namespace VALIDATION
+{
+	const float FIRE_COOLDOWN = 0.5f;			//same as the client's shootCooldown
+	const float COOLDOWN_TOLERANCE = 0.9f;		//fraction of the cooldown accepted, for clock jitter
+	const int MAX_BULLETS_PER_PLAYER = 4;		//a bullet lives 1s, so 2 are alive at the real fire rate
+	const float MAX_SPEED = 200.f;				//same as the client's MAX_SPEED
+	const float SPEED_TOLERANCE = 1.1f;
+	const float PLAYER_SCALE = 50.f;
+	const float MOVE_JITTER = 0.25f;			//seconds a client's clock may gain on the server's in total, for updates that arrive late
+	const double PACKET_RATE = 80.0;			//messages per second a peer may send, updates top out near 30
+	const double PACKET_BURST = 40.0;
+
+	//the last position taken from a player, the next one is measured from here
+	struct Movement
+	{
+		AEVec2 pos;
+		float clientTime;	//timestamp of the update it came from, < 0 when the server placed the player
+		float serverTime;	//appTime it was taken at
+		float lead;			//seconds the client's clock has gained on the server's since the reset, at most MOVE_JITTER
+	};
+
+	//refills at rate tokens per second up to burst, every message takes one
+	class TokenBucket
+	{
+	public:
+		TokenBucket(double rate = PACKET_RATE, double burst = PACKET_BURST);
+
+		//false when the peer is over its budget
+		bool Take(double now, double cost = 1.0);
+		void Reset(double now);
+
+	private:
+		double _rate;
+		double _burst;
+		double _tokens;
+		double _last;
+	};
+
+	//fireTime has to be a real number already clamped to the rewind window.
+	//true if the shot respects the cooldown since lastFire, which is then moved to fireTime
+	bool AllowFire(float& lastFire, float fireTime);
+
+	int ActiveBullets(std::vector<Bullet> const& bulletlist, int playerID);
+
+	//forces a client's state into what the client could have produced: scale locked,
+	//speed capped, rotation wrapped. false if it holds values that cannot be used at all
+	bool SanitizeState(Transform& t, AEVec2& vel);
+
+	//starts measuring from where the server put the player
+	void ResetMovement(Movement& last, AEVec2 const& pos, float serverTime);
+
+	//pulls pos back towards the last accepted position if it is further than MAX_SPEED covers in the
+	//time between the two updates, measured the short way over the screen edges the ship wraps across.
+	//that time is the client's, capped by the server's plus what is left of MOVE_JITTER. the client's
+	//clock can only get MOVE_JITTER ahead in total, it earns it back by falling behind again.
+	//true if pos was pulled back
+	bool LimitMove(Movement& last, AEVec2& pos, float clientTime, float serverTime, AEVec2 const& screen);
+}